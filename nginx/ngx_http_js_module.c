@@ -28,6 +28,8 @@
 #define NGX_HTTP_JS_MCP_PAGE_SIZE       512
 #define NGX_HTTP_JS_MCP_MIN_CHUNK_SIZE  16
 
+#define NGX_HTTP_JS_VM_POOL_SIZE        16
+
 
 #define ngx_http_js_create_mem_cache_pool()                                   \
     nxt_mem_cache_pool_create(&ngx_http_js_mem_cache_pool_proto, NULL, NULL,  \
@@ -37,13 +39,77 @@
                               NGX_HTTP_JS_MCP_MIN_CHUNK_SIZE)
 
 
+/*
+ * A script is compiled once for all js_include directives of the same file.
+ * The compiled script is kept while any configuration refers to it, so it
+ * is reused on reload if the file has not been changed.
+ */
+
+typedef struct {
+    ngx_queue_t             queue;
+    ngx_str_t               file;
+    size_t                  size;
+    uint32_t                crc32;
+    ngx_uint_t              count;
+    njs_vm_t               *vm;
+    nxt_mem_cache_pool_t   *mem_cache_pool;
+} ngx_http_js_script_t;
+
+
+typedef struct {
+    ngx_flag_t           vm_pool;
+    ngx_int_t            vm_pool_size;
+    ngx_array_t          pools;          /* of ngx_http_js_vm_pool_t * */
+    ngx_array_t          sets;           /* of ngx_http_js_set_t * */
+} ngx_http_js_main_conf_t;
+
+
 typedef struct {
     njs_vm_t            *vm;
-    njs_opaque_value_t   args[2];
-    ngx_str_t            content;
+    ngx_queue_t          free;
+    ngx_uint_t           nfree;
+    ngx_uint_t           size;
+} ngx_http_js_vm_pool_t;
+
+
+/*
+ * A VM cloned in advance from the js_include VM.  After a request
+ * the memory pool is rewound and the VM is cloned again, so the next
+ * request gets a clean global scope without creating a new pool.
+ */
+
+typedef struct {
+    njs_vm_t               *vm;
+    nxt_mem_cache_pool_t   *mem_cache_pool;
+    void                   *external;
+    ngx_http_js_vm_pool_t  *pool;
+    ngx_queue_t             queue;
+} ngx_http_js_vm_t;
+
+
+typedef struct {
+    njs_vm_t               *vm;
+    ngx_http_js_vm_pool_t  *pool;
+    njs_opaque_value_t      args[2];
+    ngx_str_t               content;
+    njs_index_t             content_index;
 } ngx_http_js_loc_conf_t;
 
 
+/*
+ * The js_set function index is found at configuration time in the VM
+ * of the level where js_set is specified.  Other VMs are searched by
+ * the function name on each call.
+ */
+
+typedef struct {
+    ngx_str_t                fname;
+    njs_vm_t                *vm;
+    njs_index_t              index;
+    ngx_http_js_loc_conf_t  *conf;
+} ngx_http_js_set_t;
+
+
 typedef struct {
     njs_vm_t            *vm;
     njs_opaque_value_t  *args;
@@ -61,6 +127,15 @@ static ngx_int_t ngx_http_js_variable(ngx_http_request_t *r,
     ngx_http_variable_value_t *v, uintptr_t data);
 static ngx_int_t ngx_http_js_init_vm(ngx_http_request_t *r);
 static void ngx_http_js_cleanup_mem_cache_pool(void *data);
+static ngx_http_js_script_t *ngx_http_js_script_find(ngx_str_t *file,
+    size_t size, uint32_t crc32);
+static void ngx_http_js_cleanup_script(void *data);
+static ngx_http_js_vm_t *ngx_http_js_vm_get(ngx_http_js_vm_pool_t *pool,
+    ngx_log_t *log);
+static ngx_http_js_vm_t *ngx_http_js_vm_create(ngx_http_js_vm_pool_t *pool,
+    ngx_log_t *log);
+static void ngx_http_js_vm_destroy(ngx_http_js_vm_t *jvm);
+static void ngx_http_js_cleanup_vm(void *data);
 
 static void *ngx_http_js_alloc(void *mem, size_t size);
 static void *ngx_http_js_calloc(void *mem, size_t size);
@@ -121,9 +196,13 @@ static char *ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
 static char *ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf);
 static char *ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static ngx_int_t ngx_http_js_init(ngx_conf_t *cf);
+static void *ngx_http_js_create_main_conf(ngx_conf_t *cf);
+static char *ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_http_js_create_loc_conf(ngx_conf_t *cf);
 static char *ngx_http_js_merge_loc_conf(ngx_conf_t *cf, void *parent,
     void *child);
+static ngx_int_t ngx_http_js_init_process(ngx_cycle_t *cycle);
 
 
 static ngx_command_t  ngx_http_js_commands[] = {
@@ -149,16 +228,30 @@ static ngx_command_t  ngx_http_js_commands[] = {
       0,
       NULL },
 
+    { ngx_string("js_vm_pool"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, vm_pool),
+      NULL },
+
+    { ngx_string("js_vm_pool_size"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, vm_pool_size),
+      NULL },
+
     ngx_null_command
 };
 
 
 static ngx_http_module_t  ngx_http_js_module_ctx = {
     NULL,                          /* preconfiguration */
-    NULL,                          /* postconfiguration */
+    ngx_http_js_init,              /* postconfiguration */
 
-    NULL,                          /* create main configuration */
-    NULL,                          /* init main configuration */
+    ngx_http_js_create_main_conf,  /* create main configuration */
+    ngx_http_js_init_main_conf,    /* init main configuration */
 
     NULL,                          /* create server configuration */
     NULL,                          /* merge server configuration */
@@ -175,7 +268,7 @@ ngx_module_t  ngx_http_js_module = {
     NGX_HTTP_MODULE,               /* module type */
     NULL,                          /* init master */
     NULL,                          /* init module */
-    NULL,                          /* init process */
+    ngx_http_js_init_process,      /* init process */
     NULL,                          /* init thread */
     NULL,                          /* exit thread */
     NULL,                          /* exit process */
@@ -184,6 +277,9 @@ ngx_module_t  ngx_http_js_module = {
 };
 
 
+static ngx_queue_t  ngx_http_js_scripts;
+
+
 static const nxt_mem_proto_t  ngx_http_js_mem_cache_pool_proto = {
     ngx_http_js_alloc,
     ngx_http_js_calloc,
@@ -415,8 +511,7 @@ static ngx_int_t
 ngx_http_js_handler(ngx_http_request_t *r)
 {
     ngx_int_t                rc;
-    nxt_str_t                name, exception;
-    njs_function_t          *func;
+    nxt_str_t                exception;
     ngx_http_js_ctx_t       *ctx;
     ngx_http_js_loc_conf_t  *jlcf;
 
@@ -433,17 +528,9 @@ ngx_http_js_handler(ngx_http_request_t *r)
 
     ctx = ngx_http_get_module_ctx(r, ngx_http_js_module);
 
-    name.start = jlcf->content.data;
-    name.length = jlcf->content.len;
-
-    func = njs_vm_function(ctx->vm, &name);
-    if (func == NULL) {
-        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                       "js function \"%V\" not found", &jlcf->content);
-        return NGX_DECLINED;
-    }
-
-    if (njs_vm_call(ctx->vm, func, ctx->args, 2) != NJS_OK) {
+    if (njs_vm_call_index(ctx->vm, jlcf->content_index, ctx->args, 2)
+        != NJS_OK)
+    {
         njs_vm_exception(ctx->vm, &exception);
 
         ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
@@ -460,12 +547,13 @@ static ngx_int_t
 ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
     uintptr_t data)
 {
-    ngx_str_t *fname = (ngx_str_t *) data;
+    ngx_http_js_set_t *set = (ngx_http_js_set_t *) data;
 
-    ngx_int_t           rc;
-    nxt_str_t           name, value, exception;
-    njs_function_t     *func;
-    ngx_http_js_ctx_t  *ctx;
+    ngx_int_t                rc;
+    nxt_str_t                name, value, exception;
+    njs_index_t              index;
+    ngx_http_js_ctx_t       *ctx;
+    ngx_http_js_loc_conf_t  *jlcf;
 
     rc = ngx_http_js_init_vm(r);
 
@@ -479,22 +567,29 @@ ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
     }
 
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http js variable call \"%V\"", fname);
+                   "http js variable call \"%V\"", &set->fname);
 
     ctx = ngx_http_get_module_ctx(r, ngx_http_js_module);
+    jlcf = ngx_http_get_module_loc_conf(r, ngx_http_js_module);
 
-    name.start = fname->data;
-    name.length = fname->len;
+    if (jlcf->vm == set->vm) {
+        index = set->index;
 
-    func = njs_vm_function(ctx->vm, &name);
-    if (func == NULL) {
-        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                       "js function \"%V\" not found", fname);
-        v->not_found = 1;
-        return NGX_OK;
+    } else {
+        name.start = set->fname.data;
+        name.length = set->fname.len;
+
+        index = njs_vm_function_index(ctx->vm, &name);
+
+        if (index == NJS_INDEX_ERROR) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "js function \"%V\" not found", &set->fname);
+            v->not_found = 1;
+            return NGX_OK;
+        }
     }
 
-    if (njs_vm_call(ctx->vm, func, ctx->args, 2) != NJS_OK) {
+    if (njs_vm_call_index(ctx->vm, index, ctx->args, 2) != NJS_OK) {
         njs_vm_exception(ctx->vm, &exception);
 
         ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
@@ -521,11 +616,13 @@ ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
 static ngx_int_t
 ngx_http_js_init_vm(ngx_http_request_t *r)
 {
-    void                    **ext;
-    ngx_http_js_ctx_t        *ctx;
-    ngx_pool_cleanup_t       *cln;
-    nxt_mem_cache_pool_t     *mcp;
-    ngx_http_js_loc_conf_t   *jlcf;
+    void                     **ext;
+    ngx_http_js_vm_t          *jvm;
+    ngx_http_js_ctx_t         *ctx;
+    ngx_pool_cleanup_t        *cln;
+    nxt_mem_cache_pool_t      *mcp;
+    ngx_http_js_loc_conf_t    *jlcf;
+    ngx_http_js_main_conf_t   *jmcf;
 
     jlcf = ngx_http_get_module_loc_conf(r, ngx_http_js_module);
     if (jlcf->vm == NULL) {
@@ -547,6 +644,30 @@ ngx_http_js_init_vm(ngx_http_request_t *r)
         return NGX_OK;
     }
 
+    jmcf = ngx_http_get_module_main_conf(r, ngx_http_js_module);
+
+    if (jmcf->vm_pool) {
+        cln = ngx_pool_cleanup_add(r->pool, 0);
+        if (cln == NULL) {
+            return NGX_ERROR;
+        }
+
+        jvm = ngx_http_js_vm_get(jlcf->pool, r->connection->log);
+        if (jvm == NULL) {
+            return NGX_ERROR;
+        }
+
+        cln->handler = ngx_http_js_cleanup_vm;
+        cln->data = jvm;
+
+        jvm->external = r;
+
+        ctx->vm = jvm->vm;
+        ctx->args = &jlcf->args[0];
+
+        return NGX_OK;
+    }
+
     mcp = ngx_http_js_create_mem_cache_pool();
     if (mcp == NULL) {
         return NGX_ERROR;
@@ -587,6 +708,142 @@ ngx_http_js_cleanup_mem_cache_pool(void *data)
 }
 
 
+static ngx_http_js_script_t *
+ngx_http_js_script_find(ngx_str_t *file, size_t size, uint32_t crc32)
+{
+    ngx_queue_t           *q;
+    ngx_http_js_script_t  *script;
+
+    if (ngx_queue_next(&ngx_http_js_scripts) == NULL) {
+        ngx_queue_init(&ngx_http_js_scripts);
+        return NULL;
+    }
+
+    for (q = ngx_queue_head(&ngx_http_js_scripts);
+         q != ngx_queue_sentinel(&ngx_http_js_scripts);
+         q = ngx_queue_next(q))
+    {
+        script = ngx_queue_data(q, ngx_http_js_script_t, queue);
+
+        if (script->size == size
+            && script->crc32 == crc32
+            && script->file.len == file->len
+            && ngx_strncmp(script->file.data, file->data, file->len) == 0)
+        {
+            return script;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+ngx_http_js_cleanup_script(void *data)
+{
+    ngx_http_js_script_t *script = data;
+
+    if (--script->count != 0) {
+        return;
+    }
+
+    ngx_queue_remove(&script->queue);
+
+    if (script->vm != NULL) {
+        /* The VM frees RegExp JIT code and destroys the memory pool. */
+        njs_vm_destroy(script->vm);
+
+    } else {
+        nxt_mem_cache_pool_destroy(script->mem_cache_pool);
+    }
+
+    ngx_free(script);
+}
+
+
+static ngx_http_js_vm_t *
+ngx_http_js_vm_get(ngx_http_js_vm_pool_t *pool, ngx_log_t *log)
+{
+    ngx_queue_t  *q;
+
+    if (ngx_queue_empty(&pool->free)) {
+        return ngx_http_js_vm_create(pool, log);
+    }
+
+    q = ngx_queue_head(&pool->free);
+    ngx_queue_remove(q);
+
+    pool->nfree--;
+
+    return ngx_queue_data(q, ngx_http_js_vm_t, queue);
+}
+
+
+static ngx_http_js_vm_t *
+ngx_http_js_vm_create(ngx_http_js_vm_pool_t *pool, ngx_log_t *log)
+{
+    ngx_http_js_vm_t  *jvm;
+
+    jvm = ngx_alloc(sizeof(ngx_http_js_vm_t), log);
+    if (jvm == NULL) {
+        return NULL;
+    }
+
+    jvm->mem_cache_pool = ngx_http_js_create_mem_cache_pool();
+    if (jvm->mem_cache_pool == NULL) {
+        ngx_free(jvm);
+        return NULL;
+    }
+
+    jvm->pool = pool;
+    jvm->external = NULL;
+
+    jvm->vm = njs_vm_clone(pool->vm, jvm->mem_cache_pool, &jvm->external);
+    if (jvm->vm == NULL) {
+        ngx_http_js_vm_destroy(jvm);
+        return NULL;
+    }
+
+    return jvm;
+}
+
+
+static void
+ngx_http_js_vm_destroy(ngx_http_js_vm_t *jvm)
+{
+    nxt_mem_cache_pool_destroy(jvm->mem_cache_pool);
+    ngx_free(jvm);
+}
+
+
+static void
+ngx_http_js_cleanup_vm(void *data)
+{
+    ngx_http_js_vm_t *jvm = data;
+
+    ngx_http_js_vm_pool_t  *pool;
+
+    pool = jvm->pool;
+
+    if (pool->nfree < pool->size) {
+        nxt_mem_cache_pool_reset(jvm->mem_cache_pool);
+
+        jvm->external = NULL;
+
+        jvm->vm = njs_vm_clone(pool->vm, jvm->mem_cache_pool,
+                               &jvm->external);
+
+        if (jvm->vm != NULL) {
+            ngx_queue_insert_head(&pool->free, &jvm->queue);
+            pool->nfree++;
+            return;
+        }
+    }
+
+    ngx_http_js_vm_destroy(jvm);
+}
+
+
 static void *
 ngx_http_js_alloc(void *mem, size_t size)
 {
@@ -661,24 +918,14 @@ ngx_http_js_ext_foreach_header(njs_vm_t *vm, void *obj, void *next,
     char *p = obj;
 
     ngx_list_t                 *headers;
-    ngx_http_request_t         *r;
-    ngx_http_js_table_entry_t  *entry, **e;
-
-    r = (ngx_http_request_t *) obj;
-
-    entry = ngx_palloc(r->pool, sizeof(ngx_http_js_table_entry_t));
-    if (entry == NULL) {
-        return NJS_ERROR;
-    }
+    ngx_http_js_table_entry_t  *entry;
 
     headers = (ngx_list_t *) (p + data);
 
+    entry = next;
     entry->part = &headers->part;
     entry->item = 0;
 
-    e = (ngx_http_js_table_entry_t **) next;
-    *e = entry;
-
     return NJS_OK;
 }
 
@@ -687,12 +934,10 @@ static njs_ret_t
 ngx_http_js_ext_next_header(njs_vm_t *vm, njs_value_t *value, void *obj,
     void *next)
 {
-    ngx_http_js_table_entry_t **e = next;
-
     ngx_table_elt_t            *header, *h;
     ngx_http_js_table_entry_t  *entry;
 
-    entry = *e;
+    entry = next;
 
     while (entry->part) {
 
@@ -1127,21 +1372,14 @@ ngx_http_js_ext_get_arg(njs_vm_t *vm, njs_value_t *value, void *obj,
 static njs_ret_t
 ngx_http_js_ext_foreach_arg(njs_vm_t *vm, void *obj, void *next)
 {
-    ngx_str_t           *entry, **e;
+    ngx_str_t           *entry;
     ngx_http_request_t  *r;
 
     r = (ngx_http_request_t *) obj;
 
-    entry = ngx_palloc(r->pool, sizeof(ngx_str_t));
-    if (entry == NULL) {
-        return NJS_ERROR;
-    }
-
+    entry = next;
     *entry = r->args;
 
-    e = (ngx_str_t **) next;
-    *e = entry;
-
     return NJS_OK;
 }
 
@@ -1150,13 +1388,11 @@ static njs_ret_t
 ngx_http_js_ext_next_arg(njs_vm_t *vm, njs_value_t *value, void *obj,
     void *next)
 {
-    ngx_str_t **e = next;
-
     size_t      len;
     u_char     *p, *start, *end;
     ngx_str_t  *entry;
 
-    entry = *e;
+    entry = next;
 
     if (entry->len == 0) {
         return NJS_DONE;
@@ -1219,18 +1455,22 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
     ngx_http_js_loc_conf_t *jlcf = conf;
 
-    size_t                 size;
-    u_char                *start, *end;
-    ssize_t                n;
-    ngx_fd_t               fd;
-    ngx_str_t             *value, file;
-    nxt_int_t              rc;
-    nxt_str_t              text, ext;
-    nxt_lvlhsh_t           externals;
-    ngx_file_info_t        fi;
-    njs_vm_shared_t       *shared;
-    ngx_pool_cleanup_t    *cln;
-    nxt_mem_cache_pool_t  *mcp;
+    size_t                    size;
+    u_char                   *start, *end;
+    ssize_t                   n;
+    uint32_t                  crc32;
+    ngx_fd_t                  fd;
+    ngx_str_t                *value, file;
+    nxt_int_t                 rc;
+    nxt_str_t                 text, ext;
+    nxt_lvlhsh_t              externals;
+    ngx_file_info_t           fi;
+    njs_vm_shared_t          *shared;
+    ngx_pool_cleanup_t       *cln;
+    nxt_mem_cache_pool_t     *mcp;
+    ngx_http_js_script_t     *script;
+    ngx_http_js_vm_pool_t    *pool, **pp;
+    ngx_http_js_main_conf_t  *jmcf;
 
     if (jlcf->vm) {
         return "is duplicate";
@@ -1291,18 +1531,54 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     end = start + size;
 
+    cln = ngx_pool_cleanup_add(cf->pool, 0);
+    if (cln == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    crc32 = ngx_crc32_long(start, size);
+
+    script = ngx_http_js_script_find(&file, size, crc32);
+
+    if (script != NULL) {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, cf->log, 0,
+                       "js include \"%V\" is not changed", &file);
+
+        script->count++;
+
+        cln->handler = ngx_http_js_cleanup_script;
+        cln->data = script;
+
+        jlcf->vm = script->vm;
+
+        goto externals;
+    }
+
+    script = ngx_alloc(sizeof(ngx_http_js_script_t) + file.len, cf->log);
+    if (script == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
     mcp = ngx_http_js_create_mem_cache_pool();
     if (mcp == NULL) {
+        ngx_free(script);
         return NGX_CONF_ERROR;
     }
 
-    cln = ngx_pool_cleanup_add(cf->pool, 0);
-    if (cln == NULL) {
-        return NULL;
-    }
+    script->file.len = file.len;
+    script->file.data = (u_char *) &script[1];
+    ngx_memcpy(script->file.data, file.data, file.len);
 
-    cln->handler = ngx_http_js_cleanup_mem_cache_pool;
-    cln->data = mcp;
+    script->size = size;
+    script->crc32 = crc32;
+    script->count = 1;
+    script->vm = NULL;
+    script->mem_cache_pool = mcp;
+
+    ngx_queue_init(&script->queue);
+
+    cln->handler = ngx_http_js_cleanup_script;
+    cln->data = script;
 
     shared = NULL;
 
@@ -1321,6 +1597,8 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    script->vm = jlcf->vm;
+
     rc = njs_vm_compile(jlcf->vm, &start, end, NULL);
 
     if (rc != NJS_OK) {
@@ -1339,6 +1617,10 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    ngx_queue_insert_tail(&ngx_http_js_scripts, &script->queue);
+
+externals:
+
     ext = nxt_string_value("$r");
 
     if (njs_vm_external(jlcf->vm, NULL, &ext, &jlcf->args[0]) != NJS_OK) {
@@ -1358,6 +1640,24 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    pool = ngx_pcalloc(cf->pool, sizeof(ngx_http_js_vm_pool_t));
+    if (pool == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    pool->vm = jlcf->vm;
+    ngx_queue_init(&pool->free);
+
+    jmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_js_module);
+
+    pp = ngx_array_push(&jmcf->pools);
+    if (pp == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    *pp = pool;
+    jlcf->pool = pool;
+
     return NGX_CONF_OK;
 }
 
@@ -1365,8 +1665,12 @@ ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 static char *
 ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
-    ngx_str_t            *value, *fname;
-    ngx_http_variable_t  *v;
+    ngx_http_js_loc_conf_t *jlcf = conf;
+
+    ngx_str_t                 *value;
+    ngx_http_js_set_t         *set, **sp;
+    ngx_http_variable_t       *v;
+    ngx_http_js_main_conf_t   *jmcf;
 
     value = cf->args->elts;
 
@@ -1384,15 +1688,25 @@ ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    fname = ngx_palloc(cf->pool, sizeof(ngx_str_t));
-    if (fname == NULL) {
+    set = ngx_pcalloc(cf->pool, sizeof(ngx_http_js_set_t));
+    if (set == NULL) {
         return NGX_CONF_ERROR;
     }
 
-    *fname = value[2];
+    set->fname = value[2];
+    set->conf = jlcf;
+
+    jmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_js_module);
+
+    sp = ngx_array_push(&jmcf->sets);
+    if (sp == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    *sp = set;
 
     v->get_handler = ngx_http_js_variable;
-    v->data = (uintptr_t) fname;
+    v->data = (uintptr_t) set;
 
     return NGX_CONF_OK;
 }
@@ -1420,6 +1734,90 @@ ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 }
 
 
+static ngx_int_t
+ngx_http_js_init(ngx_conf_t *cf)
+{
+    nxt_str_t                 name;
+    ngx_uint_t                i;
+    ngx_http_js_set_t       **sets;
+    ngx_http_js_main_conf_t  *jmcf;
+
+    jmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_js_module);
+
+    sets = jmcf->sets.elts;
+
+    for (i = 0; i < jmcf->sets.nelts; i++) {
+
+        if (sets[i]->conf->vm == NULL) {
+            continue;
+        }
+
+        name.start = sets[i]->fname.data;
+        name.length = sets[i]->fname.len;
+
+        sets[i]->index = njs_vm_function_index(sets[i]->conf->vm, &name);
+
+        if (sets[i]->index == NJS_INDEX_ERROR) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "js function \"%V\" not found", &sets[i]->fname);
+            return NGX_ERROR;
+        }
+
+        sets[i]->vm = sets[i]->conf->vm;
+    }
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_http_js_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_http_js_main_conf_t  *conf;
+
+    conf = ngx_pcalloc(cf->pool, sizeof(ngx_http_js_main_conf_t));
+    if (conf == NULL) {
+        return NULL;
+    }
+
+    if (ngx_array_init(&conf->pools, cf->pool, 1,
+                       sizeof(ngx_http_js_vm_pool_t *))
+        != NGX_OK)
+    {
+        return NULL;
+    }
+
+    if (ngx_array_init(&conf->sets, cf->pool, 4, sizeof(ngx_http_js_set_t *))
+        != NGX_OK)
+    {
+        return NULL;
+    }
+
+    conf->vm_pool = NGX_CONF_UNSET;
+    conf->vm_pool_size = NGX_CONF_UNSET;
+
+    return conf;
+}
+
+
+static char *
+ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
+{
+    ngx_http_js_main_conf_t *jmcf = conf;
+
+    ngx_conf_init_value(jmcf->vm_pool, 1);
+    ngx_conf_init_value(jmcf->vm_pool_size, NGX_HTTP_JS_VM_POOL_SIZE);
+
+    if (jmcf->vm_pool_size < 0) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "\"js_vm_pool_size\" must not be negative");
+        return NGX_CONF_ERROR;
+    }
+
+    return NGX_CONF_OK;
+}
+
+
 static void *
 ngx_http_js_create_loc_conf(ngx_conf_t *cf)
 {
@@ -1434,6 +1832,7 @@ ngx_http_js_create_loc_conf(ngx_conf_t *cf)
      * set by ngx_pcalloc():
      *
      *     conf->vm = NULL;
+     *     conf->pool = NULL;
      */
 
     return conf;
@@ -1446,11 +1845,68 @@ ngx_http_js_merge_loc_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_http_js_loc_conf_t *prev = parent;
     ngx_http_js_loc_conf_t *conf = child;
 
+    nxt_str_t  name;
+
     if (conf->vm == NULL) {
         conf->vm = prev->vm;
+        conf->pool = prev->pool;
         conf->args[0] = prev->args[0];
         conf->args[1] = prev->args[1];
     }
 
+    if (conf->content.data != NULL) {
+        if (conf->vm == NULL) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "no \"js_include\" is defined for "
+                          "\"js_content\" function \"%V\"", &conf->content);
+            return NGX_CONF_ERROR;
+        }
+
+        name.start = conf->content.data;
+        name.length = conf->content.len;
+
+        conf->content_index = njs_vm_function_index(conf->vm, &name);
+
+        if (conf->content_index == NJS_INDEX_ERROR) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "js function \"%V\" not found", &conf->content);
+            return NGX_CONF_ERROR;
+        }
+    }
+
     return NGX_CONF_OK;
 }
+
+
+static ngx_int_t
+ngx_http_js_init_process(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                i, n;
+    ngx_http_js_vm_t         *jvm;
+    ngx_http_js_vm_pool_t   **pools;
+    ngx_http_js_main_conf_t  *jmcf;
+
+    jmcf = ngx_http_cycle_get_module_main_conf(cycle, ngx_http_js_module);
+
+    if (jmcf == NULL || !jmcf->vm_pool) {
+        return NGX_OK;
+    }
+
+    pools = jmcf->pools.elts;
+
+    for (i = 0; i < jmcf->pools.nelts; i++) {
+        pools[i]->size = jmcf->vm_pool_size;
+
+        for (n = 0; n < pools[i]->size; n++) {
+            jvm = ngx_http_js_vm_create(pools[i], cycle->log);
+            if (jvm == NULL) {
+                return NGX_ERROR;
+            }
+
+            ngx_queue_insert_tail(&pools[i]->free, &jvm->queue);
+            pools[i]->nfree++;
+        }
+    }
+
+    return NGX_OK;
+}
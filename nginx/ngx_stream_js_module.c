@@ -37,12 +37,48 @@
                               NGX_STREAM_JS_MCP_MIN_CHUNK_SIZE)
 
 
+/*
+ * A script is compiled once for all js_include directives of the same file.
+ * The compiled script is kept while any configuration refers to it, so it
+ * is reused on reload if the file has not been changed.
+ */
+
+typedef struct {
+    ngx_queue_t             queue;
+    ngx_str_t               file;
+    size_t                  size;
+    uint32_t                crc32;
+    ngx_uint_t              count;
+    njs_vm_t               *vm;
+    nxt_mem_cache_pool_t   *mem_cache_pool;
+} ngx_stream_js_script_t;
+
+
+typedef struct {
+    ngx_array_t            sets;        /* of ngx_stream_js_set_t * */
+} ngx_stream_js_main_conf_t;
+
+
 typedef struct {
     njs_vm_t              *vm;
     njs_opaque_value_t     arg;
 } ngx_stream_js_srv_conf_t;
 
 
+/*
+ * The js_set function index is found at configuration time in the VM
+ * of the level where js_set is specified.  Other VMs are searched by
+ * the function name on each call.
+ */
+
+typedef struct {
+    ngx_str_t                  fname;
+    njs_vm_t                  *vm;
+    njs_index_t                index;
+    ngx_stream_js_srv_conf_t  *conf;
+} ngx_stream_js_set_t;
+
+
 typedef struct {
     njs_vm_t              *vm;
     njs_opaque_value_t    *arg;
@@ -52,6 +88,9 @@ typedef struct {
 static ngx_int_t ngx_stream_js_variable(ngx_stream_session_t *s,
     ngx_stream_variable_value_t *v, uintptr_t data);
 static void ngx_stream_js_cleanup_mem_cache_pool(void *data);
+static ngx_stream_js_script_t *ngx_stream_js_script_find(ngx_str_t *file,
+    size_t size, uint32_t crc32);
+static void ngx_stream_js_cleanup_script(void *data);
 static ngx_int_t ngx_stream_js_init_vm(ngx_stream_session_t *s);
 
 static void *ngx_stream_js_alloc(void *mem, size_t size);
@@ -65,11 +104,15 @@ static njs_ret_t ngx_stream_js_ext_log(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
 static njs_ret_t ngx_stream_js_ext_get_variable(njs_vm_t *vm,
     njs_value_t *value, void *obj, uintptr_t data);
+static njs_ret_t ngx_stream_js_ext_get_buffer(njs_vm_t *vm,
+    njs_value_t *value, void *obj, uintptr_t data);
 
 static char *ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static char *ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static ngx_int_t ngx_stream_js_init(ngx_conf_t *cf);
+static void *ngx_stream_js_create_main_conf(ngx_conf_t *cf);
 static void *ngx_stream_js_create_srv_conf(ngx_conf_t *cf);
 static char *ngx_stream_js_merge_srv_conf(ngx_conf_t *cf, void *parent,
     void *child);
@@ -97,9 +140,9 @@ static ngx_command_t  ngx_stream_js_commands[] = {
 
 static ngx_stream_module_t  ngx_stream_js_module_ctx = {
     NULL,                          /* preconfiguration */
-    NULL,                          /* postconfiguration */
+    ngx_stream_js_init,            /* postconfiguration */
 
-    NULL,                          /* create main configuration */
+    ngx_stream_js_create_main_conf, /* create main configuration */
     NULL,                          /* init main configuration */
 
     ngx_stream_js_create_srv_conf, /* create server configuration */
@@ -123,6 +166,9 @@ ngx_module_t  ngx_stream_js_module = {
 };
 
 
+static ngx_queue_t  ngx_stream_js_scripts;
+
+
 static const nxt_mem_proto_t  ngx_stream_js_mem_cache_pool_proto = {
     ngx_stream_js_alloc,
     ngx_stream_js_calloc,
@@ -171,6 +217,18 @@ static njs_external_t  ngx_stream_js_ext_session[] = {
       NULL,
       NULL,
       0 },
+
+    { nxt_string("buffer"),
+      NJS_EXTERN_PROPERTY,
+      NULL,
+      0,
+      ngx_stream_js_ext_get_buffer,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      0 },
 };
 
 
@@ -194,12 +252,13 @@ static ngx_int_t
 ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
     uintptr_t data)
 {
-    ngx_str_t *fname = (ngx_str_t *) data;
+    ngx_stream_js_set_t *set = (ngx_stream_js_set_t *) data;
 
-    ngx_int_t             rc;
-    nxt_str_t             name, value, exception;
-    njs_function_t       *func;
-    ngx_stream_js_ctx_t  *ctx;
+    ngx_int_t                  rc;
+    nxt_str_t                  name, value, exception;
+    njs_index_t                index;
+    ngx_stream_js_ctx_t       *ctx;
+    ngx_stream_js_srv_conf_t  *jscf;
 
     rc = ngx_stream_js_init_vm(s);
 
@@ -213,22 +272,29 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
     }
 
     ngx_log_debug1(NGX_LOG_DEBUG_STREAM, s->connection->log, 0,
-                   "stream js variable call \"%V\"", fname);
+                   "stream js variable call \"%V\"", &set->fname);
 
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
+    jscf = ngx_stream_get_module_srv_conf(s, ngx_stream_js_module);
 
-    name.start = fname->data;
-    name.length = fname->len;
+    if (jscf->vm == set->vm) {
+        index = set->index;
 
-    func = njs_vm_function(ctx->vm, &name);
-    if (func == NULL) {
-        ngx_log_debug1(NGX_LOG_DEBUG_STREAM, s->connection->log, 0,
-                       "js function \"%V\" not found", fname);
-        v->not_found = 1;
-        return NGX_OK;
+    } else {
+        name.start = set->fname.data;
+        name.length = set->fname.len;
+
+        index = njs_vm_function_index(ctx->vm, &name);
+
+        if (index == NJS_INDEX_ERROR) {
+            ngx_log_debug1(NGX_LOG_DEBUG_STREAM, s->connection->log, 0,
+                           "js function \"%V\" not found", &set->fname);
+            v->not_found = 1;
+            return NGX_OK;
+        }
     }
 
-    if (njs_vm_call(ctx->vm, func, ctx->arg, 1) != NJS_OK) {
+    if (njs_vm_call_index(ctx->vm, index, ctx->arg, 1) != NJS_OK) {
         njs_vm_exception(ctx->vm, &exception);
 
         ngx_log_error(NGX_LOG_ERR, s->connection->log, 0,
@@ -321,6 +387,59 @@ ngx_stream_js_cleanup_mem_cache_pool(void *data)
 }
 
 
+static ngx_stream_js_script_t *
+ngx_stream_js_script_find(ngx_str_t *file, size_t size, uint32_t crc32)
+{
+    ngx_queue_t             *q;
+    ngx_stream_js_script_t  *script;
+
+    if (ngx_queue_next(&ngx_stream_js_scripts) == NULL) {
+        ngx_queue_init(&ngx_stream_js_scripts);
+        return NULL;
+    }
+
+    for (q = ngx_queue_head(&ngx_stream_js_scripts);
+         q != ngx_queue_sentinel(&ngx_stream_js_scripts);
+         q = ngx_queue_next(q))
+    {
+        script = ngx_queue_data(q, ngx_stream_js_script_t, queue);
+
+        if (script->size == size
+            && script->crc32 == crc32
+            && script->file.len == file->len
+            && ngx_strncmp(script->file.data, file->data, file->len) == 0)
+        {
+            return script;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void
+ngx_stream_js_cleanup_script(void *data)
+{
+    ngx_stream_js_script_t *script = data;
+
+    if (--script->count != 0) {
+        return;
+    }
+
+    ngx_queue_remove(&script->queue);
+
+    if (script->vm != NULL) {
+        /* The VM frees RegExp JIT code and destroys the memory pool. */
+        njs_vm_destroy(script->vm);
+
+    } else {
+        nxt_mem_cache_pool_destroy(script->mem_cache_pool);
+    }
+
+    ngx_free(script);
+}
+
+
 static void *
 ngx_stream_js_alloc(void *mem, size_t size)
 {
@@ -418,23 +537,50 @@ ngx_stream_js_ext_get_variable(njs_vm_t *vm, njs_value_t *value, void *obj,
 }
 
 
+/*
+ * The client data read in the preread phase are exposed as read-only
+ * ArrayBuffer without copying, so scripts cannot change proxied data.
+ * The buffer is allocated from the connection pool, so it outlives
+ * the cloned VM.
+ */
+
+static njs_ret_t
+ngx_stream_js_ext_get_buffer(njs_vm_t *vm, njs_value_t *value, void *obj,
+    uintptr_t data)
+{
+    ngx_buf_t             *b;
+    ngx_stream_session_t  *s;
+
+    s = (ngx_stream_session_t *) obj;
+    b = s->connection->buffer;
+
+    if (b == NULL) {
+        return njs_array_buffer_create(vm, value, NULL, 0);
+    }
+
+    return njs_array_buffer_create(vm, value, b->pos, b->last - b->pos);
+}
+
+
 static char *
 ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
     ngx_stream_js_srv_conf_t *jscf = conf;
 
-    size_t                 size;
-    u_char                *start, *end;
-    ssize_t                n;
-    ngx_fd_t               fd;
-    ngx_str_t             *value, file;
-    nxt_int_t              rc;
-    nxt_str_t              text, ext;
-    nxt_lvlhsh_t           externals;
-    ngx_file_info_t        fi;
-    njs_vm_shared_t       *shared;
-    ngx_pool_cleanup_t    *cln;
-    nxt_mem_cache_pool_t  *mcp;
+    size_t                   size;
+    u_char                  *start, *end;
+    ssize_t                  n;
+    uint32_t                 crc32;
+    ngx_fd_t                 fd;
+    ngx_str_t               *value, file;
+    nxt_int_t                rc;
+    nxt_str_t                text, ext;
+    nxt_lvlhsh_t             externals;
+    ngx_file_info_t          fi;
+    njs_vm_shared_t         *shared;
+    ngx_pool_cleanup_t      *cln;
+    nxt_mem_cache_pool_t    *mcp;
+    ngx_stream_js_script_t  *script;
 
     if (jscf->vm) {
         return "is duplicate";
@@ -495,18 +641,54 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 
     end = start + size;
 
+    cln = ngx_pool_cleanup_add(cf->pool, 0);
+    if (cln == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    crc32 = ngx_crc32_long(start, size);
+
+    script = ngx_stream_js_script_find(&file, size, crc32);
+
+    if (script != NULL) {
+        ngx_log_debug1(NGX_LOG_DEBUG_STREAM, cf->log, 0,
+                       "js include \"%V\" is not changed", &file);
+
+        script->count++;
+
+        cln->handler = ngx_stream_js_cleanup_script;
+        cln->data = script;
+
+        jscf->vm = script->vm;
+
+        goto externals;
+    }
+
+    script = ngx_alloc(sizeof(ngx_stream_js_script_t) + file.len, cf->log);
+    if (script == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
     mcp = ngx_stream_js_create_mem_cache_pool();
     if (mcp == NULL) {
+        ngx_free(script);
         return NGX_CONF_ERROR;
     }
 
-    cln = ngx_pool_cleanup_add(cf->pool, 0);
-    if (cln == NULL) {
-        return NULL;
-    }
+    script->file.len = file.len;
+    script->file.data = (u_char *) &script[1];
+    ngx_memcpy(script->file.data, file.data, file.len);
 
-    cln->handler = ngx_stream_js_cleanup_mem_cache_pool;
-    cln->data = mcp;
+    script->size = size;
+    script->crc32 = crc32;
+    script->count = 1;
+    script->vm = NULL;
+    script->mem_cache_pool = mcp;
+
+    ngx_queue_init(&script->queue);
+
+    cln->handler = ngx_stream_js_cleanup_script;
+    cln->data = script;
 
     shared = NULL;
 
@@ -525,6 +707,8 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    script->vm = jscf->vm;
+
     rc = njs_vm_compile(jscf->vm, &start, end, NULL);
 
     if (rc != NJS_OK) {
@@ -543,6 +727,10 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    ngx_queue_insert_tail(&ngx_stream_js_scripts, &script->queue);
+
+externals:
+
     ext = nxt_string_value("$s");
 
     if (njs_vm_external(jscf->vm, NULL, &ext, &jscf->arg) != NJS_OK) {
@@ -558,8 +746,12 @@ ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 static char *
 ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
-    ngx_str_t              *value, *fname;
-    ngx_stream_variable_t  *v;
+    ngx_stream_js_srv_conf_t *jscf = conf;
+
+    ngx_str_t                   *value;
+    ngx_stream_js_set_t         *set, **sp;
+    ngx_stream_variable_t       *v;
+    ngx_stream_js_main_conf_t   *jmcf;
 
     value = cf->args->elts;
 
@@ -577,20 +769,87 @@ ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    fname = ngx_palloc(cf->pool, sizeof(ngx_str_t));
-    if (fname == NULL) {
+    set = ngx_pcalloc(cf->pool, sizeof(ngx_stream_js_set_t));
+    if (set == NULL) {
         return NGX_CONF_ERROR;
     }
 
-    *fname = value[2];
+    set->fname = value[2];
+    set->conf = jscf;
+
+    jmcf = ngx_stream_conf_get_module_main_conf(cf, ngx_stream_js_module);
+
+    sp = ngx_array_push(&jmcf->sets);
+    if (sp == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    *sp = set;
 
     v->get_handler = ngx_stream_js_variable;
-    v->data = (uintptr_t) fname;
+    v->data = (uintptr_t) set;
 
     return NGX_CONF_OK;
 }
 
 
+static ngx_int_t
+ngx_stream_js_init(ngx_conf_t *cf)
+{
+    nxt_str_t                   name;
+    ngx_uint_t                  i;
+    ngx_stream_js_set_t       **sets;
+    ngx_stream_js_main_conf_t  *jmcf;
+
+    jmcf = ngx_stream_conf_get_module_main_conf(cf, ngx_stream_js_module);
+
+    sets = jmcf->sets.elts;
+
+    for (i = 0; i < jmcf->sets.nelts; i++) {
+
+        if (sets[i]->conf->vm == NULL) {
+            continue;
+        }
+
+        name.start = sets[i]->fname.data;
+        name.length = sets[i]->fname.len;
+
+        sets[i]->index = njs_vm_function_index(sets[i]->conf->vm, &name);
+
+        if (sets[i]->index == NJS_INDEX_ERROR) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "js function \"%V\" not found", &sets[i]->fname);
+            return NGX_ERROR;
+        }
+
+        sets[i]->vm = sets[i]->conf->vm;
+    }
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_stream_js_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_stream_js_main_conf_t  *conf;
+
+    conf = ngx_pcalloc(cf->pool, sizeof(ngx_stream_js_main_conf_t));
+    if (conf == NULL) {
+        return NULL;
+    }
+
+    if (ngx_array_init(&conf->sets, cf->pool, 4,
+                       sizeof(ngx_stream_js_set_t *))
+        != NGX_OK)
+    {
+        return NULL;
+    }
+
+    return conf;
+}
+
+
 static void *
 ngx_stream_js_create_srv_conf(ngx_conf_t *cf)
 {
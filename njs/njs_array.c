@@ -10,6 +10,7 @@
 #include <nxt_string.h>
 #include <nxt_stub.h>
 #include <nxt_djb_hash.h>
+#include <nxt_dtoa.h>
 #include <nxt_array.h>
 #include <nxt_lvlhsh.h>
 #include <nxt_random.h>
@@ -34,17 +35,27 @@ typedef struct {
 
 typedef struct {
     union {
-        njs_continuation_t  cont;
-        u_char              padding[NJS_CONTINUATION_SIZE];
+        njs_continuation_t      cont;
+        u_char                  padding[NJS_CONTINUATION_SIZE];
     } u;
     /*
      * This retval value must be aligned so the continuation is padded
      * to aligned size.
      */
-    njs_value_t             retval;
+    njs_value_t                 retval;
 
-    uint32_t                next_index;
-    uint32_t                length;
+    /* A lambda callback frame reused by the next calls. */
+    njs_native_frame_t          *frame;
+
+    /*
+     * The code calls a native callback which arguments should be converted
+     * and returns to the iterator continuation.
+     */
+    njs_vmcode_function_call_t  call;
+    njs_vmcode_1addr_t          nexus;
+
+    uint32_t                    next_index;
+    uint32_t                    length;
 } njs_array_iter_t;
 
 
@@ -74,15 +85,50 @@ typedef struct {
     njs_value_t             retval;
 
     njs_function_t          *function;
-    int32_t                 index;
-    uint32_t                current;
+
+    /*
+     * The valid array values except undefined are sorted by bottom-up
+     * merge sort in the values, the [lo, mid) and [mid, hi) runs are
+     * merged to the tmp.  The undefined values are only counted.
+     */
+    njs_value_t             *values;
+    njs_value_t             *tmp;
+    uint32_t                length;
+    uint32_t                undefined;
+    uint32_t                width;
+    uint32_t                lo;
+    uint32_t                mid;
+    uint32_t                hi;
+    uint32_t                i;
+    uint32_t                j;
+
+    uint8_t                 compared;  /* 1 bit */
+    uint8_t                 check;     /* 1 bit */
 } njs_array_sort_t;
 
 
+typedef struct {
+    njs_value_t             value;
+    njs_value_t             key;
+} njs_array_sort_slot_t;
+
+
+typedef nxt_bool_t (*njs_array_sort_gt_t)(const njs_value_t *key1,
+    const njs_value_t *key2);
+
+
+/* Runs of the native sort are sorted by insertion sort first. */
+#define NJS_ARRAY_SORT_RUN  8
+
+
 static njs_ret_t njs_array_prototype_to_string_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t retval);
 static njs_ret_t njs_array_prototype_join_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
+static njs_ret_t njs_array_join_values(njs_vm_t *vm, njs_array_t *array,
+    njs_array_join_t *join);
+static nxt_noinline void njs_array_join_string(njs_string_prop_t *string,
+    const njs_value_t *value, u_char *buf);
 static njs_value_t *njs_array_copy(njs_value_t *dst, njs_value_t *src);
 static njs_ret_t njs_array_index_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, nxt_bool_t first);
@@ -106,9 +152,27 @@ static nxt_noinline uint32_t njs_array_iterator_next(njs_array_t *array,
     uint32_t n, uint32_t length);
 static nxt_noinline njs_ret_t njs_array_iterator_apply(njs_vm_t *vm,
     njs_array_iter_t *iter, njs_value_t *args, nxt_uint_t nargs);
+static nxt_noinline njs_ret_t njs_array_iterator_call(njs_vm_t *vm,
+    njs_array_iter_t *iter, njs_function_t *function, njs_value_t *args,
+    nxt_uint_t nargs);
+static njs_ret_t njs_array_iterator_native_call(njs_vm_t *vm,
+    njs_array_iter_t *iter, njs_function_t *function, njs_value_t *args,
+    nxt_uint_t nargs);
 static uint32_t njs_array_reduce_right_next(njs_array_t *array, int32_t n);
+static njs_ret_t njs_array_sort_native(njs_vm_t *vm, njs_array_t *array,
+    njs_function_t *function);
+static nxt_bool_t njs_array_sort_string_gt(const njs_value_t *key1,
+    const njs_value_t *key2);
+static nxt_bool_t njs_array_sort_ascending_gt(const njs_value_t *key1,
+    const njs_value_t *key2);
+static nxt_bool_t njs_array_sort_descending_gt(const njs_value_t *key1,
+    const njs_value_t *key2);
+static void njs_array_merge_sort(njs_array_sort_slot_t *slots,
+    njs_array_sort_slot_t *tmp, uint32_t n, njs_array_sort_gt_t gt);
 static njs_ret_t njs_array_prototype_sort_continuation(njs_vm_t *vm,
     njs_value_t *args, nxt_uint_t nargs, njs_index_t unused);
+static void njs_array_sort_finish(njs_vm_t *vm, njs_array_t *array,
+    njs_value_t *values, uint32_t n, uint32_t undefined);
 
 
 nxt_noinline njs_array_t *
@@ -130,10 +194,13 @@ njs_array_alloc(njs_vm_t *vm, uint32_t length, uint32_t spare)
         return NULL;
     }
 
+    njs_array_spare_init(&array->data[length], spare);
+
     array->start = array->data;
     nxt_lvlhsh_init(&array->object.hash);
     nxt_lvlhsh_init(&array->object.shared_hash);
     array->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_ARRAY];
+    array->object.shape = NULL;
     array->object.shared = 0;
     array->size = size;
     array->length = length;
@@ -183,7 +250,6 @@ njs_ret_t
 njs_array_realloc(njs_vm_t *vm, njs_array_t *array, uint32_t prepend,
     uint32_t size)
 {
-    nxt_uint_t   n;
     njs_value_t  *value, *old;
 
     if (size != array->size) {
@@ -204,27 +270,16 @@ njs_array_realloc(njs_vm_t *vm, njs_array_t *array, uint32_t prepend,
     old = array->data;
     array->data = value;
 
-    while (prepend != 0) {
-        njs_set_invalid(value);
-        value++;
-        prepend--;
-    }
+    njs_array_spare_init(value, prepend);
+    value += prepend;
 
-    memcpy(value, array->start, array->size * sizeof(njs_value_t));
+    /* Only the array values are copied, the spare values are invalid. */
+    memcpy(value, array->start, array->length * sizeof(njs_value_t));
+    njs_array_spare_init(&value[array->length], size - array->length);
 
     array->start = value;
-    n = array->size;
     array->size = size;
 
-    value += n;
-    size -= n;
-
-    while (size != 0) {
-        njs_set_invalid(value);
-        value++;
-        size--;
-    }
-
     nxt_mem_cache_free(vm->mem_cache_pool, old);
 
     return NXT_OK;
@@ -440,8 +495,8 @@ njs_array_prototype_push(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
 
-        if (nargs != 0) {
-            if (nargs > array->size - array->length) {
+        if (nargs > 1) {
+            if (nargs - 1 > array->size - array->length) {
                 ret = njs_array_realloc(vm, array, 0, array->size + nargs);
                 if (nxt_slow_path(ret != NXT_OK)) {
                     return ret;
@@ -465,10 +520,10 @@ static njs_ret_t
 njs_array_prototype_pop(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    njs_array_t        *array;
-    const njs_value_t  *retval, *value;
+    njs_array_t  *array;
+    njs_value_t  *value;
 
-    retval = &njs_value_void;
+    vm->retval = njs_value_void;
 
     if (njs_is_array(&args[0])) {
         array = args[0].data.u.array;
@@ -478,13 +533,12 @@ njs_array_prototype_pop(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             value = &array->start[array->length];
 
             if (njs_is_valid(value)) {
-                retval = value;
+                vm->retval = *value;
+                njs_set_invalid(value);
             }
         }
     }
 
-    vm->retval = *retval;
-
     return NXT_OK;
 }
 
@@ -503,13 +557,21 @@ njs_array_prototype_unshift(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         if (n != 0) {
             if ((intptr_t) n > (array->start - array->data)) {
-                ret = njs_array_realloc(vm, array, n, array->size);
+                /*
+                 * The values are prepended in a spare space
+                 * which grows with the array length.
+                 */
+                ret = njs_array_realloc(vm, array,
+                                        n + nxt_max(array->length / 2,
+                                                    NJS_ARRAY_SPARE),
+                                        array->size);
                 if (nxt_slow_path(ret != NXT_OK)) {
                     return ret;
                 }
             }
 
             array->length += n;
+            array->size += n;
             n = nargs;
 
             do {
@@ -544,6 +606,7 @@ njs_array_prototype_shift(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
             value = &array->start[0];
             array->start++;
+            array->size--;
 
             if (njs_is_valid(value)) {
                 retval = value;
@@ -618,6 +681,11 @@ njs_array_prototype_splice(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             memmove(&array->start[start + items], &array->start[n],
                     (array->length - n) * sizeof(njs_value_t));
 
+            if (delta < 0) {
+                njs_array_spare_init(&array->start[array->length + delta],
+                                     -delta);
+            }
+
             array->length += delta;
         }
 
@@ -720,76 +788,30 @@ static njs_ret_t
 njs_array_prototype_join(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
 {
-    uint32_t          max;
-    nxt_uint_t        i, n;
-    njs_array_t       *array;
-    njs_value_t       *value, *values;
     njs_array_join_t  *join;
 
-    if (!njs_is_array(&args[0])) {
-        goto empty;
-    }
-
-    array = args[0].data.u.array;
-
-    if (array->length == 0) {
-        goto empty;
+    if (!njs_is_array(&args[0]) || args[0].data.u.array->length == 0) {
+        vm->retval = njs_string_empty;
+        return NXT_OK;
     }
 
     join = (njs_array_join_t *) njs_continuation(vm->frame);
+    join->cont.function = njs_array_prototype_join_continuation;
     join->values = NULL;
     join->max = 0;
-    max = 0;
-
-    for (i = 0; i < array->length; i++) {
-        value = &array->start[i];
-        if (!njs_is_string(value)
-            && njs_is_valid(value)
-            && !njs_is_null_or_void(value))
-        {
-            max++;
-        }
-    }
-
-    if (max != 0) {
-        values = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
-                                     sizeof(njs_value_t) * max);
-        if (nxt_slow_path(values == NULL)) {
-            return NXT_ERROR;
-        }
-
-        join = (njs_array_join_t *) njs_continuation(vm->frame);
-        join->cont.function = njs_array_prototype_join_continuation;
-        join->values = values;
-        join->max = max;
-
-        n = 0;
-
-        for (i = 0; i < array->length; i++) {
-            value = &array->start[i];
-            if (!njs_is_string(value)
-                && njs_is_valid(value)
-                && !njs_is_null_or_void(value))
-            {
-                values[n++] = *value;
-
-                if (n >= max) {
-                    break;
-                }
-            }
-        }
-    }
 
     return njs_array_prototype_join_continuation(vm, args, nargs, unused);
-
-empty:
-
-    vm->retval = njs_string_empty;
-
-    return NXT_OK;
 }
 
 
+/*
+ * Primitive array values are converted to strings inline while the result
+ * size is calculated and then once more while the result is copied.
+ * Only objects are copied to the join->values array on the first object
+ * occurrence and are converted to strings by the String() trap which
+ * restarts the continuation.
+ */
+
 static njs_ret_t
 njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
@@ -797,60 +819,67 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     u_char             *p;
     size_t             size, length, mask;
     uint32_t           max;
+    njs_ret_t          ret;
     nxt_uint_t         i, n;
     njs_array_t        *array;
     njs_value_t        *value, *values;
     njs_array_join_t   *join;
     njs_string_prop_t  separator, string;
+    u_char             buf[NXT_DTOA_MAX_LEN];
 
     join = (njs_array_join_t *) njs_continuation(vm->frame);
     values = join->values;
     max = join->max;
 
-    size = 0;
-    length = 0;
-    n = 0;
-    mask = -1;
-
     array = args[0].data.u.array;
 
-    for (i = 0; i < array->length; i++) {
-        value = &array->start[i];
+    if (nargs > 1) {
+        value = &args[1];
 
-        if (njs_is_valid(value) && !njs_is_null_or_void(value)) {
+    } else {
+        value = (njs_value_t *) &njs_string_comma;
+    }
 
-            if (!njs_is_string(value)) {
-                value = &values[n++];
+    (void) njs_string_prop(&separator, value);
 
-                if (!njs_is_string(value)) {
-                    vm->frame->trap_scratch.data.u.value = value;
+    size = separator.size * (array->length - 1);
+    length = separator.length * (array->length - 1);
+    n = 0;
+    mask = (separator.length == 0 && separator.size != 0) ? 0 : -1;
+
+    for (i = 0; i < array->length; i++) {
+        value = &array->start[i];
+
+        if (!njs_is_primitive(value) && njs_is_valid(value)) {
 
-                    return NJS_TRAP_STRING_ARG;
+            if (values == NULL) {
+                ret = njs_array_join_values(vm, array, join);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
                 }
+
+                values = join->values;
+                max = join->max;
             }
 
-            (void) njs_string_prop(&string, value);
+            value = &values[n++];
 
-            size += string.size;
-            length += string.length;
+            if (!njs_is_string(value)) {
+                vm->frame->trap_scratch.data.u.value = value;
 
-            if (string.length == 0 && string.size != 0) {
-                mask = 0;
+                return NJS_TRAP_STRING_ARG;
             }
         }
-    }
 
-    if (nargs > 1) {
-        value = &args[1];
+        njs_array_join_string(&string, value, buf);
 
-    } else {
-        value = (njs_value_t *) &njs_string_comma;
-    }
-
-    (void) njs_string_prop(&separator, value);
+        size += string.size;
+        length += string.length;
 
-    size += separator.size * (array->length - 1);
-    length += separator.length * (array->length - 1);
+        if (string.length == 0 && string.size != 0) {
+            mask = 0;
+        }
+    }
 
     length &= mask;
 
@@ -864,16 +893,14 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
     for (i = 0; i < array->length; i++) {
         value = &array->start[i];
 
-        if (njs_is_valid(value) && !njs_is_null_or_void(value)) {
-            if (!njs_is_string(value)) {
-                value = &values[n++];
-            }
+        if (!njs_is_primitive(value) && njs_is_valid(value)) {
+            value = &values[n++];
+        }
 
-            (void) njs_string_prop(&string, value);
+        njs_array_join_string(&string, value, buf);
 
-            p = memcpy(p, string.start, string.size);
-            p += string.size;
-        }
+        p = memcpy(p, string.start, string.size);
+        p += string.size;
 
         if (i < array->length - 1) {
             p = memcpy(p, separator.start, separator.size);
@@ -881,16 +908,108 @@ njs_array_prototype_join_continuation(njs_vm_t *vm, njs_value_t *args,
         }
     }
 
-    for (i = 0; i < max; i++) {
-        njs_release(vm, &values[i]);
+    if (values != NULL) {
+        for (i = 0; i < max; i++) {
+            njs_release(vm, &values[i]);
+        }
+
+        nxt_mem_cache_free(vm->mem_cache_pool, values);
     }
 
-    nxt_mem_cache_free(vm->mem_cache_pool, values);
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_array_join_values(njs_vm_t *vm, njs_array_t *array, njs_array_join_t *join)
+{
+    uint32_t     max;
+    nxt_uint_t   i, n;
+    njs_value_t  *value, *values;
+
+    max = 0;
+
+    for (i = 0; i < array->length; i++) {
+        value = &array->start[i];
+
+        if (!njs_is_primitive(value) && njs_is_valid(value)) {
+            max++;
+        }
+    }
+
+    values = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                 sizeof(njs_value_t) * max);
+    if (nxt_slow_path(values == NULL)) {
+        return NXT_ERROR;
+    }
+
+    n = 0;
+
+    for (i = 0; i < array->length; i++) {
+        value = &array->start[i];
+
+        if (!njs_is_primitive(value) && njs_is_valid(value)) {
+            values[n++] = *value;
+        }
+    }
+
+    join->values = values;
+    join->max = max;
 
     return NXT_OK;
 }
 
 
+/*
+ * The buffer is used for a number and must have
+ * at least NXT_DTOA_MAX_LEN bytes.  Invalid, null
+ * and void values are converted to empty strings.
+ */
+
+static nxt_noinline void
+njs_array_join_string(njs_string_prop_t *string, const njs_value_t *value,
+    u_char *buf)
+{
+    double  num;
+
+    switch (value->type) {
+
+    case NJS_STRING:
+        break;
+
+    case NJS_NUMBER:
+        num = value->data.u.number;
+
+        if (njs_is_nan(num)) {
+            value = &njs_string_nan;
+
+        } else if (njs_is_infinity(num)) {
+            value = (num < 0) ? &njs_string_minus_infinity
+                              : &njs_string_plus_infinity;
+
+        } else {
+            string->start = buf;
+            string->size = nxt_dtoa(num, buf);
+            string->length = string->size;
+
+            return;
+        }
+
+        break;
+
+    case NJS_BOOLEAN:
+        value = njs_is_true(value) ? &njs_string_true : &njs_string_false;
+        break;
+
+    default:
+        value = &njs_string_empty;
+        break;
+    }
+
+    (void) njs_string_prop(string, (njs_value_t *) value);
+}
+
+
 static njs_ret_t
 njs_array_prototype_concat(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
@@ -1336,8 +1455,8 @@ njs_array_prototype_reduce_continuation(njs_vm_t *vm, njs_value_t *args,
 
     iter->next_index = njs_array_iterator_next(array, n + 1, iter->length);
 
-    return njs_function_apply(vm, args[1].data.u.function, arguments, 5,
-                              (njs_index_t) &iter->retval);
+    return njs_array_iterator_call(vm, iter, args[1].data.u.function,
+                                   arguments, 5);
 }
 
 
@@ -1351,6 +1470,7 @@ njs_array_iterator_args(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs)
 
         array = args[0].data.u.array;
         iter = njs_continuation(vm->frame);
+        iter->frame = NULL;
         iter->length = array->length;
         iter->next_index = njs_array_iterator_next(array, 0, array->length);
 
@@ -1411,8 +1531,111 @@ njs_array_iterator_apply(njs_vm_t *vm, njs_array_iter_t *iter,
 
     iter->next_index = njs_array_iterator_next(array, n + 1, iter->length);
 
-    return njs_function_apply(vm, args[1].data.u.function, arguments, 4,
-                              (njs_index_t) &iter->retval);
+    return njs_array_iterator_call(vm, iter, args[1].data.u.function,
+                                   arguments, 4);
+}
+
+
+/*
+ * njs_array_iterator_call() calls an iterator callback, the result is
+ * stored in iter->retval.  The iterator continuations are called from
+ * the continuation nexus, so NJS_APPLIED returned after a native callback
+ * call makes the nexus to call the continuation again for the next element
+ * without a callback frame.  A lambda callback frame allocated in the spare
+ * space of the iterator frame is left there after the lambda return, so it
+ * is reused by the next calls and only the arguments and local scope are
+ * refreshed.
+ */
+
+static nxt_noinline njs_ret_t
+njs_array_iterator_call(njs_vm_t *vm, njs_array_iter_t *iter,
+    njs_function_t *function, njs_value_t *args, nxt_uint_t nargs)
+{
+    njs_ret_t  ret;
+
+    if (function->native) {
+
+        if (function->continuation_size != 0 || function->bound != NULL) {
+            return njs_array_iterator_native_call(vm, iter, function, args,
+                                                  nargs);
+        }
+
+        ret = njs_normalize_args(vm, args, function->args_types, nargs);
+
+        if (nxt_fast_path(ret == NXT_OK)) {
+            ret = function->u.native(vm, args, nargs,
+                                     (njs_index_t) &iter->retval);
+
+            if (nxt_fast_path(ret == NXT_OK)) {
+                /* GC: retain vm->retval */
+                iter->retval = vm->retval;
+                return NJS_APPLIED;
+            }
+
+            /* Some natives check their arguments themselves. */
+
+            if (ret != NJS_TRAP_NUMBER_ARG && ret != NJS_TRAP_STRING_ARG) {
+                return ret;
+            }
+
+        } else if (nxt_slow_path(ret == NXT_ERROR)) {
+            return ret;
+        }
+
+        /* An argument should be converted by a trap. */
+
+        return njs_array_iterator_native_call(vm, iter, function, args, nargs);
+    }
+
+    if (iter->frame != NULL) {
+        njs_function_frame_reuse(vm, iter->frame, &args[1], nargs - 1);
+
+    } else {
+        ret = njs_function_frame(vm, function, &args[0], &args[1], nargs - 1,
+                                 0);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        if (!vm->frame->first) {
+            iter->frame = vm->frame;
+        }
+    }
+
+    return njs_function_call(vm, (njs_index_t) &iter->retval, 0);
+}
+
+
+/*
+ * A native callback which is a continuation or a bound function or which
+ * arguments should be converted by traps is called by the function call
+ * instruction, the same way as Function.prototype.call() does it.  The
+ * instruction is followed by the continuation nexus which calls the
+ * iterator continuation again after the callback return.
+ */
+
+static njs_ret_t
+njs_array_iterator_native_call(njs_vm_t *vm, njs_array_iter_t *iter,
+    njs_function_t *function, njs_value_t *args, nxt_uint_t nargs)
+{
+    njs_ret_t  ret;
+
+    ret = njs_function_native_frame(vm, function, &args[0], &args[1],
+                                    nargs - 1, 0, 0);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    iter->call.code.operation = njs_vmcode_function_call;
+    iter->call.code.operands = NJS_VMCODE_1OPERAND;
+    iter->call.code.retval = NJS_VMCODE_NO_RETVAL;
+    iter->call.retval = (njs_index_t) &iter->retval;
+
+    iter->nexus = njs_continuation_nexus[0];
+
+    vm->current = (u_char *) &iter->call;
+
+    return NJS_APPLIED;
 }
 
 
@@ -1430,6 +1653,7 @@ njs_array_prototype_reduce_right(njs_vm_t *vm, njs_value_t *args,
 
     iter = njs_continuation(vm->frame);
     iter->u.cont.function = njs_array_prototype_reduce_right_continuation;
+    iter->frame = NULL;
 
     array = args[0].data.u.array;
     iter->next_index = njs_array_reduce_right_next(array, array->length);
@@ -1490,8 +1714,8 @@ njs_array_prototype_reduce_right_continuation(njs_vm_t *vm, njs_value_t *args,
 
     iter->next_index = njs_array_reduce_right_next(array, n);
 
-    return njs_function_apply(vm, args[1].data.u.function, arguments, 5,
-                              (njs_index_t) &iter->retval);
+    return njs_array_iterator_call(vm, iter, args[1].data.u.function,
+                                   arguments, 5);
 }
 
 
@@ -1548,103 +1772,431 @@ static njs_ret_t
 njs_array_prototype_sort(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
+    uint32_t          i, n, undefined;
+    njs_ret_t         ret;
+    njs_array_t       *array;
+    njs_value_t       *values;
+    njs_function_t    *function;
     njs_array_sort_t  *sort;
 
-    if (njs_is_array(&args[0]) && args[0].data.u.array->length > 1) {
+    if (!njs_is_array(&args[0]) || args[0].data.u.array->length <= 1) {
+        vm->retval = args[0];
+        return NXT_OK;
+    }
+
+    array = args[0].data.u.array;
+
+    function = NULL;
+
+    if (nargs > 1 && njs_is_function(&args[1])) {
+        function = args[1].data.u.function;
+    }
+
+    ret = njs_array_sort_native(vm, array, function);
+
+    if (ret != NXT_DECLINED) {
+        if (nxt_fast_path(ret == NXT_OK)) {
+            vm->retval = args[0];
+        }
+
+        return ret;
+    }
+
+    n = 0;
+
+    for (i = 0; i < array->length; i++) {
+        if (njs_is_valid(&array->start[i])) {
+            n++;
+        }
+    }
+
+    values = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 2 * n * sizeof(njs_value_t));
+    if (nxt_slow_path(values == NULL)) {
+        return NXT_ERROR;
+    }
+
+    n = 0;
+    undefined = 0;
+
+    for (i = 0; i < array->length; i++) {
+        if (!njs_is_valid(&array->start[i])) {
+            continue;
+        }
 
-        sort = njs_continuation(vm->frame);
-        sort->u.cont.function = njs_array_prototype_sort_continuation;
-        sort->current = 0;
-        sort->retval = njs_value_zero;
+        /* The undefined values are not passed to the comparison function. */
 
-        if (nargs > 1 && njs_is_function(&args[1])) {
-            sort->function = args[1].data.u.function;
+        if (njs_is_void(&array->start[i])) {
+            undefined++;
+            continue;
+        }
+
+        /* GC: retain. */
+        values[n++] = array->start[i];
+    }
+
+    if (n < 2) {
+        njs_array_sort_finish(vm, array, values, n, undefined);
+        vm->retval = args[0];
+
+        return NXT_OK;
+    }
+
+    sort = njs_continuation(vm->frame);
+    sort->u.cont.function = njs_array_prototype_sort_continuation;
+
+    sort->function = (function != NULL)
+                     ? function
+                     : (njs_function_t *) &njs_array_string_sort_function;
+
+    sort->values = values;
+    sort->tmp = values + n;
+    sort->length = n;
+    sort->undefined = undefined;
+    sort->width = 1;
+    sort->lo = 0;
+    sort->mid = 1;
+    sort->hi = 2;
+    sort->i = 0;
+    sort->j = 1;
+    sort->compared = 0;
+    sort->check = 1;
+
+    return njs_array_prototype_sort_continuation(vm, args, nargs, unused);
+}
+
+
+/*
+ * The default comparison of primitive values and the numeric comparison
+ * functions recognized by generator do not call functions, so the values
+ * are sorted natively.
+ */
+
+static njs_ret_t
+njs_array_sort_native(njs_vm_t *vm, njs_array_t *array,
+    njs_function_t *function)
+{
+    uint32_t               i, n, undefined;
+    njs_ret_t              ret;
+    njs_value_t            *value;
+    njs_array_sort_gt_t    gt;
+    njs_array_sort_slot_t  *slots;
+
+    if (function == NULL) {
+        gt = njs_array_sort_string_gt;
+
+        for (i = 0; i < array->length; i++) {
+            value = &array->start[i];
+
+            if (njs_is_valid(value) && !njs_is_primitive(value)) {
+                return NXT_DECLINED;
+            }
+        }
+
+    } else if (!function->native
+               && function->bound == NULL
+               && function->u.lambda->compare != 0)
+    {
+        gt = (function->u.lambda->compare == NJS_LAMBDA_COMPARE_ASCENDING)
+             ? njs_array_sort_ascending_gt
+             : njs_array_sort_descending_gt;
+
+        for (i = 0; i < array->length; i++) {
+            value = &array->start[i];
+
+            if (njs_is_valid(value)
+                && !njs_is_number(value)
+                && !njs_is_void(value))
+            {
+                return NXT_DECLINED;
+            }
+        }
+
+    } else {
+        return NXT_DECLINED;
+    }
+
+    slots = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                            2 * array->length * sizeof(njs_array_sort_slot_t));
+    if (nxt_slow_path(slots == NULL)) {
+        return NXT_ERROR;
+    }
+
+    n = 0;
+    undefined = 0;
+
+    for (i = 0; i < array->length; i++) {
+        value = &array->start[i];
+
+        if (!njs_is_valid(value)) {
+            continue;
+        }
+
+        if (njs_is_void(value)) {
+            undefined++;
+            continue;
+        }
+
+        slots[n].value = *value;
+
+        if (function != NULL || njs_is_string(value)) {
+            slots[n].key = *value;
 
         } else {
-            sort->function = (njs_function_t *) &njs_array_string_sort_function;
+            ret = njs_primitive_value_to_string(vm, &slots[n].key, value);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
         }
 
-        return njs_array_prototype_sort_continuation(vm, args, nargs, unused);
+        n++;
     }
 
-    vm->retval = args[0];
+    njs_array_merge_sort(slots, slots + n, n, gt);
+
+    for (i = 0; i < n; i++) {
+        array->start[i] = slots[i].value;
+    }
+
+    n += undefined;
+
+    while (i < n) {
+        array->start[i] = njs_value_void;
+        i++;
+    }
+
+    while (i < array->length) {
+        njs_set_invalid(&array->start[i]);
+        i++;
+    }
+
+    nxt_mem_cache_free(vm->mem_cache_pool, slots);
 
     return NXT_OK;
 }
 
 
+static nxt_bool_t
+njs_array_sort_string_gt(const njs_value_t *key1, const njs_value_t *key2)
+{
+    return (njs_string_cmp(key1, key2) > 0);
+}
+
+
+static nxt_bool_t
+njs_array_sort_ascending_gt(const njs_value_t *key1, const njs_value_t *key2)
+{
+    return (key1->data.u.number - key2->data.u.number > 0);
+}
+
+
+static nxt_bool_t
+njs_array_sort_descending_gt(const njs_value_t *key1, const njs_value_t *key2)
+{
+    return (key2->data.u.number - key1->data.u.number > 0);
+}
+
+
+/*
+ * A stable sort: the runs sorted by insertion sort are merged bottom-up,
+ * a merge is skipped if the runs are already ordered.
+ */
+
+static void
+njs_array_merge_sort(njs_array_sort_slot_t *slots, njs_array_sort_slot_t *tmp,
+    uint32_t n, njs_array_sort_gt_t gt)
+{
+    uint32_t               lo, mid, hi, i, j, k, width;
+    njs_array_sort_slot_t  slot;
+
+    for (lo = 0; lo < n; lo += NJS_ARRAY_SORT_RUN) {
+        hi = nxt_min(lo + NJS_ARRAY_SORT_RUN, n);
+
+        for (i = lo + 1; i < hi; i++) {
+            slot = slots[i];
+            j = i;
+
+            while (j > lo && gt(&slots[j - 1].key, &slot.key)) {
+                slots[j] = slots[j - 1];
+                j--;
+            }
+
+            slots[j] = slot;
+        }
+    }
+
+    for (width = NJS_ARRAY_SORT_RUN; width < n; width *= 2) {
+
+        for (lo = 0; lo + width < n; lo += 2 * width) {
+            mid = lo + width;
+            hi = nxt_min(mid + width, n);
+
+            if (!gt(&slots[mid - 1].key, &slots[mid].key)) {
+                continue;
+            }
+
+            i = lo;
+            j = mid;
+            k = lo;
+
+            while (i < mid && j < hi) {
+                if (gt(&slots[i].key, &slots[j].key)) {
+                    tmp[k++] = slots[j++];
+
+                } else {
+                    tmp[k++] = slots[i++];
+                }
+            }
+
+            /* The rest of the second run is already in place. */
+
+            memcpy(&tmp[k], &slots[i],
+                   (mid - i) * sizeof(njs_array_sort_slot_t));
+            k += mid - i;
+
+            memcpy(&slots[lo], &tmp[lo],
+                   (k - lo) * sizeof(njs_array_sort_slot_t));
+        }
+    }
+}
+
+
 static njs_ret_t
 njs_array_prototype_sort_continuation(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    nxt_int_t         n;
-    njs_array_t       *array;
-    njs_value_t       value, *start, arguments[3];
+    double            cmp;
+    uint32_t          k;
+    njs_value_t       *values, *tmp, arguments[3];
     njs_array_sort_t  *sort;
 
-    array = args[0].data.u.array;
-    start = array->start;
-
     sort = njs_continuation(vm->frame);
 
-    if (njs_is_number(&sort->retval)) {
+    values = sort->values;
+    tmp = sort->tmp;
+
+    for ( ;; ) {
 
         /*
-         * The sort function is impelemented with the insertion sort algorithm.
-         * Its worst and average computational complexity is O^2.  This point
-         * should be considired as return point from comparison function so
-         * "goto next" moves control to the appropriate step of the algorithm.
-         * The first iteration also goes there because sort->retval is zero.
+         * This point should be considered as return point from comparison
+         * function, the result is applied to the current merge step.
          */
-        if (sort->retval.data.u.number <= 0) {
-            goto next;
-        }
+        if (sort->compared) {
+            sort->compared = 0;
 
-        n = sort->index;
+            cmp = njs_is_numeric(&sort->retval) ? sort->retval.data.u.number
+                                                : 0;
 
-    swap:
+            if (sort->check) {
+                sort->check = 0;
 
-        value = start[n];
-        start[n] = start[n - 1];
-        n--;
-        start[n] = value;
+                if (!(cmp > 0)) {
+                    /* The runs are already ordered. */
+                    goto next;
+                }
 
-        do {
-            if (n > 0) {
+            } else {
+                k = sort->i + sort->j - sort->mid;
 
-                if (njs_is_valid(&start[n]) && njs_is_valid(&start[n - 1])) {
-                    arguments[0] = njs_value_void;
+                if (cmp > 0) {
+                    tmp[k] = values[sort->j++];
 
-                    /* GC: array elt, array */
-                    arguments[1] = start[n - 1];
-                    arguments[2] = start[n];
+                } else {
+                    tmp[k] = values[sort->i++];
+                }
+            }
+        }
 
-                    sort->index = n;
+        if (sort->i < sort->mid && sort->j < sort->hi) {
+            arguments[0] = njs_value_void;
 
-                    return njs_function_apply(vm, sort->function, arguments, 3,
-                                              (njs_index_t) &sort->retval);
-                }
+            if (sort->check) {
+                arguments[1] = values[sort->mid - 1];
+                arguments[2] = values[sort->mid];
 
-                if (!njs_is_valid(&start[n - 1]) && njs_is_valid(&start[n])) {
-                    /* Move invalid values to the end of array. */
-                    goto swap;
-                }
+            } else {
+                arguments[1] = values[sort->i];
+                arguments[2] = values[sort->j];
             }
 
-        next:
+            sort->compared = 1;
+
+            return njs_function_apply(vm, sort->function, arguments, 3,
+                                      (njs_index_t) &sort->retval);
+        }
+
+        /* The rest of the second run is already in place. */
+
+        k = sort->i + sort->j - sort->mid;
+
+        memcpy(&tmp[k], &values[sort->i],
+               (sort->mid - sort->i) * sizeof(njs_value_t));
+        k += sort->mid - sort->i;
 
-            sort->current++;
-            n = sort->current;
+        memcpy(&values[sort->lo], &tmp[sort->lo],
+               (k - sort->lo) * sizeof(njs_value_t));
 
-        } while (sort->current < array->length);
+    next:
+
+        sort->lo += 2 * sort->width;
+
+        if (sort->lo + sort->width >= sort->length) {
+            sort->width *= 2;
+            sort->lo = 0;
+
+            if (sort->width >= sort->length) {
+                break;
+            }
+        }
+
+        sort->mid = sort->lo + sort->width;
+        sort->hi = nxt_min(sort->mid + sort->width, sort->length);
+        sort->i = sort->lo;
+        sort->j = sort->mid;
+        sort->check = 1;
     }
 
+    njs_array_sort_finish(vm, args[0].data.u.array, values, sort->length,
+                          sort->undefined);
+
     vm->retval = args[0];
 
     return NXT_OK;
 }
 
 
+/*
+ * The sorted values are stored back to the array followed by the undefined
+ * and then by the invalid values.  The comparison function may have changed
+ * the array length.
+ */
+
+static void
+njs_array_sort_finish(njs_vm_t *vm, njs_array_t *array, njs_value_t *values,
+    uint32_t n, uint32_t undefined)
+{
+    uint32_t  i;
+
+    for (i = 0; i < n && i < array->length; i++) {
+        array->start[i] = values[i];
+    }
+
+    n += undefined;
+
+    while (i < n && i < array->length) {
+        array->start[i] = njs_value_void;
+        i++;
+    }
+
+    while (i < array->length) {
+        njs_set_invalid(&array->start[i]);
+        i++;
+    }
+
+    nxt_mem_cache_free(vm->mem_cache_pool, values);
+}
+
+
 static const njs_object_prop_t  njs_array_prototype_properties[] =
 {
     {
@@ -1786,7 +2338,7 @@ static const njs_object_prop_t  njs_array_prototype_properties[] =
         .type = NJS_METHOD,
         .name = njs_string("sort"),
         .value = njs_native_function(njs_array_prototype_sort,
-                     njs_continuation_size(njs_array_iter_t), 0),
+                     njs_continuation_size(njs_array_sort_t), 0),
     },
 };
 
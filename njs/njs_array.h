@@ -10,6 +10,12 @@
 
 #define NJS_ARRAY_SPARE  8
 
+/*
+ * The "size" field is a number of values allocated from the "start".
+ * The spare values after the "length" are always invalid, so an array
+ * value can be set inside the size without filling the gap.
+ */
+
 struct njs_array_s {
     /* Must be aligned to njs_value_t. */
     njs_object_t         object;
@@ -20,6 +26,19 @@ struct njs_array_s {
 };
 
 
+#define njs_array_spare_init(value, n)                                        \
+    do {                                                                      \
+        njs_value_t  *_v = (value);                                           \
+        uint32_t     _n = (n);                                                \
+                                                                              \
+        while (_n != 0) {                                                     \
+            njs_set_invalid(_v);                                              \
+            _v++;                                                             \
+            _n--;                                                             \
+        }                                                                     \
+    } while (0)
+
+
 njs_array_t *njs_array_alloc(njs_vm_t *vm, uint32_t length, uint32_t spare);
 njs_ret_t njs_array_string_add(njs_vm_t *vm, njs_array_t *array, u_char *start,
     size_t size, size_t length);
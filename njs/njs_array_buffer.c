@@ -0,0 +1,1542 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_string.h>
+#include <nxt_stub.h>
+#include <nxt_djb_hash.h>
+#include <nxt_array.h>
+#include <nxt_lvlhsh.h>
+#include <nxt_random.h>
+#include <nxt_mem_cache_pool.h>
+#include <njscript.h>
+#include <njs_vm.h>
+#include <njs_number.h>
+#include <njs_string.h>
+#include <njs_object.h>
+#include <njs_object_hash.h>
+#include <njs_array.h>
+#include <njs_function.h>
+#include <njs_array_buffer.h>
+#include <string.h>
+
+
+typedef enum {
+    NJS_DATA_VIEW_INT8 = 0,
+    NJS_DATA_VIEW_UINT8,
+    NJS_DATA_VIEW_INT16,
+    NJS_DATA_VIEW_UINT16,
+    NJS_DATA_VIEW_INT32,
+    NJS_DATA_VIEW_UINT32,
+    NJS_DATA_VIEW_FLOAT32,
+    NJS_DATA_VIEW_FLOAT64,
+} njs_data_view_type_t;
+
+
+static njs_typed_array_t *njs_typed_array_alloc(njs_vm_t *vm,
+    njs_array_buffer_t *buffer, uint32_t offset, uint32_t length,
+    nxt_uint_t prototype);
+static njs_ret_t njs_typed_array_copy(njs_vm_t *vm, const u_char *start,
+    uint32_t length);
+static uint32_t njs_typed_array_index(const njs_value_t *value,
+    uint32_t length);
+static njs_ret_t njs_array_buffer_offset(njs_vm_t *vm, njs_value_t *value,
+    uint32_t *offset);
+static njs_ret_t njs_data_view_get(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_data_view_type_t type);
+static njs_ret_t njs_data_view_set(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_data_view_type_t type);
+
+
+static const uint8_t  njs_data_view_size[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+
+njs_array_buffer_t *
+njs_array_buffer_alloc(njs_vm_t *vm, uint32_t size)
+{
+    njs_array_buffer_t  *buffer;
+
+    buffer = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 sizeof(njs_array_buffer_t));
+    if (nxt_slow_path(buffer == NULL)) {
+        return NULL;
+    }
+
+    nxt_lvlhsh_init(&buffer->object.hash);
+    nxt_lvlhsh_init(&buffer->object.shared_hash);
+    buffer->object.shape = NULL;
+    buffer->object.shared = 0;
+    buffer->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_ARRAY_BUFFER];
+
+    buffer->size = size;
+    buffer->read_only = 0;
+    buffer->start = NULL;
+
+    if (size != 0) {
+        buffer->start = nxt_mem_cache_alloc(vm->mem_cache_pool, size);
+        if (nxt_slow_path(buffer->start == NULL)) {
+            return NULL;
+        }
+
+        memset(buffer->start, 0, size);
+    }
+
+    return buffer;
+}
+
+
+/*
+ * njs_array_buffer_create() wraps external memory, e.g. an nginx buffer,
+ * in read-only ArrayBuffer without copying.  The memory must not be freed
+ * while the VM exists.
+ */
+
+njs_ret_t
+njs_array_buffer_create(njs_vm_t *vm, njs_value_t *value, u_char *start,
+    size_t size)
+{
+    njs_array_buffer_t  *buffer;
+
+    if (nxt_slow_path(size > UINT32_MAX)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    buffer = njs_array_buffer_alloc(vm, 0);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    buffer->size = size;
+    buffer->read_only = 1;
+    buffer->start = start;
+
+    value->data.u.array_buffer = buffer;
+    value->type = NJS_ARRAY_BUFFER;
+    value->data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+njs_ret_t
+njs_array_buffer_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    double              num;
+    njs_array_buffer_t  *buffer;
+
+    if (!vm->frame->ctor) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    num = (nargs > 1) ? args[1].data.u.number : 0;
+
+    if (nxt_slow_path(num < 0)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    buffer = njs_array_buffer_alloc(vm, num);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.array_buffer = buffer;
+    vm->retval.type = NJS_ARRAY_BUFFER;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_array_buffer_is_view(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_index_t unused)
+{
+    const njs_value_t  *retval;
+
+    retval = &njs_value_false;
+
+    if (nargs > 1
+        && (njs_is_typed_array(&args[1]) || njs_is_data_view(&args[1])))
+    {
+        retval = &njs_value_true;
+    }
+
+    vm->retval = *retval;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_array_buffer_constructor_properties[] =
+{
+    /* ArrayBuffer.name == "ArrayBuffer". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_long_string("ArrayBuffer"),
+    },
+
+    /* ArrayBuffer.length == 1. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 1.0),
+    },
+
+    /* ArrayBuffer.prototype. */
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("prototype"),
+        .value = njs_native_getter(njs_object_prototype_create),
+    },
+
+    /* ArrayBuffer.isView(). */
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("isView"),
+        .value = njs_native_function(njs_array_buffer_is_view, 0, 0),
+    },
+};
+
+
+const njs_object_init_t  njs_array_buffer_constructor_init = {
+    njs_array_buffer_constructor_properties,
+    nxt_nitems(njs_array_buffer_constructor_properties),
+};
+
+
+static njs_ret_t
+njs_array_buffer_prototype_byte_length(njs_vm_t *vm, njs_value_t *value)
+{
+    if (njs_is_array_buffer(value)) {
+        njs_number_set(&vm->retval, value->data.u.array_buffer->size);
+
+    } else {
+        vm->retval = njs_value_void;
+    }
+
+    return NXT_OK;
+}
+
+
+/*
+ * ArrayBuffer.slice(start[, end]).
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_array_buffer_prototype_slice(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            start, end, size;
+    njs_array_buffer_t  *buffer, *from;
+
+    if (nxt_slow_path(!njs_is_array_buffer(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    from = args[0].data.u.array_buffer;
+    size = from->size;
+
+    start = (nargs > 1) ? njs_typed_array_index(&args[1], size) : 0;
+    end = (nargs > 2) ? njs_typed_array_index(&args[2], size) : size;
+
+    size = (end > start) ? end - start : 0;
+
+    buffer = njs_array_buffer_alloc(vm, size);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    if (size != 0) {
+        memcpy(buffer->start, from->start + start, size);
+    }
+
+    vm->retval.data.u.array_buffer = buffer;
+    vm->retval.type = NJS_ARRAY_BUFFER;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_array_buffer_prototype_properties[] =
+{
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("byteLength"),
+        .value = njs_native_getter(njs_array_buffer_prototype_byte_length),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("slice"),
+        .value = njs_native_function(njs_array_buffer_prototype_slice, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+};
+
+
+const njs_object_init_t  njs_array_buffer_prototype_init = {
+    njs_array_buffer_prototype_properties,
+    nxt_nitems(njs_array_buffer_prototype_properties),
+};
+
+
+static njs_typed_array_t *
+njs_typed_array_alloc(njs_vm_t *vm, njs_array_buffer_t *buffer,
+    uint32_t offset, uint32_t length, nxt_uint_t prototype)
+{
+    njs_typed_array_t  *array;
+
+    array = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_typed_array_t));
+    if (nxt_slow_path(array == NULL)) {
+        return NULL;
+    }
+
+    nxt_lvlhsh_init(&array->object.hash);
+    nxt_lvlhsh_init(&array->object.shared_hash);
+    array->object.shape = NULL;
+    array->object.shared = 0;
+    array->object.__proto__ = &vm->prototypes[prototype];
+
+    array->offset = offset;
+    array->length = length;
+    array->start = buffer->start + offset;
+    array->buffer = buffer;
+
+    return array;
+}
+
+
+/* A new Uint8Array with a copy of the bytes is set to vm->retval. */
+
+static njs_ret_t
+njs_typed_array_copy(njs_vm_t *vm, const u_char *start, uint32_t length)
+{
+    njs_typed_array_t   *array;
+    njs_array_buffer_t  *buffer;
+
+    buffer = njs_array_buffer_alloc(vm, length);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    if (start != NULL && length != 0) {
+        memcpy(buffer->start, start, length);
+    }
+
+    array = njs_typed_array_alloc(vm, buffer, 0, length,
+                                  NJS_PROTOTYPE_TYPED_ARRAY);
+    if (nxt_slow_path(array == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.typed_array = array;
+    vm->retval.type = NJS_TYPED_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+/*
+ * A relative index of slice() and subarray() methods.  The value
+ * is already normalized to an integer number.
+ */
+
+static uint32_t
+njs_typed_array_index(const njs_value_t *value, uint32_t length)
+{
+    double  num;
+
+    num = value->data.u.number;
+
+    if (num < 0) {
+        num += length;
+        return (num > 0) ? num : 0;
+    }
+
+    return (num < length) ? num : length;
+}
+
+
+/* ECMAScript 6: ToIndex() of byteOffset and length arguments. */
+
+static njs_ret_t
+njs_array_buffer_offset(njs_vm_t *vm, njs_value_t *value, uint32_t *offset)
+{
+    double  num;
+
+    num = njs_value_to_number(value);
+
+    if (njs_is_nan(num)) {
+        num = 0;
+    }
+
+    if (nxt_slow_path(num < 0 || num > UINT32_MAX)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    *offset = num;
+
+    return NXT_OK;
+}
+
+
+/*
+ * Uint8Array(length),
+ * Uint8Array(typedArray),
+ * Uint8Array(array),
+ * Uint8Array(buffer[, byteOffset[, length]]).
+ * ECMAScript 6.
+ */
+
+njs_ret_t
+njs_typed_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            offset, length, i;
+    njs_ret_t           ret;
+    njs_array_t         *array;
+    njs_value_t         *value;
+    njs_typed_array_t   *view;
+    njs_array_buffer_t  *buffer;
+
+    if (!vm->frame->ctor) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    if (nargs == 1) {
+        return njs_typed_array_copy(vm, NULL, 0);
+    }
+
+    value = &args[1];
+
+    switch (value->type) {
+
+    case NJS_ARRAY_BUFFER:
+        buffer = value->data.u.array_buffer;
+        offset = 0;
+
+        if (nargs > 2) {
+            ret = njs_array_buffer_offset(vm, &args[2], &offset);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
+            if (nxt_slow_path(offset > buffer->size)) {
+                vm->exception = &njs_exception_range_error;
+                return NXT_ERROR;
+            }
+        }
+
+        length = buffer->size - offset;
+
+        if (nargs > 3 && !njs_is_void(&args[3])) {
+            ret = njs_array_buffer_offset(vm, &args[3], &length);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
+            if (nxt_slow_path(length > buffer->size - offset)) {
+                vm->exception = &njs_exception_range_error;
+                return NXT_ERROR;
+            }
+        }
+
+        view = njs_typed_array_alloc(vm, buffer, offset, length,
+                                     NJS_PROTOTYPE_TYPED_ARRAY);
+        if (nxt_slow_path(view == NULL)) {
+            return NXT_ERROR;
+        }
+
+        vm->retval.data.u.typed_array = view;
+        vm->retval.type = NJS_TYPED_ARRAY;
+        vm->retval.data.truth = 1;
+
+        return NXT_OK;
+
+    case NJS_TYPED_ARRAY:
+        view = value->data.u.typed_array;
+
+        return njs_typed_array_copy(vm, view->start, view->length);
+
+    case NJS_ARRAY:
+        array = value->data.u.array;
+
+        ret = njs_typed_array_copy(vm, NULL, array->length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        view = vm->retval.data.u.typed_array;
+
+        for (i = 0; i < array->length; i++) {
+            if (nxt_slow_path(njs_is_object(&array->start[i]))) {
+                vm->exception = &njs_exception_type_error;
+                return NXT_ERROR;
+            }
+
+            view->start[i] = njs_typed_array_byte(&array->start[i]);
+        }
+
+        return NXT_OK;
+
+    default:
+        if (njs_is_object(value)) {
+            /* Array-like objects are not supported. */
+            length = 0;
+
+        } else {
+            ret = njs_array_buffer_offset(vm, value, &length);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+        }
+
+        return njs_typed_array_copy(vm, NULL, length);
+    }
+}
+
+
+static const njs_object_prop_t  njs_typed_array_constructor_properties[] =
+{
+    /* Uint8Array.name == "Uint8Array". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Uint8Array"),
+    },
+
+    /* Uint8Array.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* Uint8Array.prototype. */
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("prototype"),
+        .value = njs_native_getter(njs_object_prototype_create),
+    },
+
+    /* Uint8Array.BYTES_PER_ELEMENT == 1. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 1.0),
+    },
+};
+
+
+const njs_object_init_t  njs_typed_array_constructor_init = {
+    njs_typed_array_constructor_properties,
+    nxt_nitems(njs_typed_array_constructor_properties),
+};
+
+
+/* The getters are shared by Uint8Array and DataView prototypes. */
+
+static njs_ret_t
+njs_typed_array_prototype_length(njs_vm_t *vm, njs_value_t *value)
+{
+    if (njs_is_typed_array(value) || njs_is_data_view(value)) {
+        njs_number_set(&vm->retval, value->data.u.typed_array->length);
+
+    } else {
+        vm->retval = njs_value_void;
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_byte_offset(njs_vm_t *vm, njs_value_t *value)
+{
+    if (njs_is_typed_array(value) || njs_is_data_view(value)) {
+        njs_number_set(&vm->retval, value->data.u.typed_array->offset);
+
+    } else {
+        vm->retval = njs_value_void;
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_buffer(njs_vm_t *vm, njs_value_t *value)
+{
+    if (njs_is_typed_array(value) || njs_is_data_view(value)) {
+        vm->retval.data.u.array_buffer = value->data.u.typed_array->buffer;
+        vm->retval.type = NJS_ARRAY_BUFFER;
+        vm->retval.data.truth = 1;
+
+    } else {
+        vm->retval = njs_value_void;
+    }
+
+    return NXT_OK;
+}
+
+
+/*
+ * Uint8Array.subarray(begin[, end]) returns a view of the same buffer.
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_subarray(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t           start, end;
+    njs_typed_array_t  *array, *view;
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    start = (nargs > 1) ? njs_typed_array_index(&args[1], array->length) : 0;
+    end = (nargs > 2) ? njs_typed_array_index(&args[2], array->length)
+                      : array->length;
+
+    if (end < start) {
+        end = start;
+    }
+
+    view = njs_typed_array_alloc(vm, array->buffer, array->offset + start,
+                                 end - start, NJS_PROTOTYPE_TYPED_ARRAY);
+    if (nxt_slow_path(view == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.typed_array = view;
+    vm->retval.type = NJS_TYPED_ARRAY;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+/*
+ * Uint8Array.slice(begin[, end]) returns a copy.
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_slice(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t           start, end;
+    njs_typed_array_t  *array;
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    start = (nargs > 1) ? njs_typed_array_index(&args[1], array->length) : 0;
+    end = (nargs > 2) ? njs_typed_array_index(&args[2], array->length)
+                      : array->length;
+
+    if (end < start) {
+        end = start;
+    }
+
+    return njs_typed_array_copy(vm, array->start + start, end - start);
+}
+
+
+/*
+ * Uint8Array.set(array[, offset]).
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_set(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    u_char             *p;
+    double             offset;
+    uint32_t           i, length;
+    njs_array_t        *from;
+    njs_typed_array_t  *array, *source;
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    if (nxt_slow_path(array->buffer->read_only)) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    offset = (nargs > 2) ? args[2].data.u.number : 0;
+
+    if (nxt_slow_path(offset < 0)) {
+        goto range_error;
+    }
+
+    if (nargs > 1) {
+        switch (args[1].type) {
+
+        case NJS_TYPED_ARRAY:
+            source = args[1].data.u.typed_array;
+
+            if (nxt_slow_path(source->length > array->length - offset)) {
+                goto range_error;
+            }
+
+            /* The arrays may share the same buffer. */
+            memmove(array->start + (uint32_t) offset, source->start,
+                    source->length);
+            break;
+
+        case NJS_ARRAY:
+            from = args[1].data.u.array;
+            length = from->length;
+
+            if (nxt_slow_path(length > array->length - offset)) {
+                goto range_error;
+            }
+
+            p = array->start + (uint32_t) offset;
+
+            for (i = 0; i < length; i++) {
+                if (nxt_slow_path(njs_is_object(&from->start[i]))) {
+                    vm->exception = &njs_exception_type_error;
+                    return NXT_ERROR;
+                }
+
+                p[i] = njs_typed_array_byte(&from->start[i]);
+            }
+
+            break;
+
+        default:
+            vm->exception = &njs_exception_type_error;
+            return NXT_ERROR;
+        }
+    }
+
+    vm->retval = njs_value_void;
+
+    return NXT_OK;
+
+range_error:
+
+    vm->exception = &njs_exception_range_error;
+
+    return NXT_ERROR;
+}
+
+
+/*
+ * Uint8Array.fill(value[, begin[, end]]).
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_fill(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint8_t            byte;
+    uint32_t           start, end;
+    njs_typed_array_t  *array;
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    if (nxt_slow_path(array->buffer->read_only)) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    byte = (nargs > 1) ? njs_typed_array_byte(&args[1]) : 0;
+
+    start = (nargs > 2) ? njs_typed_array_index(&args[2], array->length) : 0;
+    end = (nargs > 3) ? njs_typed_array_index(&args[3], array->length)
+                      : array->length;
+
+    if (start < end) {
+        memset(array->start + start, byte, end - start);
+    }
+
+    vm->retval = args[0];
+
+    return NXT_OK;
+}
+
+
+/*
+ * Uint8Array.indexOf(value[, fromIndex]).
+ * ECMAScript 7.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_index_of(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    u_char             *p;
+    double             num;
+    uint32_t           start;
+    njs_typed_array_t  *array;
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    num = (nargs > 1) ? args[1].data.u.number : NJS_NAN;
+    start = (nargs > 2) ? njs_typed_array_index(&args[2], array->length) : 0;
+
+    p = NULL;
+
+    if (num >= 0 && num <= 255 && num == (uint8_t) num
+        && start < array->length)
+    {
+        p = memchr(array->start + start, (uint8_t) num,
+                   array->length - start);
+    }
+
+    njs_number_set(&vm->retval, (p != NULL) ? p - array->start : -1);
+
+    return NXT_OK;
+}
+
+
+/*
+ * Uint8Array.join([separator]).
+ * ECMAScript 6.
+ */
+
+static njs_ret_t
+njs_typed_array_prototype_join(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    u_char             *p, *end;
+    size_t             size, length;
+    uint32_t           i, n;
+    njs_typed_array_t  *array;
+    njs_string_prop_t  separator;
+
+    static const njs_value_t  comma = njs_string(",");
+
+    if (nxt_slow_path(!njs_is_typed_array(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    array = args[0].data.u.typed_array;
+
+    if (array->length == 0) {
+        vm->retval = njs_string_empty;
+        return NXT_OK;
+    }
+
+    if (nargs > 1 && !njs_is_void(&args[1])) {
+        (void) njs_string_prop(&separator, &args[1]);
+
+    } else {
+        (void) njs_string_prop(&separator, (njs_value_t *) &comma);
+    }
+
+    size = separator.size * (array->length - 1);
+
+    for (i = 0; i < array->length; i++) {
+        n = array->start[i];
+        size += (n < 10) ? 1 : (n < 100) ? 2 : 3;
+    }
+
+    /* A byte string separator makes the result a byte string. */
+    length = (separator.size != 0 && separator.length == 0)
+             ? 0 : size - (separator.size - separator.length)
+                          * (array->length - 1);
+
+    p = njs_string_alloc(vm, &vm->retval, size, length);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    for (i = 0; i < array->length; i++) {
+        if (i != 0) {
+            memcpy(p, separator.start, separator.size);
+            p += separator.size;
+        }
+
+        n = array->start[i];
+        end = p + ((n < 10) ? 1 : (n < 100) ? 2 : 3);
+        p = end;
+
+        do {
+            *(--p) = '0' + n % 10;
+            n /= 10;
+        } while (n != 0);
+
+        p = end;
+    }
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_typed_array_prototype_to_string(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_typed_array_prototype_join(vm, args, 1, unused);
+}
+
+
+static const njs_object_prop_t  njs_typed_array_prototype_properties[] =
+{
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("length"),
+        .value = njs_native_getter(njs_typed_array_prototype_length),
+    },
+
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("byteLength"),
+        .value = njs_native_getter(njs_typed_array_prototype_length),
+    },
+
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("byteOffset"),
+        .value = njs_native_getter(njs_typed_array_prototype_byte_offset),
+    },
+
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("buffer"),
+        .value = njs_native_getter(njs_typed_array_prototype_buffer),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_long_string("BYTES_PER_ELEMENT"),
+        .value = njs_value(NJS_NUMBER, 1, 1.0),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("subarray"),
+        .value = njs_native_function(njs_typed_array_prototype_subarray, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("slice"),
+        .value = njs_native_function(njs_typed_array_prototype_slice, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("set"),
+        .value = njs_native_function(njs_typed_array_prototype_set, 0,
+                     NJS_SKIP_ARG, NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("fill"),
+        .value = njs_native_function(njs_typed_array_prototype_fill, 0,
+                     NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_INTEGER_ARG,
+                     NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("indexOf"),
+        .value = njs_native_function(njs_typed_array_prototype_index_of, 0,
+                     NJS_SKIP_ARG, NJS_NUMBER_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("join"),
+        .value = njs_native_function(njs_typed_array_prototype_join, 0,
+                     NJS_SKIP_ARG, NJS_STRING_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("toString"),
+        .value = njs_native_function(njs_typed_array_prototype_to_string, 0,
+                                     0),
+    },
+};
+
+
+const njs_object_init_t  njs_typed_array_prototype_init = {
+    njs_typed_array_prototype_properties,
+    nxt_nitems(njs_typed_array_prototype_properties),
+};
+
+
+/*
+ * DataView(buffer[, byteOffset[, byteLength]]).
+ * ECMAScript 6.
+ */
+
+njs_ret_t
+njs_data_view_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    uint32_t            offset, length;
+    njs_ret_t           ret;
+    njs_typed_array_t   *view;
+    njs_array_buffer_t  *buffer;
+
+    if (nxt_slow_path(!vm->frame->ctor
+                      || nargs < 2
+                      || !njs_is_array_buffer(&args[1])))
+    {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    buffer = args[1].data.u.array_buffer;
+    offset = 0;
+
+    if (nargs > 2) {
+        ret = njs_array_buffer_offset(vm, &args[2], &offset);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        if (nxt_slow_path(offset > buffer->size)) {
+            vm->exception = &njs_exception_range_error;
+            return NXT_ERROR;
+        }
+    }
+
+    length = buffer->size - offset;
+
+    if (nargs > 3 && !njs_is_void(&args[3])) {
+        ret = njs_array_buffer_offset(vm, &args[3], &length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        if (nxt_slow_path(length > buffer->size - offset)) {
+            vm->exception = &njs_exception_range_error;
+            return NXT_ERROR;
+        }
+    }
+
+    view = njs_typed_array_alloc(vm, buffer, offset, length,
+                                 NJS_PROTOTYPE_DATA_VIEW);
+    if (nxt_slow_path(view == NULL)) {
+        return NXT_ERROR;
+    }
+
+    vm->retval.data.u.typed_array = view;
+    vm->retval.type = NJS_DATA_VIEW;
+    vm->retval.data.truth = 1;
+
+    return NXT_OK;
+}
+
+
+static const njs_object_prop_t  njs_data_view_constructor_properties[] =
+{
+    /* DataView.name == "DataView". */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("DataView"),
+    },
+
+    /* DataView.length == 3. */
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 1, 3.0),
+    },
+
+    /* DataView.prototype. */
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("prototype"),
+        .value = njs_native_getter(njs_object_prototype_create),
+    },
+};
+
+
+const njs_object_init_t  njs_data_view_constructor_init = {
+    njs_data_view_constructor_properties,
+    nxt_nitems(njs_data_view_constructor_properties),
+};
+
+
+/*
+ * The DataView values are assembled byte by byte in the requested
+ * byte order, so the host byte order and alignment do not matter.
+ */
+
+static njs_ret_t
+njs_data_view_get(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_data_view_type_t type)
+{
+    u_char             *p;
+    double             num, offset;
+    uint64_t           v;
+    nxt_uint_t         i, size;
+    njs_typed_array_t  *view;
+
+    union {
+        uint32_t       u;
+        float          f;
+    } conv32;
+
+    union {
+        uint64_t       u;
+        double         f;
+    } conv64;
+
+    if (nxt_slow_path(!njs_is_data_view(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    view = args[0].data.u.typed_array;
+    size = njs_data_view_size[type];
+    offset = (nargs > 1) ? args[1].data.u.number : 0;
+
+    if (nxt_slow_path(offset < 0 || offset + size > view->length)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    p = view->start + (uint32_t) offset;
+    v = 0;
+
+    if (nargs > 2 && args[2].data.truth) {
+        /* Little endian. */
+        for (i = size; i != 0; i--) {
+            v = (v << 8) | p[i - 1];
+        }
+
+    } else {
+        for (i = 0; i < size; i++) {
+            v = (v << 8) | p[i];
+        }
+    }
+
+    switch (type) {
+
+    case NJS_DATA_VIEW_INT8:
+        num = (int8_t) v;
+        break;
+
+    case NJS_DATA_VIEW_INT16:
+        num = (int16_t) v;
+        break;
+
+    case NJS_DATA_VIEW_INT32:
+        num = (int32_t) v;
+        break;
+
+    case NJS_DATA_VIEW_FLOAT32:
+        conv32.u = (uint32_t) v;
+        num = conv32.f;
+        break;
+
+    case NJS_DATA_VIEW_FLOAT64:
+        conv64.u = v;
+        num = conv64.f;
+        break;
+
+    default:
+        /* Unsigned integers. */
+        num = v;
+        break;
+    }
+
+    njs_number_set(&vm->retval, num);
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_data_view_set(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_data_view_type_t type)
+{
+    u_char             *p;
+    double             num, offset;
+    uint64_t           v;
+    nxt_uint_t         i, size;
+    njs_typed_array_t  *view;
+
+    union {
+        uint32_t       u;
+        float          f;
+    } conv32;
+
+    union {
+        uint64_t       u;
+        double         f;
+    } conv64;
+
+    if (nxt_slow_path(!njs_is_data_view(&args[0]))) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    view = args[0].data.u.typed_array;
+
+    if (nxt_slow_path(view->buffer->read_only)) {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    size = njs_data_view_size[type];
+    offset = (nargs > 1) ? args[1].data.u.number : 0;
+
+    if (nxt_slow_path(offset < 0 || offset + size > view->length)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    num = (nargs > 2) ? args[2].data.u.number : NJS_NAN;
+
+    switch (type) {
+
+    case NJS_DATA_VIEW_FLOAT32:
+        conv32.f = num;
+        v = conv32.u;
+        break;
+
+    case NJS_DATA_VIEW_FLOAT64:
+        conv64.f = num;
+        v = conv64.u;
+        break;
+
+    default:
+        /* ECMAScript 6: ToInt8(), ToUint16(), ToInt32() and others. */
+        v = njs_integer_value(num);
+        break;
+    }
+
+    p = view->start + (uint32_t) offset;
+
+    if (nargs > 3 && args[3].data.truth) {
+        /* Little endian. */
+        for (i = 0; i < size; i++) {
+            p[i] = (u_char) (v >> (i * 8));
+        }
+
+    } else {
+        for (i = 0; i < size; i++) {
+            p[size - 1 - i] = (u_char) (v >> (i * 8));
+        }
+    }
+
+    vm->retval = njs_value_void;
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_int32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_INT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_uint32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_UINT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_float32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_FLOAT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_get_float64(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_get(vm, args, nargs, NJS_DATA_VIEW_FLOAT64);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint8(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT8);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint16(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT16);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_int32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_INT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_uint32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_UINT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_float32(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_FLOAT32);
+}
+
+
+static njs_ret_t
+njs_data_view_prototype_set_float64(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused)
+{
+    return njs_data_view_set(vm, args, nargs, NJS_DATA_VIEW_FLOAT64);
+}
+
+
+static const njs_object_prop_t  njs_data_view_prototype_properties[] =
+{
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("byteLength"),
+        .value = njs_native_getter(njs_typed_array_prototype_length),
+    },
+
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("byteOffset"),
+        .value = njs_native_getter(njs_typed_array_prototype_byte_offset),
+    },
+
+    {
+        .type = NJS_NATIVE_GETTER,
+        .name = njs_string("buffer"),
+        .value = njs_native_getter(njs_typed_array_prototype_buffer),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt8"),
+        .value = njs_native_function(njs_data_view_prototype_get_int8, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint8"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint8, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt16"),
+        .value = njs_native_function(njs_data_view_prototype_get_int16, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint16"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint16, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getInt32"),
+        .value = njs_native_function(njs_data_view_prototype_get_int32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getUint32"),
+        .value = njs_native_function(njs_data_view_prototype_get_uint32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getFloat32"),
+        .value = njs_native_function(njs_data_view_prototype_get_float32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("getFloat64"),
+        .value = njs_native_function(njs_data_view_prototype_get_float64, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt8"),
+        .value = njs_native_function(njs_data_view_prototype_set_int8, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint8"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint8, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt16"),
+        .value = njs_native_function(njs_data_view_prototype_set_int16, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint16"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint16, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setInt32"),
+        .value = njs_native_function(njs_data_view_prototype_set_int32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setUint32"),
+        .value = njs_native_function(njs_data_view_prototype_set_uint32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setFloat32"),
+        .value = njs_native_function(njs_data_view_prototype_set_float32, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("setFloat64"),
+        .value = njs_native_function(njs_data_view_prototype_set_float64, 0,
+                     NJS_SKIP_ARG, NJS_INTEGER_ARG, NJS_NUMBER_ARG),
+    },
+};
+
+
+const njs_object_init_t  njs_data_view_prototype_init = {
+    njs_data_view_prototype_properties,
+    nxt_nitems(njs_data_view_prototype_properties),
+};
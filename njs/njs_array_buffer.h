@@ -0,0 +1,68 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_ARRAY_BUFFER_H_INCLUDED_
+#define _NJS_ARRAY_BUFFER_H_INCLUDED_
+
+
+/*
+ * The ArrayBuffer bytes are either allocated from the VM memory cache pool
+ * or are external memory, e.g. an nginx buffer, which must outlive the VM.
+ * The external memory is read-only: the writes through Uint8Array and
+ * DataView throw TypeError.
+ */
+
+struct njs_array_buffer_s {
+    njs_object_t        object;
+    uint32_t            size;
+    uint8_t             read_only;  /* 1 bit */
+    u_char              *start;
+};
+
+
+/*
+ * The typed array is Uint8Array, so its length is the byte length.
+ * The DataView uses the same structure.  The "start" field is the
+ * buffer start plus the offset cached for index access.
+ */
+
+struct njs_typed_array_s {
+    njs_object_t        object;
+    uint32_t            offset;
+    uint32_t            length;
+    u_char              *start;
+    njs_array_buffer_t  *buffer;
+};
+
+
+/*
+ * ECMAScript 6: ToUint8() of a primitive value.  Objects are not converted
+ * by their valueOf() and toString() methods, so they are rejected with
+ * TypeError by the callers.
+ */
+#define njs_typed_array_byte(val)                                             \
+    (njs_is_int32(val) ? (uint8_t) (val)->integer.value                       \
+                       : (uint8_t) njs_integer_value(njs_value_to_number(val)))
+
+
+njs_array_buffer_t *njs_array_buffer_alloc(njs_vm_t *vm, uint32_t size);
+njs_ret_t njs_array_buffer_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_typed_array_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+njs_ret_t njs_data_view_constructor(njs_vm_t *vm, njs_value_t *args,
+    nxt_uint_t nargs, njs_index_t unused);
+
+
+extern const njs_object_init_t  njs_array_buffer_constructor_init;
+extern const njs_object_init_t  njs_array_buffer_prototype_init;
+extern const njs_object_init_t  njs_typed_array_constructor_init;
+extern const njs_object_init_t  njs_typed_array_prototype_init;
+extern const njs_object_init_t  njs_data_view_constructor_init;
+extern const njs_object_init_t  njs_data_view_prototype_init;
+
+
+#endif /* _NJS_ARRAY_BUFFER_H_INCLUDED_ */
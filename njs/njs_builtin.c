@@ -24,7 +24,9 @@
 #include <njs_parser.h>
 #include <njs_regexp.h>
 #include <njs_date.h>
+#include <njs_array_buffer.h>
 #include <njs_math.h>
+#include <njs_json.h>
 #include <string.h>
 
 
@@ -51,6 +53,9 @@ njs_builtin_objects_create(njs_vm_t *vm)
         &njs_function_prototype_init,
         &njs_regexp_prototype_init,
         &njs_date_prototype_init,
+        &njs_array_buffer_prototype_init,
+        &njs_typed_array_prototype_init,
+        &njs_data_view_prototype_init,
     };
 
     static const njs_object_init_t    *constructor_init[] = {
@@ -62,6 +67,9 @@ njs_builtin_objects_create(njs_vm_t *vm)
         &njs_function_constructor_init,
         &njs_regexp_constructor_init,
         &njs_date_constructor_init,
+        &njs_array_buffer_constructor_init,
+        &njs_typed_array_constructor_init,
+        &njs_data_view_constructor_init,
     };
 
     static const njs_function_init_t  native_constructors[] = {
@@ -75,10 +83,15 @@ njs_builtin_objects_create(njs_vm_t *vm)
         { njs_regexp_constructor,
           { NJS_SKIP_ARG, NJS_STRING_ARG, NJS_STRING_ARG } },
         { njs_date_constructor,     { 0 } },
+        { njs_array_buffer_constructor,
+          { NJS_SKIP_ARG, NJS_INTEGER_ARG } },
+        { njs_typed_array_constructor, { 0 } },
+        { njs_data_view_constructor, { 0 } },
     };
 
     static const njs_object_init_t    *object_init[] = {
         &njs_math_object_init,
+        &njs_json_object_init,
     };
 
     static const njs_object_init_t    *function_init[] = {
@@ -239,6 +252,18 @@ njs_builtin_objects_create(njs_vm_t *vm)
  * Date.__proto__               -> Function_Prototype,
  * Date_Prototype.__proto__     -> Object_Prototype,
  *
+ * ArrayBuffer(),
+ * ArrayBuffer.__proto__            -> Function_Prototype,
+ * ArrayBuffer_Prototype.__proto__  -> Object_Prototype,
+ *
+ * Uint8Array(),
+ * Uint8Array.__proto__             -> Function_Prototype,
+ * Uint8Array_Prototype.__proto__   -> Object_Prototype,
+ *
+ * DataView(),
+ * DataView.__proto__               -> Function_Prototype,
+ * DataView_Prototype.__proto__     -> Object_Prototype,
+ *
  * eval(),
  * eval.__proto__               -> Function_Prototype.
  */
@@ -265,7 +290,7 @@ njs_builtin_objects_clone(njs_vm_t *vm)
     }
 
     function_prototype = &vm->prototypes[NJS_CONSTRUCTOR_FUNCTION];
-    values = vm->scopes[NJS_SCOPE_GLOBAL];
+    values = vm->scopes[NJS_SCOPE_BUILTIN];
 
     for (i = NJS_CONSTRUCTOR_OBJECT; i < NJS_CONSTRUCTOR_MAX; i++) {
         values[i].type = NJS_FUNCTION;
@@ -37,7 +37,6 @@
  *   FreeBSD and MacOSX timegm() cannot handle years before 1900.
  */
 
-#define NJS_ISO_DATE_TIME_LEN  sizeof("+001970-09-28T12:00:00.000Z")
 
 #define NJS_DATE_TIME_LEN                                                     \
     sizeof("Mon Sep 28 1970 12:00:00 GMT+0600 (XXXXX)")
@@ -151,6 +150,7 @@ njs_date_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 
         nxt_lvlhsh_init(&date->object.hash);
         nxt_lvlhsh_init(&date->object.shared_hash);
+        date->object.shape = NULL;
         date->object.shared = 0;
         date->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_DATE];
 
@@ -1004,28 +1004,14 @@ static njs_ret_t
 njs_date_prototype_to_iso_string(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    int32_t    year;
-    double     time;
-    size_t     size;
-    time_t     clock;
-    u_char     buf[NJS_ISO_DATE_TIME_LEN];
-    struct tm  tm;
+    double  time;
+    size_t  size;
+    u_char  buf[NJS_ISO_DATE_TIME_LEN];
 
     time = args[0].data.u.date->time;
 
     if (!njs_is_nan(time)) {
-        clock = time / 1000;
-
-        gmtime_r(&clock, &tm);
-
-        year = tm.tm_year + 1900;
-
-        size = snprintf((char *) buf, NJS_ISO_DATE_TIME_LEN,
-                        (year < 0) ? "%07d-%02d-%02dT%02d:%02d:%02d.%03dZ":
-                                     "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
-                        year, tm.tm_mon + 1, tm.tm_mday,
-                        tm.tm_hour, tm.tm_min, tm.tm_sec,
-                        (int) ((int64_t) time % 1000));
+        size = njs_date_iso_string(buf, time);
 
         return njs_string_new(vm, &vm->retval, buf, size, size);
     }
@@ -1036,6 +1022,30 @@ njs_date_prototype_to_iso_string(njs_vm_t *vm, njs_value_t *args,
 }
 
 
+/* The buffer size should be at least NJS_ISO_DATE_TIME_LEN. */
+
+size_t
+njs_date_iso_string(u_char *buf, double time)
+{
+    int32_t    year;
+    time_t     clock;
+    struct tm  tm;
+
+    clock = time / 1000;
+
+    gmtime_r(&clock, &tm);
+
+    year = tm.tm_year + 1900;
+
+    return snprintf((char *) buf, NJS_ISO_DATE_TIME_LEN,
+                    (year < 0) ? "%07d-%02d-%02dT%02d:%02d:%02d.%03dZ":
+                                 "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                    year, tm.tm_mon + 1, tm.tm_mday,
+                    tm.tm_hour, tm.tm_min, tm.tm_sec,
+                    (int) ((int64_t) time % 1000));
+}
+
+
 static njs_ret_t
 njs_date_prototype_get_full_year(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
@@ -8,6 +8,9 @@
 #define _NJS_DATE_H_INCLUDED_
 
 
+#define NJS_ISO_DATE_TIME_LEN  sizeof("+001970-09-28T12:00:00.000Z")
+
+
 struct njs_date_s {
     njs_object_t  object;
     double        time;
@@ -16,6 +19,7 @@ struct njs_date_s {
 
 njs_ret_t njs_date_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
+size_t njs_date_iso_string(u_char *buf, double time);
 
 
 extern const njs_object_init_t  njs_date_constructor_init;
@@ -45,6 +45,10 @@ static njs_code_name_t  code_names[] = {
           nxt_string("PROPERTY GET    ") },
     { njs_vmcode_property_set, sizeof(njs_vmcode_prop_set_t),
           nxt_string("PROPERTY SET    ") },
+    { njs_vmcode_property_const_get, sizeof(njs_vmcode_prop_const_get_t),
+          nxt_string("PROP CONST GET  ") },
+    { njs_vmcode_property_const_set, sizeof(njs_vmcode_prop_const_set_t),
+          nxt_string("PROP CONST SET  ") },
     { njs_vmcode_property_in, sizeof(njs_vmcode_3addr_t),
           nxt_string("PROPERTY IN     ") },
     { njs_vmcode_property_delete, sizeof(njs_vmcode_3addr_t),
@@ -141,6 +145,34 @@ static njs_code_name_t  code_names[] = {
 };
 
 
+static njs_code_name_t  compare_jump_names[] = {
+
+    { njs_vmcode_if_equal_jump, sizeof(njs_vmcode_equal_jump_t),
+          nxt_string("JUMP IF EQUAL     ") },
+    { njs_vmcode_if_not_equal_jump, sizeof(njs_vmcode_equal_jump_t),
+          nxt_string("JUMP IF NOT EQUAL ") },
+    { njs_vmcode_if_less_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF LT        ") },
+    { njs_vmcode_if_not_less_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF NOT LT    ") },
+    { njs_vmcode_if_less_or_equal_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF LE        ") },
+    { njs_vmcode_if_not_less_or_equal_jump,
+          sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF NOT LE    ") },
+    { njs_vmcode_if_greater_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF GT        ") },
+    { njs_vmcode_if_not_greater_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF NOT GT    ") },
+    { njs_vmcode_if_greater_or_equal_jump, sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF GE        ") },
+    { njs_vmcode_if_not_greater_or_equal_jump,
+          sizeof(njs_vmcode_compare_jump_t),
+          nxt_string("JUMP IF NOT GE    ") },
+
+};
+
+
 void
 njs_disassembler(njs_vm_t *vm)
 {
@@ -151,6 +183,9 @@ njs_disassembler(njs_vm_t *vm)
     n = vm->code->items;
 
     while(n != 0) {
+        printf("SCOPE SIZE        %u variables, %u temporaries\n",
+               code->variables, code->temporaries);
+
         njs_disassemble(code->start, code->end);
         code++;
         n--;
@@ -178,7 +213,8 @@ njs_disassemble(u_char *start, u_char *end)
     njs_vmcode_cond_jump_t       *cond_jump;
     njs_vmcode_test_jump_t       *test_jump;
     njs_vmcode_prop_next_t       *prop_next;
-    njs_vmcode_equal_jump_t      *equal;
+    njs_vmcode_prop_get_t        *prop;
+    njs_vmcode_compare_jump_t    *compare;
     njs_vmcode_prop_foreach_t    *prop_foreach;
     njs_vmcode_method_frame_t    *method;
     njs_vmcode_function_frame_t  *function;
@@ -236,16 +272,28 @@ njs_disassemble(u_char *start, u_char *end)
             continue;
         }
 
-        if (operation == njs_vmcode_if_equal_jump) {
-            equal = (njs_vmcode_equal_jump_t *) p;
-            p += sizeof(njs_vmcode_equal_jump_t);
+        code_name = compare_jump_names;
+        n = nxt_nitems(compare_jump_names);
 
-            printf("JUMP IF EQUAL     %04zX %04zX +%zd\n",
-                   (size_t) equal->value1, (size_t) equal->value2,
-                   (size_t) equal->offset);
+        do {
+            if (operation == code_name->operation) {
+                name = &code_name->name;
+                compare = (njs_vmcode_compare_jump_t *) p;
+                p += code_name->size;
+                sign = (compare->offset >= 0) ? "+" : "";
 
-            continue;
-        }
+                printf("%*s%04zX %04zX %s%zd\n",
+                       (int) name->length, name->start,
+                       (size_t) compare->value1, (size_t) compare->value2,
+                       sign, (size_t) compare->offset);
+
+                goto next;
+            }
+
+            code_name++;
+            n--;
+
+        } while (n != 0);
 
         if (operation == njs_vmcode_test_if_true) {
             test_jump = (njs_vmcode_test_jump_t *) p;
@@ -357,6 +405,18 @@ njs_disassemble(u_char *start, u_char *end)
                             (size_t) code3->dst, (size_t) code3->src1,
                             (size_t) code3->src2);
 
+                 } else if (code_name->size == sizeof(njs_vmcode_prop_get_t)
+                            || code_name->size
+                               == sizeof(njs_vmcode_prop_const_get_t))
+                 {
+                     /* The property set instructions have the same layout. */
+                     prop = (njs_vmcode_prop_get_t *) p;
+
+                     printf("%*s  %04zX %04zX %04zX\n",
+                            (int) name->length, name->start,
+                            (size_t) prop->value, (size_t) prop->object,
+                            (size_t) prop->property);
+
                  } else if (code_name->size == sizeof(njs_vmcode_2addr_t)) {
                      code2 = (njs_vmcode_2addr_t *) p;
 
@@ -139,6 +139,14 @@ njs_function_frame(njs_vm_t *vm, njs_function_t *function, njs_value_t *this,
     njs_frame_t         *frame;
     njs_native_frame_t  *native_frame;
 
+    if (nxt_slow_path(function->u.lambda->global_write
+                      && njs_global_scope_is_shared(vm)))
+    {
+        if (njs_global_scope_copy(vm) != NXT_OK) {
+            return NXT_ERROR;
+        }
+    }
+
     max_args = nxt_max(nargs, function->u.lambda->nargs);
 
     size = NJS_FRAME_SIZE
@@ -196,6 +204,64 @@ njs_function_frame(njs_vm_t *vm, njs_function_t *function, njs_value_t *this,
 }
 
 
+/*
+ * njs_function_frame_reuse() prepares again a lambda frame created by
+ * njs_function_frame() in the spare space of the current frame and left
+ * there after the lambda return.  The frame must be reused with the same
+ * number of arguments, "this" or bound values are not changed.
+ */
+
+nxt_noinline void
+njs_function_frame_reuse(njs_vm_t *vm, njs_native_frame_t *native_frame,
+    njs_value_t *args, nxt_uint_t nargs)
+{
+    u_char          *free;
+    uint32_t        free_size;
+    nxt_uint_t      max_args;
+    njs_value_t     *value;
+    njs_frame_t     *frame;
+    njs_function_t  *function;
+
+    function = native_frame->function;
+    free = native_frame->free;
+    free_size = native_frame->free_size;
+
+    memset(native_frame, 0, sizeof(njs_native_frame_t));
+
+    native_frame->free = free;
+    native_frame->free_size = free_size;
+    native_frame->function = function;
+    native_frame->nargs = nargs;
+
+    native_frame->previous = vm->frame;
+    vm->frame = native_frame;
+
+    value = (njs_value_t *) ((u_char *) native_frame + NJS_FRAME_SIZE)
+            + function->args_offset;
+
+    native_frame->arguments = value;
+    vm->scopes[NJS_SCOPE_CALLEE_ARGUMENTS] = value;
+
+    max_args = nxt_max(nargs, function->u.lambda->nargs);
+
+    while (nargs != 0) {
+        *value++ = *args++;
+        max_args--;
+        nargs--;
+    }
+
+    while (max_args != 0) {
+        *value++ = njs_value_void;
+        max_args--;
+    }
+
+    frame = (njs_frame_t *) native_frame;
+
+    memcpy(frame->local, function->u.lambda->local_scope,
+           function->u.lambda->local_size);
+}
+
+
 nxt_noinline njs_native_frame_t *
 njs_function_frame_alloc(njs_vm_t *vm, size_t size)
 {
@@ -18,9 +18,21 @@
 #define NJS_DATE_ARG               8
 
 
+/*
+ * Lambdas "function(a, b) { return a - b }" and "function(a, b)
+ * { return b - a }" are recognized by generator to sort numbers natively.
+ */
+#define NJS_LAMBDA_COMPARE_ASCENDING   1
+#define NJS_LAMBDA_COMPARE_DESCENDING  2
+
+
 struct njs_function_lambda_s {
     uint32_t                       nargs;
     uint32_t                       local_size;
+    uint32_t                       compare;  /* 2 bits */
+
+    /* The lambda may change global variables. */
+    uint32_t                       global_write;  /* 1 bit */
 
     /* Initial values of local scope. */
     njs_value_t                    *local_scope;
@@ -135,6 +147,8 @@ njs_ret_t njs_function_native_frame(njs_vm_t *vm, njs_function_t *function,
     size_t reserve, nxt_bool_t ctor);
 njs_ret_t njs_function_frame(njs_vm_t *vm, njs_function_t *function,
     njs_value_t *this, njs_value_t *args, nxt_uint_t nargs, nxt_bool_t ctor);
+void njs_function_frame_reuse(njs_vm_t *vm, njs_native_frame_t *native_frame,
+    njs_value_t *args, nxt_uint_t nargs);
 njs_ret_t njs_function_call(njs_vm_t *vm, njs_index_t retval, size_t advance);
 
 extern const njs_object_init_t  njs_function_constructor_init;
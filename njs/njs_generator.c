@@ -6,10 +6,12 @@
 
 #include <nxt_types.h>
 #include <nxt_clang.h>
+#include <nxt_alignment.h>
 #include <nxt_string.h>
 #include <nxt_stub.h>
 #include <nxt_array.h>
 #include <nxt_lvlhsh.h>
+#include <nxt_djb_hash.h>
 #include <nxt_random.h>
 #include <nxt_mem_cache_pool.h>
 #include <njscript.h>
@@ -31,6 +33,8 @@ static nxt_int_t njs_generate_builtin_object(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_variable(njs_parser_t *parser,
     njs_parser_node_t *node);
+static nxt_int_t njs_generate_cond_jump(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *cond, nxt_bool_t if_true, njs_vmcode_jump_t **jump);
 static nxt_int_t njs_generate_if_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_cond_expression(njs_vm_t *vm,
@@ -69,6 +73,8 @@ static nxt_int_t njs_generate_operation_assignment(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_object(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
+static nxt_int_t njs_generate_object_shape(njs_vm_t *vm,
+    njs_parser_node_t *node, njs_object_shape_t **shape);
 static nxt_int_t njs_generate_array(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_function(njs_vm_t *vm, njs_parser_t *parser,
@@ -79,6 +85,14 @@ static nxt_int_t njs_generate_delete(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_int_t njs_generate_test_jump_expression(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
+static nxt_int_t njs_generate_property_get(njs_vm_t *vm,
+    njs_parser_t *parser, njs_parser_node_t *node);
+static void njs_generate_property_get_code(njs_parser_t *parser,
+    njs_index_t value, njs_index_t object, njs_parser_node_t *property);
+static void njs_generate_property_set_code(njs_parser_t *parser,
+    njs_index_t value, njs_index_t object, njs_parser_node_t *property);
+static nxt_bool_t njs_generate_property_hash(njs_parser_node_t *property,
+    njs_property_hash_t *key);
 static nxt_int_t njs_generate_3addr_operation(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_2addr_operation(njs_vm_t *vm,
@@ -89,6 +103,7 @@ static nxt_int_t njs_generate_function_declaration(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_function_scope(njs_vm_t *vm,
     njs_function_lambda_t *lambda, njs_parser_node_t *node);
+static nxt_uint_t njs_generate_lambda_compare(njs_parser_t *parser);
 static nxt_int_t njs_generate_return_statement(njs_vm_t *vm,
     njs_parser_t *parser, njs_parser_node_t *node);
 static nxt_int_t njs_generate_function_call(njs_vm_t *vm, njs_parser_t *parser,
@@ -106,10 +121,14 @@ static nxt_noinline njs_index_t njs_generator_dest_index(njs_vm_t *vm,
 static nxt_noinline njs_index_t
     njs_generator_object_dest_index(njs_parser_t *parser,
     njs_parser_node_t *node);
+static nxt_bool_t njs_generator_object_values_simple(njs_parser_node_t *node,
+    njs_index_t index);
 static njs_index_t njs_generator_node_temp_index_get(njs_parser_t *parser,
     njs_parser_node_t *node);
 static nxt_noinline njs_index_t
     njs_generator_temp_index_get(njs_parser_t *parser);
+static njs_index_t njs_generator_temp_index_reserve(njs_parser_t *parser,
+    size_t size);
 static nxt_noinline nxt_int_t
     njs_generator_children_indexes_release(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node);
@@ -118,6 +137,8 @@ static nxt_noinline nxt_int_t njs_generator_node_index_release(njs_vm_t *vm,
 static nxt_noinline nxt_int_t njs_generator_index_release(njs_vm_t *vm,
     njs_parser_t *parser, njs_index_t index);
 nxt_inline nxt_bool_t njs_generator_is_constant(njs_parser_node_t *node);
+nxt_inline void njs_generator_global_write(njs_parser_t *parser,
+    njs_index_t index);
 
 
 static const nxt_str_t  no_label = { 0, NULL };
@@ -223,9 +244,11 @@ njs_generator(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
     case NJS_TOKEN_DIVISION:
     case NJS_TOKEN_REMAINDER:
     case NJS_TOKEN_PROPERTY_DELETE:
-    case NJS_TOKEN_PROPERTY:
         return njs_generate_3addr_operation(vm, parser, node);
 
+    case NJS_TOKEN_PROPERTY:
+        return njs_generate_property_get(vm, parser, node);
+
     case NJS_TOKEN_LOGICAL_AND:
     case NJS_TOKEN_LOGICAL_OR:
         return njs_generate_test_jump_expression(vm, parser, node);
@@ -287,6 +310,9 @@ njs_generator(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
     case NJS_TOKEN_FUNCTION_CONSTRUCTOR:
     case NJS_TOKEN_REGEXP_CONSTRUCTOR:
     case NJS_TOKEN_DATE_CONSTRUCTOR:
+    case NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR:
+    case NJS_TOKEN_TYPED_ARRAY_CONSTRUCTOR:
+    case NJS_TOKEN_DATA_VIEW_CONSTRUCTOR:
     case NJS_TOKEN_EXTERNAL:
         return NXT_OK;
 
@@ -294,6 +320,7 @@ njs_generator(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
         return njs_generate_name(vm, parser, node);
 
     case NJS_TOKEN_MATH:
+    case NJS_TOKEN_JSON:
     case NJS_TOKEN_EVAL:
     case NJS_TOKEN_TO_STRING:
     case NJS_TOKEN_IS_NAN:
@@ -414,6 +441,117 @@ njs_generate_variable(njs_parser_t *parser, njs_parser_node_t *node)
 }
 
 
+/*
+ * A condition which is a relational or strict equality operation is
+ * generated as the operation operands followed by a single compare jump
+ * instead of the operation storing a boolean value to a temporary index
+ * and a conditional jump on that value.  Both kinds of jumps start with
+ * the njs_vmcode_jump_t layout, so a caller sets the offset via the
+ * returned jump.
+ */
+
+static nxt_int_t
+njs_generate_cond_jump(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *cond, nxt_bool_t if_true, njs_vmcode_jump_t **jump)
+{
+    nxt_int_t                  ret;
+    njs_parser_node_t          *left, *right;
+    njs_vmcode_move_t          *move;
+    njs_vmcode_cond_jump_t     *cond_jump;
+    njs_vmcode_operation_t     operation;
+    njs_vmcode_compare_jump_t  *compare;
+
+    switch (cond->token) {
+
+    case NJS_TOKEN_STRICT_EQUAL:
+        operation = if_true ? njs_vmcode_if_equal_jump
+                            : njs_vmcode_if_not_equal_jump;
+        break;
+
+    case NJS_TOKEN_STRICT_NOT_EQUAL:
+        operation = if_true ? njs_vmcode_if_not_equal_jump
+                            : njs_vmcode_if_equal_jump;
+        break;
+
+    case NJS_TOKEN_LESS:
+        operation = if_true ? njs_vmcode_if_less_jump
+                            : njs_vmcode_if_not_less_jump;
+        break;
+
+    case NJS_TOKEN_LESS_OR_EQUAL:
+        operation = if_true ? njs_vmcode_if_less_or_equal_jump
+                            : njs_vmcode_if_not_less_or_equal_jump;
+        break;
+
+    case NJS_TOKEN_GREATER:
+        operation = if_true ? njs_vmcode_if_greater_jump
+                            : njs_vmcode_if_not_greater_jump;
+        break;
+
+    case NJS_TOKEN_GREATER_OR_EQUAL:
+        operation = if_true ? njs_vmcode_if_greater_or_equal_jump
+                            : njs_vmcode_if_not_greater_or_equal_jump;
+        break;
+
+    default:
+        ret = njs_generator(vm, parser, cond);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+
+        njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
+        cond_jump->code.operation = if_true ? njs_vmcode_if_true_jump
+                                            : njs_vmcode_if_false_jump;
+        cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
+        cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
+        cond_jump->cond = cond->index;
+
+        *jump = (njs_vmcode_jump_t *) cond_jump;
+
+        return NXT_OK;
+    }
+
+    left = cond->left;
+
+    ret = njs_generator(vm, parser, left);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    right = cond->right;
+
+    if (left->token == NJS_TOKEN_NAME) {
+
+        if (nxt_slow_path(njs_parser_has_side_effect(right))) {
+            njs_generate_code(parser, njs_vmcode_move_t, move);
+            move->code.operation = njs_vmcode_move;
+            move->code.operands = NJS_VMCODE_2OPERANDS;
+            move->code.retval = NJS_VMCODE_RETVAL;
+            move->src = left->index;
+            move->dst = njs_generator_node_temp_index_get(parser, left);
+        }
+    }
+
+    ret = njs_generator(vm, parser, right);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    njs_generate_code(parser, njs_vmcode_compare_jump_t, compare);
+    compare->code.operation = operation;
+    compare->code.operands = NJS_VMCODE_3OPERANDS;
+    compare->code.retval = NJS_VMCODE_NO_RETVAL;
+    compare->value1 = left->index;
+    compare->value2 = right->index;
+
+    *jump = (njs_vmcode_jump_t *) compare;
+
+    /* The condition itself has no index, so only operands are released. */
+
+    return njs_generator_children_indexes_release(vm, parser, cond);
+}
+
+
 static nxt_int_t
 njs_generate_if_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -422,28 +560,21 @@ njs_generate_if_statement(njs_vm_t *vm, njs_parser_t *parser,
     nxt_int_t               ret;
     njs_ret_t               *label;
     njs_vmcode_jump_t       *jump;
-    njs_vmcode_cond_jump_t  *cond_jump;
 
     /* The condition expression. */
 
-    ret = njs_generator(vm, parser, node->left);
+    ret = njs_generate_cond_jump(vm, parser, node->left, 0, &jump);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
-    cond_jump->code.operation = njs_vmcode_if_false_jump;
-    cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
-    cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
-    cond_jump->cond = node->left->index;
-
     ret = njs_generator_node_index_release(vm, parser, node->left);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
 
-    previous = (u_char *) cond_jump;
-    label = &cond_jump->offset;
+    previous = (u_char *) jump;
+    label = &jump->offset;
 
     if (node->right != NULL && node->right->token == NJS_TOKEN_BRANCHING) {
 
@@ -496,25 +627,18 @@ static nxt_int_t
 njs_generate_cond_expression(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
 {
-    nxt_int_t               ret;
-    njs_parser_node_t       *branch;
-    njs_vmcode_move_t       *move;
-    njs_vmcode_jump_t       *jump;
-    njs_vmcode_cond_jump_t  *cond_jump;
+    nxt_int_t          ret;
+    njs_parser_node_t  *branch;
+    njs_vmcode_move_t  *move;
+    njs_vmcode_jump_t  *jump, *cond_jump;
 
     /* The condition expression. */
 
-    ret = njs_generator(vm, parser, node->left);
+    ret = njs_generate_cond_jump(vm, parser, node->left, 0, &cond_jump);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
-    cond_jump->code.operation = njs_vmcode_if_false_jump;
-    cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
-    cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
-    cond_jump->cond = node->left->index;
-
     node->index = njs_generator_dest_index(vm, parser, node);
     if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
         return node->index;
@@ -718,11 +842,10 @@ static nxt_int_t
 njs_generate_while_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
 {
-    u_char                  *loop;
-    nxt_int_t               ret;
-    njs_parser_node_t       *condition;
-    njs_vmcode_jump_t       *jump;
-    njs_vmcode_cond_jump_t  *cond_jump;
+    u_char             *loop;
+    nxt_int_t          ret;
+    njs_parser_node_t  *condition;
+    njs_vmcode_jump_t  *jump, *cond_jump;
 
     /*
      * Set a jump to the loop condition.  This jump is executed once just on
@@ -757,17 +880,12 @@ njs_generate_while_statement(njs_vm_t *vm, njs_parser_t *parser,
 
     condition = node->right;
 
-    ret = njs_generator(vm, parser, condition);
+    ret = njs_generate_cond_jump(vm, parser, condition, 1, &cond_jump);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
-    cond_jump->code.operation = njs_vmcode_if_true_jump;
-    cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
-    cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
     cond_jump->offset = loop - (u_char *) cond_jump;
-    cond_jump->cond = condition->index;
 
     njs_generate_patch_block_exit(vm, parser);
 
@@ -779,10 +897,10 @@ static nxt_int_t
 njs_generate_do_while_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
 {
-    u_char                  *loop;
-    nxt_int_t               ret;
-    njs_parser_node_t       *condition;
-    njs_vmcode_cond_jump_t  *cond_jump;
+    u_char             *loop;
+    nxt_int_t          ret;
+    njs_parser_node_t  *condition;
+    njs_vmcode_jump_t  *cond_jump;
 
     /* The loop body. */
 
@@ -804,17 +922,12 @@ njs_generate_do_while_statement(njs_vm_t *vm, njs_parser_t *parser,
 
     condition = node->right;
 
-    ret = njs_generator(vm, parser, condition);
+    ret = njs_generate_cond_jump(vm, parser, condition, 1, &cond_jump);
     if (nxt_slow_path(ret != NXT_OK)) {
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
-    cond_jump->code.operation = njs_vmcode_if_true_jump;
-    cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
-    cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
     cond_jump->offset = loop - (u_char *) cond_jump;
-    cond_jump->cond = condition->index;
 
     njs_generate_patch_block_exit(vm, parser);
 
@@ -826,11 +939,10 @@ static nxt_int_t
 njs_generate_for_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
 {
-    u_char                  *loop;
-    nxt_int_t               ret;
-    njs_parser_node_t       *condition, *update;
-    njs_vmcode_jump_t       *jump;
-    njs_vmcode_cond_jump_t  *cond_jump;
+    u_char             *loop;
+    nxt_int_t          ret;
+    njs_parser_node_t  *condition, *update;
+    njs_vmcode_jump_t  *jump, *cond_jump;
 
     ret = njs_generate_start_block(vm, parser, NJS_PARSER_LOOP, &no_label);
     if (nxt_slow_path(ret != NXT_OK)) {
@@ -898,17 +1010,12 @@ njs_generate_for_statement(njs_vm_t *vm, njs_parser_t *parser,
     if (condition != NULL) {
         jump->offset = parser->code_end - (u_char *) jump;
 
-        ret = njs_generator(vm, parser, condition);
+        ret = njs_generate_cond_jump(vm, parser, condition, 1, &cond_jump);
         if (nxt_slow_path(ret != NXT_OK)) {
             return ret;
         }
 
-        njs_generate_code(parser, njs_vmcode_cond_jump_t, cond_jump);
-        cond_jump->code.operation = njs_vmcode_if_true_jump;
-        cond_jump->code.operands = NJS_VMCODE_2OPERANDS;
-        cond_jump->code.retval = NJS_VMCODE_NO_RETVAL;
         cond_jump->offset = loop - (u_char *) cond_jump;
-        cond_jump->cond = condition->index;
 
         njs_generate_patch_block_exit(vm, parser);
 
@@ -955,10 +1062,10 @@ njs_generate_for_in_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_generate_code(parser, njs_vmcode_prop_foreach_t, prop_foreach);
     prop_foreach->code.operation = njs_vmcode_property_foreach;
     prop_foreach->code.operands = NJS_VMCODE_2OPERANDS;
-    prop_foreach->code.retval = NJS_VMCODE_RETVAL;
+    prop_foreach->code.retval = NJS_VMCODE_NO_RETVAL;
     prop_foreach->object = foreach->right->index;
 
-    index = njs_generator_temp_index_get(parser);
+    index = njs_generator_temp_index_reserve(parser, NJS_PROPERTY_NEXT_SIZE);
     prop_foreach->next = index;
 
     /* The loop body. */
@@ -990,6 +1097,8 @@ njs_generate_for_in_statement(njs_vm_t *vm, njs_parser_t *parser,
     prop_next->next = index;
     prop_next->offset = loop - (u_char *) prop_next;
 
+    njs_generator_global_write(parser, foreach->left->index);
+
     njs_generate_patch_block_exit(vm, parser);
 
     /*
@@ -1245,7 +1354,6 @@ njs_generate_assignment(njs_vm_t *vm, njs_parser_t *parser,
     njs_value_t                 *value;
     njs_parser_node_t           *lvalue, *expr, *object, *property;
     njs_vmcode_move_t           *move;
-    njs_vmcode_prop_set_t       *prop_set;
 
     lvalue = node->left;
     expr = node->right;
@@ -1255,6 +1363,8 @@ njs_generate_assignment(njs_vm_t *vm, njs_parser_t *parser,
 
         lvalue->index = lvalue->u.variable->index;
 
+        njs_generator_global_write(parser, lvalue->index);
+
         /* Use a constant value is stored as variable initial value. */
 
         if (njs_generator_is_constant(expr)) {
@@ -1348,13 +1458,8 @@ njs_generate_assignment(njs_vm_t *vm, njs_parser_t *parser,
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_prop_set_t, prop_set);
-    prop_set->code.operation = njs_vmcode_property_set;
-    prop_set->code.operands = NJS_VMCODE_3OPERANDS;
-    prop_set->code.retval = NJS_VMCODE_NO_RETVAL;
-    prop_set->value = expr->index;
-    prop_set->object = object->index;
-    prop_set->property = property->index;
+    njs_generate_property_set_code(parser, expr->index, object->index,
+                                   property);
 
     node->index = expr->index;
     node->temporary = expr->temporary;
@@ -1372,8 +1477,6 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t      *lvalue, *expr, *object, *property;
     njs_vmcode_move_t      *move;
     njs_vmcode_3addr_t     *code;
-    njs_vmcode_prop_get_t  *prop_get;
-    njs_vmcode_prop_set_t  *prop_set;
 
     lvalue = node->left;
 
@@ -1386,6 +1489,8 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
         index = lvalue->index;
         expr = node->right;
 
+        njs_generator_global_write(parser, index);
+
         if (nxt_slow_path(njs_parser_has_side_effect(expr))) {
             /* Preserve variable value if it may be changed by expression. */
 
@@ -1444,13 +1549,9 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
         return ret;
     }
 
-    njs_generate_code(parser, njs_vmcode_prop_get_t, prop_get);
-    prop_get->code.operation = njs_vmcode_property_get;
-    prop_get->code.operands = NJS_VMCODE_3OPERANDS;
-    prop_get->code.retval = NJS_VMCODE_RETVAL;
-    prop_get->value = njs_generator_node_temp_index_get(parser, node);
-    prop_get->object = object->index;
-    prop_get->property = property->index;
+    index = njs_generator_node_temp_index_get(parser, node);
+
+    njs_generate_property_get_code(parser, index, object->index, property);
 
     expr = node->right;
 
@@ -1467,13 +1568,8 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
     code->src1 = node->index;
     code->src2 = expr->index;
 
-    njs_generate_code(parser, njs_vmcode_prop_set_t, prop_set);
-    prop_set->code.operation = njs_vmcode_property_set;
-    prop_set->code.operands = NJS_VMCODE_3OPERANDS;
-    prop_set->code.retval = NJS_VMCODE_NO_RETVAL;
-    prop_set->value = node->index;
-    prop_set->object = object->index;
-    prop_set->property = property->index;
+    njs_generate_property_set_code(parser, node->index, object->index,
+                                   property);
 
     ret = njs_generator_children_indexes_release(vm, parser, lvalue);
     if (nxt_slow_path(ret != NXT_OK)) {
@@ -1487,15 +1583,27 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_parser_t *parser,
 static nxt_int_t
 njs_generate_object(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 {
+    nxt_int_t            ret;
+    njs_object_shape_t   *shape;
     njs_vmcode_object_t  *object;
 
     node->index = njs_generator_object_dest_index(parser, node);
 
+    shape = NULL;
+
+    if (node->left != NULL) {
+        ret = njs_generate_object_shape(vm, node->left, &shape);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
     njs_generate_code(parser, njs_vmcode_object_t, object);
     object->code.operation = njs_vmcode_object;
     object->code.operands = NJS_VMCODE_1OPERAND;
     object->code.retval = NJS_VMCODE_RETVAL;
     object->retval = node->index;
+    object->shape = shape;
 
     if (node->left == NULL) {
         return NXT_OK;
@@ -1507,6 +1615,49 @@ njs_generate_object(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 }
 
 
+/*
+ * The object literal properties are initialized by a chain of statements,
+ * the last property is in the first statement.  The shape is created if
+ * all the property names are strings.
+ */
+
+static nxt_int_t
+njs_generate_object_shape(njs_vm_t *vm, njs_parser_node_t *node,
+    njs_object_shape_t **shape)
+{
+    nxt_uint_t         i, n;
+    njs_value_t        *names[NJS_OBJECT_SHAPE_MAX];
+    njs_parser_node_t  *stmt, *property;
+
+    *shape = NULL;
+
+    n = 0;
+
+    for (stmt = node; stmt != NULL; stmt = stmt->left) {
+        property = stmt->right->left->right;
+
+        if (n == NJS_OBJECT_SHAPE_MAX || property->token != NJS_TOKEN_STRING) {
+            return NXT_OK;
+        }
+
+        n++;
+    }
+
+    i = n;
+
+    for (stmt = node; stmt != NULL; stmt = stmt->left) {
+        names[--i] = &stmt->right->left->right->u.value;
+    }
+
+    *shape = njs_object_shape_create(vm, names, n);
+    if (nxt_slow_path(*shape == NULL)) {
+        return NXT_ERROR;
+    }
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 njs_generate_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 {
@@ -1700,6 +1851,155 @@ njs_generate_test_jump_expression(njs_vm_t *vm, njs_parser_t *parser,
 }
 
 
+static nxt_int_t
+njs_generate_property_get(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node)
+{
+    nxt_int_t              ret;
+    njs_parser_node_t      *object, *property;
+    njs_vmcode_move_t      *move;
+
+    object = node->left;
+
+    ret = njs_generator(vm, parser, object);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    property = node->right;
+
+    if (object->token == NJS_TOKEN_NAME) {
+
+        if (nxt_slow_path(njs_parser_has_side_effect(property))) {
+            njs_generate_code(parser, njs_vmcode_move_t, move);
+            move->code.operation = njs_vmcode_move;
+            move->code.operands = NJS_VMCODE_2OPERANDS;
+            move->code.retval = NJS_VMCODE_RETVAL;
+            move->src = object->index;
+            move->dst = njs_generator_node_temp_index_get(parser, object);
+        }
+    }
+
+    ret = njs_generator(vm, parser, property);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    /*
+     * The temporary index of MOVE destination
+     * will be released here as index of node->left.
+     */
+    node->index = njs_generator_dest_index(vm, parser, node);
+    if (nxt_slow_path(node->index == NJS_INDEX_ERROR)) {
+        return node->index;
+    }
+
+    njs_generate_property_get_code(parser, node->index, object->index,
+                                   property);
+
+    return NXT_OK;
+}
+
+
+static void
+njs_generate_property_get_code(njs_parser_t *parser, njs_index_t value,
+    njs_index_t object, njs_parser_node_t *property)
+{
+    njs_property_hash_t          key;
+    njs_vmcode_prop_get_t        *prop_get;
+    njs_vmcode_prop_const_get_t  *prop_const_get;
+
+    if (njs_generate_property_hash(property, &key)) {
+        njs_generate_code(parser, njs_vmcode_prop_const_get_t, prop_const_get);
+        prop_const_get->code.operation = njs_vmcode_property_const_get;
+        prop_const_get->code.operands = NJS_VMCODE_3OPERANDS;
+        prop_const_get->code.retval = NJS_VMCODE_RETVAL;
+        prop_const_get->value = value;
+        prop_const_get->object = object;
+        prop_const_get->property = property->index;
+        prop_const_get->hash = key;
+        njs_property_cache_init(&prop_const_get->cache);
+
+        return;
+    }
+
+    njs_generate_code(parser, njs_vmcode_prop_get_t, prop_get);
+    prop_get->code.operation = njs_vmcode_property_get;
+    prop_get->code.operands = NJS_VMCODE_3OPERANDS;
+    prop_get->code.retval = NJS_VMCODE_RETVAL;
+    prop_get->value = value;
+    prop_get->object = object;
+    prop_get->property = property->index;
+    njs_property_cache_init(&prop_get->cache);
+}
+
+
+static void
+njs_generate_property_set_code(njs_parser_t *parser, njs_index_t value,
+    njs_index_t object, njs_parser_node_t *property)
+{
+    njs_property_hash_t          key;
+    njs_vmcode_prop_set_t        *prop_set;
+    njs_vmcode_prop_const_set_t  *prop_const_set;
+
+    if (njs_generate_property_hash(property, &key)) {
+        njs_generate_code(parser, njs_vmcode_prop_const_set_t, prop_const_set);
+        prop_const_set->code.operation = njs_vmcode_property_const_set;
+        prop_const_set->code.operands = NJS_VMCODE_3OPERANDS;
+        prop_const_set->code.retval = NJS_VMCODE_NO_RETVAL;
+        prop_const_set->value = value;
+        prop_const_set->object = object;
+        prop_const_set->property = property->index;
+        prop_const_set->hash = key;
+        njs_property_cache_init(&prop_const_set->cache);
+
+        return;
+    }
+
+    njs_generate_code(parser, njs_vmcode_prop_set_t, prop_set);
+    prop_set->code.operation = njs_vmcode_property_set;
+    prop_set->code.operands = NJS_VMCODE_3OPERANDS;
+    prop_set->code.retval = NJS_VMCODE_NO_RETVAL;
+    prop_set->value = value;
+    prop_set->object = object;
+    prop_set->property = property->index;
+    njs_property_cache_init(&prop_set->cache);
+}
+
+
+/*
+ * A string literal property name is hashed once at compile time,
+ * the lowercase hash is used for caseless external properties.
+ */
+
+static nxt_bool_t
+njs_generate_property_hash(njs_parser_node_t *property,
+    njs_property_hash_t *key)
+{
+    size_t       size;
+    const u_char *start;
+
+    if (property->token != NJS_TOKEN_STRING) {
+        return 0;
+    }
+
+    size = property->u.value.short_string.size;
+
+    if (size != NJS_STRING_LONG) {
+        start = property->u.value.short_string.start;
+
+    } else {
+        size = property->u.value.data.string_size;
+        start = property->u.value.data.u.string->start;
+    }
+
+    key->hash = nxt_djb_hash(start, size);
+    key->lowcase_hash = nxt_djb_hash_lowcase(start, size);
+
+    return 1;
+}
+
+
 static nxt_int_t
 njs_generate_3addr_operation(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -1799,8 +2099,6 @@ njs_generate_inc_dec_operation(njs_vm_t *vm, njs_parser_t *parser,
     njs_index_t            index, dest_index;
     njs_parser_node_t      *lvalue;
     njs_vmcode_3addr_t     *code;
-    njs_vmcode_prop_get_t  *prop_get;
-    njs_vmcode_prop_set_t  *prop_set;
 
     lvalue = node->left;
 
@@ -1811,6 +2109,8 @@ njs_generate_inc_dec_operation(njs_vm_t *vm, njs_parser_t *parser,
             return ret;
         }
 
+        njs_generator_global_write(parser, lvalue->index);
+
         index = njs_generator_dest_index(vm, parser, node);
         if (nxt_slow_path(index == NJS_INDEX_ERROR)) {
             return index;
@@ -1862,13 +2162,8 @@ found:
 
     index = post ? njs_generator_temp_index_get(parser) : dest_index;
 
-    njs_generate_code(parser, njs_vmcode_prop_get_t, prop_get);
-    prop_get->code.operation = njs_vmcode_property_get;
-    prop_get->code.operands = NJS_VMCODE_3OPERANDS;
-    prop_get->code.retval = NJS_VMCODE_RETVAL;
-    prop_get->value = index;
-    prop_get->object = lvalue->left->index;
-    prop_get->property = lvalue->right->index;
+    njs_generate_property_get_code(parser, index, lvalue->left->index,
+                                   lvalue->right);
 
     njs_generate_code(parser, njs_vmcode_3addr_t, code);
     code->code.operation = node->u.operation;
@@ -1878,13 +2173,8 @@ found:
     code->src1 = index;
     code->src2 = index;
 
-    njs_generate_code(parser, njs_vmcode_prop_set_t, prop_set);
-    prop_set->code.operation = njs_vmcode_property_set;
-    prop_set->code.operands = NJS_VMCODE_3OPERANDS;
-    prop_set->code.retval = NJS_VMCODE_NO_RETVAL;
-    prop_set->value = index;
-    prop_set->object = lvalue->left->index;
-    prop_set->property = lvalue->right->index;
+    njs_generate_property_set_code(parser, index, lvalue->left->index,
+                                   lvalue->right);
 
     if (post) {
         ret = njs_generator_index_release(vm, parser, index);
@@ -1926,6 +2216,8 @@ njs_generate_function_scope(njs_vm_t *vm, njs_function_lambda_t *lambda,
     ret = njs_generate_scope(vm, lambda->u.parser, node->right);
 
     if (nxt_fast_path(ret == NXT_OK)) {
+        lambda->compare = njs_generate_lambda_compare(lambda->u.parser);
+        lambda->global_write = lambda->u.parser->global_write;
         lambda->local_size = lambda->u.parser->scope_size;
         lambda->local_scope = lambda->u.parser->local_scope;
         lambda->u.start = lambda->u.parser->code_start;
@@ -2003,11 +2295,52 @@ njs_generate_scope(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *node)
 
     code->start = parser->code_start;
     code->end = parser->code_end;
+    code->variables = parser->scope_values->items;
+    code->temporaries = (scope_size - size) / sizeof(njs_value_t);
 
     return NXT_OK;
 }
 
 
+static nxt_uint_t
+njs_generate_lambda_compare(njs_parser_t *parser)
+{
+    njs_index_t          first, second;
+    njs_vmcode_3addr_t   *sub;
+    njs_vmcode_return_t  *ret;
+
+    if (parser->code_end - parser->code_start
+        != sizeof(njs_vmcode_3addr_t) + sizeof(njs_vmcode_return_t))
+    {
+        return 0;
+    }
+
+    sub = (njs_vmcode_3addr_t *) parser->code_start;
+    ret = (njs_vmcode_return_t *) (sub + 1);
+
+    if (sub->code.operation != njs_vmcode_substraction
+        || ret->code.operation != njs_vmcode_return
+        || ret->retval != sub->dst)
+    {
+        return 0;
+    }
+
+    /* The first argument follows "this". */
+    first = NJS_SCOPE_ARGUMENTS + sizeof(njs_value_t);
+    second = NJS_SCOPE_ARGUMENTS + 2 * sizeof(njs_value_t);
+
+    if (sub->src1 == first && sub->src2 == second) {
+        return NJS_LAMBDA_COMPARE_ASCENDING;
+    }
+
+    if (sub->src1 == second && sub->src2 == first) {
+        return NJS_LAMBDA_COMPARE_DESCENDING;
+    }
+
+    return 0;
+}
+
+
 static nxt_int_t
 njs_generate_return_statement(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -2223,6 +2556,8 @@ njs_generate_try_statement(njs_vm_t *vm, njs_parser_t *parser,
         catch->offset = sizeof(njs_vmcode_catch_t);
         catch->exception = node->left->index;
 
+        njs_generator_global_write(parser, catch->exception);
+
         ret = njs_generator(vm, parser, node->right);
         if (nxt_slow_path(ret != NXT_OK)) {
             return ret;
@@ -2247,6 +2582,8 @@ njs_generate_try_statement(njs_vm_t *vm, njs_parser_t *parser,
             catch->code.retval = NJS_VMCODE_NO_RETVAL;
             catch->exception = node->left->left->index;
 
+            njs_generator_global_write(parser, catch->exception);
+
             ret = njs_generator(vm, parser, node->left->right);
             if (nxt_slow_path(ret != NXT_OK)) {
                 return ret;
@@ -2364,12 +2701,48 @@ njs_generator_object_dest_index(njs_parser_t *parser, njs_parser_node_t *node)
             /* Assign empty object directly to variable */
             return index;
         }
+
+        if (dest->token == NJS_TOKEN_NAME
+            && njs_generator_object_values_simple(node->left, index))
+        {
+            return index;
+        }
     }
 
     return njs_generator_node_temp_index_get(parser, node);
 }
 
 
+/*
+ * An object or array literal is created directly in a variable if the
+ * property values are constants or other variables: such values can
+ * neither refer to the variable being initialized nor throw an exception
+ * after the variable has been changed.
+ */
+
+static nxt_bool_t
+njs_generator_object_values_simple(njs_parser_node_t *node, njs_index_t index)
+{
+    njs_parser_node_t  *value;
+
+    for ( /* void */ ; node != NULL; node = node->left) {
+        value = node->right->right;
+
+        if (njs_generator_is_constant(value)) {
+            continue;
+        }
+
+        if (value->token != NJS_TOKEN_NAME
+            || value->u.variable->index == index)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
 static njs_index_t
 njs_generator_node_temp_index_get(njs_parser_t *parser, njs_parser_node_t *node)
 {
@@ -2412,6 +2785,32 @@ njs_generator_temp_index_get(njs_parser_t *parser)
 }
 
 
+/*
+ * The index cache contains separate values, so adjacent temporary values
+ * are always allocated in the scope.  Only the first value is released
+ * to the cache.
+ */
+
+static njs_index_t
+njs_generator_temp_index_reserve(njs_parser_t *parser, size_t size)
+{
+    nxt_uint_t   n;
+    njs_index_t  index;
+
+    /* Skip absolute and property scopes. */
+    n = parser->scope - NJS_INDEX_CACHE;
+
+    index = parser->index[n];
+    parser->index[n] += size;
+
+    index |= parser->scope;
+
+    nxt_thread_log_debug("RESERVE %p %uz", index, size);
+
+    return index;
+}
+
+
 static nxt_noinline nxt_int_t
 njs_generator_children_indexes_release(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *node)
@@ -2477,3 +2876,17 @@ njs_generator_is_constant(njs_parser_node_t *node)
     return (node->token >= NJS_TOKEN_FIRST_CONST
             && node->token <= NJS_TOKEN_LAST_CONST);
 }
+
+
+/*
+ * A lambda changing global variables makes a private copy of the global
+ * scope shared by a cloned VM with its parent VM before the lambda is run.
+ */
+
+nxt_inline void
+njs_generator_global_write(njs_parser_t *parser, njs_index_t index)
+{
+    if (((uintptr_t) index & NJS_SCOPE_MASK) == NJS_SCOPE_GLOBAL) {
+        parser->global_write = 1;
+    }
+}
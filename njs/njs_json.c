@@ -0,0 +1,1235 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_alignment.h>
+#include <nxt_string.h>
+#include <nxt_stub.h>
+#include <nxt_utf8.h>
+#include <nxt_djb_hash.h>
+#include <nxt_array.h>
+#include <nxt_lvlhsh.h>
+#include <nxt_random.h>
+#include <nxt_mem_cache_pool.h>
+#include <njscript.h>
+#include <njs_vm.h>
+#include <njs_number.h>
+#include <njs_string.h>
+#include <njs_object.h>
+#include <njs_array.h>
+#include <njs_function.h>
+#include <njs_date.h>
+#include <njs_json.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * JSON.parse() builds values in a single pass over the source string.
+ * Strings without escapes are copied directly from the source, so short
+ * strings are stored inside njs_value_t without allocation.
+ *
+ * JSON.stringify() walks a value twice: the first pass counts the size and
+ * the length of the result and the second one writes the result into
+ * a single string allocated with njs_string_alloc().  Both passes produce
+ * the same output since no JavaScript code is called during walking.
+ */
+
+#define NJS_JSON_MAX_DEPTH  128
+
+/* The maximum indentation is 10 characters. */
+#define NJS_JSON_SPACE_MAX  10
+
+/* Integers up to 15 digits are exact in double. */
+#define NJS_JSON_INTEGER_DIGITS  15
+
+
+typedef struct {
+    njs_vm_t                   *vm;
+    const u_char               *end;
+    nxt_uint_t                 depth;
+    nxt_bool_t                 utf8;
+} njs_json_parse_t;
+
+
+typedef struct {
+    njs_vm_t                   *vm;
+
+    /* The pos field is NULL while the result size is counted. */
+    u_char                     *pos;
+    size_t                     size;
+    size_t                     length;
+    nxt_bool_t                 utf8;
+
+    u_char                     space[NJS_JSON_SPACE_MAX * 4];
+    size_t                     space_size;
+    size_t                     space_length;
+
+    nxt_uint_t                 depth;
+    njs_object_t               *stack[NJS_JSON_MAX_DEPTH];
+} njs_json_stringify_t;
+
+
+static const u_char *njs_json_parse_value(njs_json_parse_t *jp,
+    njs_value_t *value, const u_char *p);
+static const u_char *njs_json_parse_object(njs_json_parse_t *jp,
+    njs_value_t *value, const u_char *p);
+static const u_char *njs_json_parse_array(njs_json_parse_t *jp,
+    njs_value_t *value, const u_char *p);
+static const u_char *njs_json_parse_string(njs_json_parse_t *jp,
+    njs_value_t *value, const u_char *p);
+static const u_char *njs_json_parse_escape(const u_char *p, const u_char *end,
+    uint32_t *u);
+static const u_char *njs_json_parse_number(njs_json_parse_t *jp,
+    njs_value_t *value, const u_char *p);
+nxt_inline const u_char *njs_json_skip_space(const u_char *p,
+    const u_char *end);
+static const u_char *njs_json_error(njs_json_parse_t *jp);
+
+static njs_ret_t njs_json_stringify_value(njs_json_stringify_t *js,
+    const njs_value_t *value);
+static njs_ret_t njs_json_stringify_object(njs_json_stringify_t *js,
+    njs_object_t *object);
+static njs_ret_t njs_json_stringify_property(njs_json_stringify_t *js,
+    njs_object_prop_t *prop, nxt_uint_t n);
+static njs_ret_t njs_json_stringify_array(njs_json_stringify_t *js,
+    njs_array_t *array);
+static njs_ret_t njs_json_stringify_number(njs_json_stringify_t *js,
+    const njs_value_t *value);
+static void njs_json_stringify_string(njs_json_stringify_t *js,
+    const njs_value_t *value);
+static void njs_json_stringify_newline(njs_json_stringify_t *js);
+static void njs_json_append(njs_json_stringify_t *js, const u_char *start,
+    size_t size);
+
+
+static njs_ret_t
+njs_json_parse(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_index_t unused)
+{
+    const u_char       *p;
+    njs_value_t        value;
+    njs_json_parse_t   jp;
+    njs_string_prop_t  string;
+
+    if (nargs > 2 && !njs_is_null_or_void(&args[2])) {
+        /* The reviver function is not supported. */
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    if (nargs < 2) {
+        vm->exception = &njs_exception_syntax_error;
+        return NXT_ERROR;
+    }
+
+    (void) njs_string_prop(&string, &args[1]);
+
+    jp.vm = vm;
+    jp.end = string.start + string.size;
+    jp.depth = 0;
+    jp.utf8 = (string.length != 0 || string.size == 0);
+
+    p = njs_json_skip_space(string.start, jp.end);
+
+    p = njs_json_parse_value(&jp, &value, p);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    p = njs_json_skip_space(p, jp.end);
+
+    if (nxt_slow_path(p != jp.end)) {
+        (void) njs_json_error(&jp);
+        return NXT_ERROR;
+    }
+
+    vm->retval = value;
+
+    return NXT_OK;
+}
+
+
+static const u_char *
+njs_json_parse_value(njs_json_parse_t *jp, njs_value_t *value,
+    const u_char *p)
+{
+    size_t  size;
+
+    if (nxt_slow_path(p == jp->end)) {
+        return njs_json_error(jp);
+    }
+
+    size = jp->end - p;
+
+    switch (*p) {
+
+    case '{':
+        return njs_json_parse_object(jp, value, p + 1);
+
+    case '[':
+        return njs_json_parse_array(jp, value, p + 1);
+
+    case '"':
+        return njs_json_parse_string(jp, value, p + 1);
+
+    case 't':
+        if (size >= 4 && memcmp(p, "true", 4) == 0) {
+            *value = njs_value_true;
+            return p + 4;
+        }
+
+        break;
+
+    case 'f':
+        if (size >= 5 && memcmp(p, "false", 5) == 0) {
+            *value = njs_value_false;
+            return p + 5;
+        }
+
+        break;
+
+    case 'n':
+        if (size >= 4 && memcmp(p, "null", 4) == 0) {
+            *value = njs_value_null;
+            return p + 4;
+        }
+
+        break;
+
+    default:
+        if (*p == '-' || (u_char) (*p - '0') <= 9) {
+            return njs_json_parse_number(jp, value, p);
+        }
+
+        break;
+    }
+
+    return njs_json_error(jp);
+}
+
+
+static const u_char *
+njs_json_parse_object(njs_json_parse_t *jp, njs_value_t *value,
+    const u_char *p)
+{
+    nxt_int_t           ret;
+    njs_value_t         name;
+    njs_object_t        *object;
+    njs_object_prop_t   *prop;
+    njs_string_prop_t   string;
+    nxt_lvlhsh_query_t  lhq;
+
+    if (nxt_slow_path(++jp->depth > NJS_JSON_MAX_DEPTH)) {
+        jp->vm->exception = &njs_exception_range_error;
+        return NULL;
+    }
+
+    object = njs_object_alloc(jp->vm);
+    if (nxt_slow_path(object == NULL)) {
+        return NULL;
+    }
+
+    lhq.replace = 1;
+    lhq.proto = &njs_object_hash_proto;
+    lhq.pool = jp->vm->mem_cache_pool;
+
+    p = njs_json_skip_space(p, jp->end);
+
+    if (p != jp->end && *p == '}') {
+        p++;
+        goto done;
+    }
+
+    for ( ;; ) {
+        if (nxt_slow_path(p == jp->end || *p != '"')) {
+            return njs_json_error(jp);
+        }
+
+        p = njs_json_parse_string(jp, &name, p + 1);
+        if (nxt_slow_path(p == NULL)) {
+            return NULL;
+        }
+
+        p = njs_json_skip_space(p, jp->end);
+
+        if (nxt_slow_path(p == jp->end || *p != ':')) {
+            return njs_json_error(jp);
+        }
+
+        p = njs_json_skip_space(p + 1, jp->end);
+
+        prop = njs_object_prop_alloc(jp->vm, &name);
+        if (nxt_slow_path(prop == NULL)) {
+            return NULL;
+        }
+
+        p = njs_json_parse_value(jp, &prop->value, p);
+        if (nxt_slow_path(p == NULL)) {
+            return NULL;
+        }
+
+        (void) njs_string_prop(&string, &name);
+
+        lhq.key.length = string.size;
+        lhq.key.start = string.start;
+        lhq.key_hash = nxt_djb_hash(string.start, string.size);
+        lhq.value = prop;
+
+        /* A duplicate name replaces the previous property. */
+
+        ret = nxt_lvlhsh_insert(&object->hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+
+        p = njs_json_skip_space(p, jp->end);
+
+        if (nxt_slow_path(p == jp->end)) {
+            return njs_json_error(jp);
+        }
+
+        if (*p == ',') {
+            p = njs_json_skip_space(p + 1, jp->end);
+            continue;
+        }
+
+        if (nxt_slow_path(*p != '}')) {
+            return njs_json_error(jp);
+        }
+
+        p++;
+        break;
+    }
+
+done:
+
+    jp->depth--;
+
+    value->data.u.object = object;
+    value->type = NJS_OBJECT;
+    value->data.truth = 1;
+
+    return p;
+}
+
+
+static const u_char *
+njs_json_parse_array(njs_json_parse_t *jp, njs_value_t *value,
+    const u_char *p)
+{
+    njs_ret_t    ret;
+    njs_array_t  *array;
+
+    if (nxt_slow_path(++jp->depth > NJS_JSON_MAX_DEPTH)) {
+        jp->vm->exception = &njs_exception_range_error;
+        return NULL;
+    }
+
+    array = njs_array_alloc(jp->vm, 0, NJS_ARRAY_SPARE);
+    if (nxt_slow_path(array == NULL)) {
+        return NULL;
+    }
+
+    p = njs_json_skip_space(p, jp->end);
+
+    if (p != jp->end && *p == ']') {
+        p++;
+        goto done;
+    }
+
+    for ( ;; ) {
+        if (array->length == array->size) {
+            ret = njs_array_realloc(jp->vm, array, 0, array->size + 1);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NULL;
+            }
+        }
+
+        p = njs_json_parse_value(jp, &array->start[array->length], p);
+        if (nxt_slow_path(p == NULL)) {
+            return NULL;
+        }
+
+        array->length++;
+
+        p = njs_json_skip_space(p, jp->end);
+
+        if (nxt_slow_path(p == jp->end)) {
+            return njs_json_error(jp);
+        }
+
+        if (*p == ',') {
+            p = njs_json_skip_space(p + 1, jp->end);
+            continue;
+        }
+
+        if (nxt_slow_path(*p != ']')) {
+            return njs_json_error(jp);
+        }
+
+        p++;
+        break;
+    }
+
+done:
+
+    jp->depth--;
+
+    value->data.u.array = array;
+    value->type = NJS_ARRAY;
+    value->data.truth = 1;
+
+    return p;
+}
+
+
+static const u_char *
+njs_json_parse_string(njs_json_parse_t *jp, njs_value_t *value,
+    const u_char *p)
+{
+    u_char        c, *dst;
+    size_t        size, length;
+    uint32_t      u;
+    njs_ret_t     ret;
+    nxt_bool_t    escape;
+    const u_char  *start, *last;
+
+    start = p;
+    length = 0;
+    escape = 0;
+
+    /* The first pass finds the string end and the decoded string size. */
+
+    size = 0;
+
+    while (p < jp->end) {
+        c = *p;
+
+        if (c == '"') {
+            break;
+        }
+
+        if (nxt_slow_path(c < 0x20)) {
+            return njs_json_error(jp);
+        }
+
+        if (c == '\\') {
+            escape = 1;
+
+            p = njs_json_parse_escape(p + 1, jp->end, &u);
+            if (nxt_slow_path(p == NULL)) {
+                return njs_json_error(jp);
+            }
+
+            size += nxt_utf8_size(u);
+            length++;
+            continue;
+        }
+
+        /* UTF-8 continuation bytes are 10xxxxxx. */
+        length += ((c & 0xC0) != 0x80);
+        size++;
+        p++;
+    }
+
+    if (nxt_slow_path(p == jp->end)) {
+        return njs_json_error(jp);
+    }
+
+    last = p;
+
+    if (!jp->utf8) {
+        length = 0;
+    }
+
+    if (!escape) {
+        ret = njs_string_new(jp->vm, value, start, size, length);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+
+        return last + 1;
+    }
+
+    dst = njs_string_alloc(jp->vm, value, size, length);
+    if (nxt_slow_path(dst == NULL)) {
+        return NULL;
+    }
+
+    p = start;
+
+    while (p < last) {
+        if (*p == '\\') {
+            p = njs_json_parse_escape(p + 1, last, &u);
+            dst = nxt_utf8_encode(dst, u);
+            continue;
+        }
+
+        *dst++ = *p++;
+    }
+
+    if (size != length && length >= NJS_STRING_MAP_OFFSET) {
+        njs_string_offset_map_init(dst - size, size);
+    }
+
+    return last + 1;
+}
+
+
+static const u_char *
+njs_json_parse_escape(const u_char *p, const u_char *end, uint32_t *u)
+{
+    u_char      c;
+    uint32_t    n, lo;
+    nxt_uint_t  i;
+
+    if (nxt_slow_path(p == end)) {
+        return NULL;
+    }
+
+    c = *p++;
+
+    switch (c) {
+
+    case '"':
+    case '\\':
+    case '/':
+        *u = c;
+        return p;
+
+    case 'b':
+        *u = '\b';
+        return p;
+
+    case 'f':
+        *u = '\f';
+        return p;
+
+    case 'n':
+        *u = '\n';
+        return p;
+
+    case 'r':
+        *u = '\r';
+        return p;
+
+    case 't':
+        *u = '\t';
+        return p;
+
+    case 'u':
+        break;
+
+    default:
+        return NULL;
+    }
+
+    if (nxt_slow_path(end - p < 4)) {
+        return NULL;
+    }
+
+    n = 0;
+
+    for (i = 0; i < 4; i++) {
+        c = *p++;
+
+        if (c >= '0' && c <= '9') {
+            c -= '0';
+
+        } else {
+            c |= 0x20;
+
+            if (nxt_slow_path(c < 'a' || c > 'f')) {
+                return NULL;
+            }
+
+            c -= 'a' - 10;
+        }
+
+        n = (n << 4) | c;
+    }
+
+    /* A surrogate pair is combined into one character. */
+
+    if (n >= 0xD800 && n <= 0xDBFF
+        && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+    {
+        if (njs_json_parse_escape(p + 1, end, &lo) != NULL
+            && lo >= 0xDC00 && lo <= 0xDFFF)
+        {
+            n = 0x10000 + ((n - 0xD800) << 10) + (lo - 0xDC00);
+            p += 6;
+        }
+    }
+
+    *u = n;
+
+    return p;
+}
+
+
+static const u_char *
+njs_json_parse_number(njs_json_parse_t *jp, njs_value_t *value,
+    const u_char *p)
+{
+    u_char        *buf;
+    double        num;
+    size_t        size;
+    int64_t       n;
+    nxt_bool_t    minus, integer;
+    const u_char  *start, *digits;
+    u_char        tmp[64];
+
+    start = p;
+
+    minus = (*p == '-');
+    p += minus;
+
+    digits = p;
+
+    if (nxt_slow_path(p == jp->end || (u_char) (*p - '0') > 9)) {
+        return njs_json_error(jp);
+    }
+
+    n = 0;
+
+    if (*p == '0') {
+        p++;
+
+    } else {
+        do {
+            /* A longer integer is converted by strtod() below. */
+            if (p - digits < NJS_JSON_INTEGER_DIGITS) {
+                n = n * 10 + (*p - '0');
+            }
+
+            p++;
+
+        } while (p < jp->end && (u_char) (*p - '0') <= 9);
+    }
+
+    integer = 1;
+
+    if (p < jp->end && *p == '.') {
+        integer = 0;
+        p++;
+
+        if (nxt_slow_path(p == jp->end || (u_char) (*p - '0') > 9)) {
+            return njs_json_error(jp);
+        }
+
+        while (p < jp->end && (u_char) (*p - '0') <= 9) {
+            p++;
+        }
+    }
+
+    if (p < jp->end && (*p | 0x20) == 'e') {
+        integer = 0;
+        p++;
+
+        if (p < jp->end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+
+        if (nxt_slow_path(p == jp->end || (u_char) (*p - '0') > 9)) {
+            return njs_json_error(jp);
+        }
+
+        while (p < jp->end && (u_char) (*p - '0') <= 9) {
+            p++;
+        }
+    }
+
+    if (integer && p - digits <= NJS_JSON_INTEGER_DIGITS) {
+        num = minus ? -n : n;
+
+    } else {
+        size = p - start;
+
+        if (size < sizeof(tmp)) {
+            buf = tmp;
+
+        } else {
+            buf = nxt_mem_cache_alloc(jp->vm->mem_cache_pool, size + 1);
+            if (nxt_slow_path(buf == NULL)) {
+                return NULL;
+            }
+        }
+
+        memcpy(buf, start, size);
+        buf[size] = '\0';
+
+        num = strtod((char *) buf, NULL);
+
+        if (buf != tmp) {
+            nxt_mem_cache_free(jp->vm->mem_cache_pool, buf);
+        }
+    }
+
+    njs_number_set(value, num);
+
+    return p;
+}
+
+
+nxt_inline const u_char *
+njs_json_skip_space(const u_char *p, const u_char *end)
+{
+    while (p < end) {
+
+        switch (*p) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            p++;
+            continue;
+        }
+
+        break;
+    }
+
+    return p;
+}
+
+
+static const u_char *
+njs_json_error(njs_json_parse_t *jp)
+{
+    jp->vm->exception = &njs_exception_syntax_error;
+
+    return NULL;
+}
+
+
+static njs_ret_t
+njs_json_stringify(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
+    njs_index_t unused)
+{
+    u_char                *p;
+    double                num;
+    size_t                n;
+    njs_ret_t             ret;
+    const u_char          *end;
+    const njs_value_t     *value;
+    njs_string_prop_t     string;
+    njs_json_stringify_t  js;
+
+    if (nargs > 2 && !njs_is_null_or_void(&args[2])) {
+        /* The replacer function and property list are not supported. */
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    value = (nargs > 1) ? &args[1] : &njs_value_void;
+
+    switch (value->type) {
+
+    case NJS_VOID:
+    case NJS_INVALID:
+    case NJS_EXTERNAL:
+    case NJS_FUNCTION:
+        vm->retval = njs_value_void;
+        return NXT_OK;
+
+    default:
+        break;
+    }
+
+    js.vm = vm;
+    js.space_size = 0;
+    js.space_length = 0;
+
+    if (nargs > 3) {
+        if (njs_is_number(&args[3])) {
+            num = args[3].data.u.number;
+
+            if (num >= 1) {
+                n = (num < NJS_JSON_SPACE_MAX) ? num : NJS_JSON_SPACE_MAX;
+
+                memset(js.space, ' ', n);
+                js.space_size = n;
+                js.space_length = n;
+            }
+
+        } else if (njs_is_string(&args[3])) {
+            (void) njs_string_prop(&string, &args[3]);
+
+            p = string.start;
+            end = p + string.size;
+
+            for (n = 0; n < NJS_JSON_SPACE_MAX && p < end; n++) {
+                p = (string.length != 0) ? (u_char *) nxt_utf8_next(p, end)
+                                         : p + 1;
+            }
+
+            js.space_size = p - string.start;
+            js.space_length = (string.length != 0) ? n : js.space_size;
+
+            memcpy(js.space, string.start, js.space_size);
+        }
+    }
+
+    js.pos = NULL;
+    js.size = 0;
+    js.length = 0;
+    js.utf8 = 1;
+    js.depth = 0;
+
+    ret = njs_json_stringify_value(&js, value);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (nxt_slow_path(js.size > NJS_STRING_MAX_LENGTH)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    n = js.utf8 ? js.length : 0;
+
+    p = njs_string_alloc(vm, &vm->retval, js.size, n);
+    if (nxt_slow_path(p == NULL)) {
+        return NXT_ERROR;
+    }
+
+    js.pos = p;
+    js.size = 0;
+    js.length = 0;
+
+    ret = njs_json_stringify_value(&js, value);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    if (js.size != n && n >= NJS_STRING_MAP_OFFSET) {
+        njs_string_offset_map_init(p, js.size);
+    }
+
+    return NXT_OK;
+}
+
+
+/* Values which are omitted in objects and are replaced by null in arrays. */
+
+#define njs_json_is_omitted(value)                                            \
+    ((value)->type == NJS_VOID || (value)->type == NJS_INVALID                \
+     || (value)->type == NJS_EXTERNAL || (value)->type == NJS_FUNCTION)
+
+
+static njs_ret_t
+njs_json_stringify_value(njs_json_stringify_t *js, const njs_value_t *value)
+{
+    size_t  size;
+    double  time;
+    u_char  buf[NJS_ISO_DATE_TIME_LEN + 2];
+
+    switch (value->type) {
+
+    case NJS_OBJECT_BOOLEAN:
+    case NJS_OBJECT_NUMBER:
+    case NJS_OBJECT_STRING:
+        value = &value->data.u.object_value->value;
+        break;
+
+    default:
+        break;
+    }
+
+    switch (value->type) {
+
+    case NJS_NULL:
+        njs_json_append(js, (u_char *) "null", 4);
+        return NXT_OK;
+
+    case NJS_BOOLEAN:
+        if (njs_is_true(value)) {
+            njs_json_append(js, (u_char *) "true", 4);
+
+        } else {
+            njs_json_append(js, (u_char *) "false", 5);
+        }
+
+        return NXT_OK;
+
+    case NJS_NUMBER:
+        return njs_json_stringify_number(js, value);
+
+    case NJS_STRING:
+        njs_json_stringify_string(js, value);
+        return NXT_OK;
+
+    case NJS_DATE:
+        time = value->data.u.date->time;
+
+        if (njs_is_nan(time)) {
+            njs_json_append(js, (u_char *) "null", 4);
+            return NXT_OK;
+        }
+
+        buf[0] = '"';
+        size = njs_date_iso_string(&buf[1], time);
+        buf[size + 1] = '"';
+
+        njs_json_append(js, buf, size + 2);
+        return NXT_OK;
+
+    case NJS_ARRAY:
+        return njs_json_stringify_array(js, value->data.u.array);
+
+    default:
+        return njs_json_stringify_object(js, value->data.u.object);
+    }
+}
+
+
+static njs_ret_t
+njs_json_stringify_object(njs_json_stringify_t *js, njs_object_t *object)
+{
+    njs_ret_t          ret;
+    nxt_uint_t         i, n;
+    njs_object_prop_t  *prop;
+    nxt_lvlhsh_each_t  lhe;
+
+    for (i = 0; i < js->depth; i++) {
+        if (nxt_slow_path(js->stack[i] == object)) {
+            /* A circular structure. */
+            js->vm->exception = &njs_exception_type_error;
+            return NXT_ERROR;
+        }
+    }
+
+    if (nxt_slow_path(js->depth == NJS_JSON_MAX_DEPTH)) {
+        js->vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    js->stack[js->depth++] = object;
+
+    njs_json_append(js, (u_char *) "{", 1);
+
+    n = 0;
+
+    if (object->shape != NULL) {
+        prop = njs_object_slots(object);
+
+        for (i = 0; i < object->shape->items; i++) {
+            ret = njs_json_stringify_property(js, &prop[i], n);
+
+            if (ret != NXT_DECLINED) {
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+
+                n++;
+            }
+        }
+    }
+
+    memset(&lhe, 0, sizeof(nxt_lvlhsh_each_t));
+    lhe.proto = &njs_object_hash_proto;
+
+    for ( ;; ) {
+        prop = nxt_lvlhsh_each(&object->hash, &lhe);
+
+        if (prop == NULL) {
+            break;
+        }
+
+        ret = njs_json_stringify_property(js, prop, n);
+
+        if (ret != NXT_DECLINED) {
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+
+            n++;
+        }
+    }
+
+    js->depth--;
+
+    if (n != 0) {
+        njs_json_stringify_newline(js);
+    }
+
+    njs_json_append(js, (u_char *) "}", 1);
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_json_stringify_property(njs_json_stringify_t *js, njs_object_prop_t *prop,
+    nxt_uint_t n)
+{
+    if (prop->type != NJS_PROPERTY
+        || !prop->enumerable
+        || njs_json_is_omitted(&prop->value))
+    {
+        return NXT_DECLINED;
+    }
+
+    if (n != 0) {
+        njs_json_append(js, (u_char *) ",", 1);
+    }
+
+    njs_json_stringify_newline(js);
+
+    njs_json_stringify_string(js, &prop->name);
+
+    if (js->space_size != 0) {
+        njs_json_append(js, (u_char *) ": ", 2);
+
+    } else {
+        njs_json_append(js, (u_char *) ":", 1);
+    }
+
+    return njs_json_stringify_value(js, &prop->value);
+}
+
+
+static njs_ret_t
+njs_json_stringify_array(njs_json_stringify_t *js, njs_array_t *array)
+{
+    njs_ret_t    ret;
+    uint32_t     i;
+    njs_value_t  *value;
+
+    for (i = 0; i < js->depth; i++) {
+        if (nxt_slow_path(js->stack[i] == &array->object)) {
+            /* A circular structure. */
+            js->vm->exception = &njs_exception_type_error;
+            return NXT_ERROR;
+        }
+    }
+
+    if (nxt_slow_path(js->depth == NJS_JSON_MAX_DEPTH)) {
+        js->vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    js->stack[js->depth++] = &array->object;
+
+    njs_json_append(js, (u_char *) "[", 1);
+
+    for (i = 0; i < array->length; i++) {
+        if (i != 0) {
+            njs_json_append(js, (u_char *) ",", 1);
+        }
+
+        njs_json_stringify_newline(js);
+
+        value = &array->start[i];
+
+        if (njs_json_is_omitted(value)) {
+            njs_json_append(js, (u_char *) "null", 4);
+            continue;
+        }
+
+        ret = njs_json_stringify_value(js, value);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
+    js->depth--;
+
+    if (array->length != 0) {
+        njs_json_stringify_newline(js);
+    }
+
+    njs_json_append(js, (u_char *) "]", 1);
+
+    return NXT_OK;
+}
+
+
+static njs_ret_t
+njs_json_stringify_number(njs_json_stringify_t *js, const njs_value_t *value)
+{
+    njs_ret_t          ret;
+    njs_value_t        string;
+    njs_string_prop_t  prop;
+
+    if (njs_is_nan(value->data.u.number)
+        || njs_is_infinity(value->data.u.number))
+    {
+        njs_json_append(js, (u_char *) "null", 4);
+        return NXT_OK;
+    }
+
+    ret = njs_number_to_string(js->vm, &string, value);
+    if (nxt_slow_path(ret != NXT_OK)) {
+        return ret;
+    }
+
+    (void) njs_string_prop(&prop, &string);
+
+    njs_json_append(js, prop.start, prop.size);
+
+    return NXT_OK;
+}
+
+
+static void
+njs_json_stringify_string(njs_json_stringify_t *js, const njs_value_t *value)
+{
+    u_char             c, *dst;
+    size_t             size, length;
+    const u_char       *p, *end;
+    njs_string_prop_t  string;
+    u_char             buf[6];
+
+    static const u_char  hex[16] = "0123456789abcdef";
+
+    (void) njs_string_prop(&string, (njs_value_t *) value);
+
+    if (string.length == 0 && string.size != 0) {
+        /* A byte string makes the result a byte string. */
+        js->utf8 = 0;
+    }
+
+    length = (string.length != 0) ? string.length : string.size;
+
+    njs_json_append(js, (u_char *) "\"", 1);
+
+    p = string.start;
+    end = p + string.size;
+
+    while (p < end) {
+
+        /* Characters which do not require escaping are copied at once. */
+
+        size = 0;
+
+        while (p + size < end) {
+            c = p[size];
+
+            if (c < 0x20 || c == '"' || c == '\\') {
+                break;
+            }
+
+            size++;
+        }
+
+        if (size != 0) {
+            njs_json_append(js, p, size);
+            p += size;
+            continue;
+        }
+
+        c = *p++;
+        dst = buf;
+
+        *dst++ = '\\';
+
+        switch (c) {
+
+        case '"':
+        case '\\':
+            *dst++ = c;
+            break;
+
+        case '\b':
+            *dst++ = 'b';
+            break;
+
+        case '\f':
+            *dst++ = 'f';
+            break;
+
+        case '\n':
+            *dst++ = 'n';
+            break;
+
+        case '\r':
+            *dst++ = 'r';
+            break;
+
+        case '\t':
+            *dst++ = 't';
+            break;
+
+        default:
+            *dst++ = 'u';
+            *dst++ = '0';
+            *dst++ = '0';
+            *dst++ = hex[c >> 4];
+            *dst++ = hex[c & 0x0f];
+            break;
+        }
+
+        njs_json_append(js, buf, dst - buf);
+    }
+
+    njs_json_append(js, (u_char *) "\"", 1);
+
+    /* UTF-8 characters have been counted by njs_json_append() as bytes. */
+    js->length -= string.size - length;
+}
+
+
+static void
+njs_json_stringify_newline(njs_json_stringify_t *js)
+{
+    nxt_uint_t  i;
+
+    if (js->space_size == 0) {
+        return;
+    }
+
+    njs_json_append(js, (u_char *) "\n", 1);
+
+    for (i = 0; i < js->depth; i++) {
+        njs_json_append(js, js->space, js->space_size);
+
+        js->length -= js->space_size - js->space_length;
+    }
+}
+
+
+/*
+ * The function counts appended bytes as characters, so callers correct
+ * the length of non-ASCII data.
+ */
+
+static void
+njs_json_append(njs_json_stringify_t *js, const u_char *start, size_t size)
+{
+    if (js->pos != NULL) {
+        memcpy(js->pos, start, size);
+        js->pos += size;
+    }
+
+    js->size += size;
+    js->length += size;
+}
+
+
+static const njs_object_prop_t  njs_json_object_properties[] =
+{
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("parse"),
+        .value = njs_native_function(njs_json_parse, 0,
+                     NJS_SKIP_ARG, NJS_STRING_ARG),
+    },
+
+    {
+        .type = NJS_METHOD,
+        .name = njs_string("stringify"),
+        .value = njs_native_function(njs_json_stringify, 0, 0),
+    },
+};
+
+
+const njs_object_init_t  njs_json_object_init = {
+    njs_json_object_properties,
+    nxt_nitems(njs_json_object_properties),
+};
@@ -18,6 +18,7 @@
 #include <njs_variable.h>
 #include <njs_parser.h>
 #include <string.h>
+#include <stdlib.h>
 
 
 typedef struct njs_lexer_multi_s  njs_lexer_multi_t;
@@ -531,7 +532,9 @@ static njs_token_t
 njs_lexer_number(njs_lexer_t *lexer)
 {
     u_char  c, *p;
+    size_t  size;
     double  num, frac, scale;
+    u_char  buf[128];
 
     /* TODO: "1e2" */
 
@@ -560,10 +563,11 @@ njs_lexer_number(njs_lexer_t *lexer)
         }
     }
 
+    scale = 1;
+
     if (*p == '.') {
 
         frac = 0;
-        scale = 1;
 
         for (p++; p < lexer->end; p++) {
             c = *p;
@@ -582,6 +586,20 @@ njs_lexer_number(njs_lexer_t *lexer)
         num += frac / scale;
     }
 
+    size = p - (lexer->start - 1);
+
+    /*
+     * Integers up to 15 digits are exact in double, other numbers
+     * are rounded correctly by strtod().
+     */
+
+    if ((size > 15 || scale != 1) && size < sizeof(buf)) {
+        memcpy(buf, lexer->start - 1, size);
+        buf[size] = '\0';
+
+        num = strtod((char *) buf, NULL);
+    }
+
     lexer->number = num;
     lexer->start = p;
 
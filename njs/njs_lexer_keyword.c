@@ -75,6 +75,7 @@ static const njs_keyword_t  njs_keywords[] = {
 
     { nxt_string("this"),          NJS_TOKEN_THIS, 0 },
     { nxt_string("Math"),          NJS_TOKEN_MATH, 0 },
+    { nxt_string("JSON"),          NJS_TOKEN_JSON, 0 },
 
     /* Builtin functions. */
 
@@ -86,6 +87,9 @@ static const njs_keyword_t  njs_keywords[] = {
     { nxt_string("Function"),      NJS_TOKEN_FUNCTION_CONSTRUCTOR, 0 },
     { nxt_string("RegExp"),        NJS_TOKEN_REGEXP_CONSTRUCTOR, 0 },
     { nxt_string("Date"),          NJS_TOKEN_DATE_CONSTRUCTOR, 0 },
+    { nxt_string("ArrayBuffer"),   NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR, 0 },
+    { nxt_string("Uint8Array"),    NJS_TOKEN_TYPED_ARRAY_CONSTRUCTOR, 0 },
+    { nxt_string("DataView"),      NJS_TOKEN_DATA_VIEW_CONSTRUCTOR, 0 },
 
     { nxt_string("eval"),          NJS_TOKEN_EVAL, 0 },
     { nxt_string("toString"),      NJS_TOKEN_TO_STRING, 0 },
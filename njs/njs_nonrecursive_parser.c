@@ -509,8 +509,7 @@ njs_parser_unary_negative_link(njs_vm_t *vm, njs_parser_t *parser,
         /* Optimization of common negative number. */
         node = parser->node;
         num = -node->u.value.data.u.number;
-        node->u.value.data.u.number = num;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_number_set(&node->u.value, num);
 
     } else {
         node->left = parser->node;
@@ -646,9 +645,7 @@ njs_parser_number_expression(njs_vm_t *vm, njs_parser_t *parser,
     if (nxt_fast_path(node != NULL)) {
         node->token = token;
         num = parser->lexer->number;
-        node->u.value.data.u.number = num;
-        node->u.value.type = NJS_NUMBER;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_number_set(&node->u.value, num);
         parser->node = node;
 
         return NXT_OK;
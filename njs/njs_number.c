@@ -8,6 +8,7 @@
 #include <nxt_clang.h>
 #include <nxt_string.h>
 #include <nxt_stub.h>
+#include <nxt_dtoa.h>
 #include <nxt_array.h>
 #include <nxt_lvlhsh.h>
 #include <nxt_random.h>
@@ -20,7 +21,7 @@
 #include <njs_array.h>
 #include <njs_function.h>
 #include <string.h>
-#include <stdio.h>
+#include <stdlib.h>
 
 
 static njs_ret_t njs_number_to_string_radix(njs_vm_t *vm, njs_value_t *string,
@@ -66,8 +67,10 @@ double
 njs_number_parse(const u_char **start, const u_char *end)
 {
     u_char        c;
+    size_t        size;
     double        num, frac, scale;
     const u_char  *p;
+    u_char        buf[128];
 
     /* TODO: "1e2" */
 
@@ -93,10 +96,11 @@ njs_number_parse(const u_char **start, const u_char *end)
         p++;
     }
 
+    scale = 1;
+
     if (*p == '.') {
 
         frac = 0;
-        scale = 1;
 
         for (p++; p < end; p++) {
             c = *p;
@@ -115,6 +119,20 @@ njs_number_parse(const u_char **start, const u_char *end)
         num += frac / scale;
     }
 
+    size = p - *start;
+
+    /*
+     * Integers up to 15 digits are exact in double, other numbers
+     * are rounded correctly by strtod().
+     */
+
+    if ((size > 15 || scale != 1) && size < sizeof(buf)) {
+        memcpy(buf, *start, size);
+        buf[size] = '\0';
+
+        num = strtod((char *) buf, NULL);
+    }
+
     *start = p;
 
     return num;
@@ -168,11 +186,10 @@ njs_ret_t
 njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
     const njs_value_t *number)
 {
-    double             n, num;
+    double             num;
     size_t             size;
-    const char         *fmt;
     const njs_value_t  *value;
-    u_char             buf[128];
+    u_char             buf[NXT_DTOA_MAX_LEN];
 
     num = number->data.u.number;
 
@@ -189,25 +206,7 @@ njs_number_to_string(njs_vm_t *vm, njs_value_t *string,
         }
 
     } else {
-        n = fabs(num);
-
-        if (n == 0) {
-            fmt = "%g";
-
-        } else if (n < 1) {
-            fmt = "%f";
-
-        } else if (n < 1000000) {
-            fmt = "%g";
-
-        } else if (n < 1e20) {
-            fmt = "%1.f";
-
-        } else {
-            fmt = "%1.e";
-        }
-
-        size = snprintf((char *) buf, sizeof(buf), fmt, num);
+        size = nxt_dtoa(num, buf);
 
         return njs_string_new(vm, string, buf, size, size);
     }
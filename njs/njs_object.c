@@ -6,6 +6,7 @@
 
 #include <nxt_types.h>
 #include <nxt_clang.h>
+#include <nxt_alignment.h>
 #include <nxt_string.h>
 #include <nxt_stub.h>
 #include <nxt_djb_hash.h>
@@ -36,6 +37,7 @@ njs_object_alloc(njs_vm_t *vm)
         nxt_lvlhsh_init(&object->hash);
         nxt_lvlhsh_init(&object->shared_hash);
         object->__proto__ = &vm->prototypes[NJS_PROTOTYPE_OBJECT];
+        object->shape = NULL;
         object->shared = 0;
     }
 
@@ -43,6 +45,39 @@ njs_object_alloc(njs_vm_t *vm)
 }
 
 
+/*
+ * An object created by object literal has all the literal properties
+ * in place from the start, so they are stored in one allocation with
+ * the object and are looked up by the shape shared by all objects
+ * created by the literal.
+ */
+
+nxt_noinline njs_object_t *
+njs_object_shaped_alloc(njs_vm_t *vm, njs_object_shape_t *shape)
+{
+    size_t        size;
+    njs_object_t  *object;
+
+    size = nxt_align_size(sizeof(njs_object_t), sizeof(njs_value_t));
+
+    object = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                            size + shape->items * sizeof(njs_object_prop_t));
+
+    if (nxt_fast_path(object != NULL)) {
+        nxt_lvlhsh_init(&object->hash);
+        nxt_lvlhsh_init(&object->shared_hash);
+        object->__proto__ = &vm->prototypes[NJS_PROTOTYPE_OBJECT];
+        object->shape = shape;
+        object->shared = 0;
+
+        memcpy(njs_object_slots(object), shape->properties,
+               shape->items * sizeof(njs_object_prop_t));
+    }
+
+    return object;
+}
+
+
 njs_object_t *
 njs_object_value_copy(njs_vm_t *vm, njs_value_t *value)
 {
@@ -78,6 +113,7 @@ njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value, nxt_uint_t type)
     if (nxt_fast_path(ov != NULL)) {
         nxt_lvlhsh_init(&ov->object.hash);
         nxt_lvlhsh_init(&ov->object.shared_hash);
+        ov->object.shape = NULL;
         ov->object.shared = 0;
 
         index = njs_primitive_prototype_index(type);
@@ -90,6 +126,144 @@ njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value, nxt_uint_t type)
 }
 
 
+njs_object_shape_t *
+njs_object_shape_create(njs_vm_t *vm, njs_value_t **names, nxt_uint_t n)
+{
+    size_t              size;
+    uint32_t            hash;
+    nxt_uint_t          i, j;
+    njs_object_prop_t   *prop;
+    njs_object_shape_t  *shape;
+    nxt_lvlhsh_query_t  lhq;
+
+    size = nxt_align_size(sizeof(njs_object_shape_t), sizeof(njs_value_t));
+
+    shape = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                size + n * sizeof(njs_object_prop_t)
+                                + n * sizeof(uint32_t));
+    if (nxt_slow_path(shape == NULL)) {
+        return NULL;
+    }
+
+    shape->properties = (njs_object_prop_t *) ((u_char *) shape + size);
+    shape->hashes = (uint32_t *) &shape->properties[n];
+    shape->items = 0;
+
+    for (i = 0; i < n; i++) {
+        lhq.key.length = names[i]->short_string.size;
+
+        if (lhq.key.length != NJS_STRING_LONG) {
+            lhq.key.start = names[i]->short_string.start;
+
+        } else {
+            lhq.key.length = names[i]->data.string_size;
+            lhq.key.start = names[i]->data.u.string->start;
+        }
+
+        hash = nxt_djb_hash(lhq.key.start, lhq.key.length);
+
+        for (j = 0; j < shape->items; j++) {
+            if (shape->hashes[j] == hash
+                && njs_object_hash_test(&lhq, &shape->properties[j]) == NXT_OK)
+            {
+                /* A duplicate literal property name. */
+                break;
+            }
+        }
+
+        if (j != shape->items) {
+            continue;
+        }
+
+        prop = &shape->properties[shape->items];
+
+        prop->value = njs_value_void;
+        prop->name = *names[i];
+        prop->type = NJS_PROPERTY;
+        prop->enumerable = 1;
+        prop->writable = 1;
+        prop->configurable = 1;
+
+        shape->hashes[shape->items++] = hash;
+    }
+
+    return shape;
+}
+
+
+nxt_int_t
+njs_object_shape_find(njs_object_t *object, nxt_lvlhsh_query_t *lhq)
+{
+    nxt_uint_t          i;
+    njs_object_prop_t   *slots;
+    njs_object_shape_t  *shape;
+
+    shape = object->shape;
+    slots = njs_object_slots(object);
+
+    for (i = 0; i < shape->items; i++) {
+        if (shape->hashes[i] == lhq->key_hash
+            && njs_object_hash_test(lhq, &slots[i]) == NXT_OK)
+        {
+            lhq->value = &slots[i];
+            return NXT_OK;
+        }
+    }
+
+    return NXT_DECLINED;
+}
+
+
+/*
+ * An object leaves its shape when a property is added or deleted.
+ * The slots are moved to the private hash in place, so pointers to
+ * the properties remain valid.
+ */
+
+nxt_int_t
+njs_object_shape_to_hash(njs_vm_t *vm, njs_object_t *object)
+{
+    nxt_int_t           ret;
+    nxt_uint_t          i;
+    njs_object_prop_t   *prop;
+    njs_object_shape_t  *shape;
+    nxt_lvlhsh_query_t  lhq;
+
+    shape = object->shape;
+    prop = njs_object_slots(object);
+
+    lhq.replace = 0;
+    lhq.proto = &njs_object_hash_proto;
+    lhq.pool = vm->mem_cache_pool;
+
+    for (i = 0; i < shape->items; i++) {
+        lhq.key.length = prop->name.short_string.size;
+
+        if (lhq.key.length != NJS_STRING_LONG) {
+            lhq.key.start = prop->name.short_string.start;
+
+        } else {
+            lhq.key.length = prop->name.data.string_size;
+            lhq.key.start = prop->name.data.u.string->start;
+        }
+
+        lhq.key_hash = shape->hashes[i];
+        lhq.value = prop;
+
+        ret = nxt_lvlhsh_insert(&object->hash, &lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NXT_ERROR;
+        }
+
+        prop++;
+    }
+
+    object->shape = NULL;
+
+    return NXT_OK;
+}
+
+
 nxt_int_t
 njs_object_hash_create(njs_vm_t *vm, nxt_lvlhsh_t *hash,
     const njs_object_prop_t *prop, nxt_uint_t n)
@@ -205,7 +379,12 @@ njs_object_property(njs_vm_t *vm, njs_object_t *object, nxt_lvlhsh_query_t *lhq)
     lhq->proto = &njs_object_hash_proto;
 
     do {
-        ret = nxt_lvlhsh_find(&object->hash, lhq);
+        if (object->shape != NULL) {
+            ret = njs_object_shape_find(object, lhq);
+
+        } else {
+            ret = nxt_lvlhsh_find(&object->hash, lhq);
+        }
 
         if (nxt_fast_path(ret == NXT_OK)) {
             return lhq->value;
@@ -519,7 +698,7 @@ njs_object_prototype_create_constructor(njs_vm_t *vm, njs_value_t *value)
 found:
 
     cons = njs_property_constructor_create(vm, &prototype->hash,
-                                          &vm->scopes[NJS_SCOPE_GLOBAL][index]);
+                                      &vm->scopes[NJS_SCOPE_BUILTIN][index]);
     if (nxt_fast_path(cons != NULL)) {
         vm->retval = *cons;
         return NXT_OK;
@@ -598,6 +777,12 @@ static const njs_value_t  njs_object_regexp_string =
                                      njs_long_string("[object RegExp]");
 static const njs_value_t  njs_object_date_string =
                                      njs_long_string("[object Date]");
+static const njs_value_t  njs_object_array_buffer_string =
+                                     njs_long_string("[object ArrayBuffer]");
+static const njs_value_t  njs_object_typed_array_string =
+                                     njs_long_string("[object Uint8Array]");
+static const njs_value_t  njs_object_data_view_string =
+                                     njs_long_string("[object DataView]");
 
 
 njs_ret_t
@@ -628,6 +813,9 @@ njs_object_prototype_to_string(njs_vm_t *vm, njs_value_t *args,
         &njs_object_function_string,
         &njs_object_regexp_string,
         &njs_object_date_string,
+        &njs_object_array_buffer_string,
+        &njs_object_typed_array_string,
+        &njs_object_data_view_string,
     };
 
     index = args[0].type;
@@ -8,6 +8,10 @@
 #define _NJS_OBJECT_H_INCLUDED_
 
 
+/* Larger object literals use the private hash. */
+#define NJS_OBJECT_SHAPE_MAX  16
+
+
 struct njs_object_value_s {
     njs_object_t                object;
     njs_value_t                 value;
@@ -37,6 +41,20 @@ typedef struct {
 } njs_object_prop_t;
 
 
+struct njs_object_shape_s {
+    /* Templates of the object slots. */
+    njs_object_prop_t           *properties;
+    uint32_t                    *hashes;
+    uint32_t                    items;
+};
+
+
+#define njs_object_slots(object)                                              \
+    ((njs_object_prop_t *)                                                    \
+        ((u_char *) (object)                                                  \
+         + nxt_align_size(sizeof(njs_object_t), sizeof(njs_value_t))))
+
+
 struct njs_object_init_s {
     const njs_object_prop_t     *properties;
     nxt_uint_t                  items;
@@ -44,11 +62,16 @@ struct njs_object_init_s {
 
 
 njs_object_t *njs_object_alloc(njs_vm_t *vm);
+njs_object_t *njs_object_shaped_alloc(njs_vm_t *vm, njs_object_shape_t *shape);
 njs_object_t *njs_object_value_copy(njs_vm_t *vm, njs_value_t *value);
 njs_object_t *njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value,
     nxt_uint_t type);
 njs_object_prop_t *njs_object_property(njs_vm_t *vm, njs_object_t *obj,
     nxt_lvlhsh_query_t *lhq);
+njs_object_shape_t *njs_object_shape_create(njs_vm_t *vm,
+    njs_value_t **names, nxt_uint_t n);
+nxt_int_t njs_object_shape_find(njs_object_t *object, nxt_lvlhsh_query_t *lhq);
+nxt_int_t njs_object_shape_to_hash(njs_vm_t *vm, njs_object_t *object);
 nxt_int_t njs_object_hash_create(njs_vm_t *vm, nxt_lvlhsh_t *hash,
     const njs_object_prop_t *prop, nxt_uint_t n);
 njs_ret_t njs_object_constructor(njs_vm_t *vm, njs_value_t *args,
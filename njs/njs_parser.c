@@ -58,6 +58,9 @@ static njs_token_t njs_parser_while_statement(njs_vm_t *vm,
     njs_parser_t *parser);
 static njs_token_t njs_parser_do_while_statement(njs_vm_t *vm,
     njs_parser_t *parser);
+static nxt_int_t njs_parser_constant_branch(njs_vm_t *vm,
+    njs_parser_t *parser, njs_parser_node_t *node);
+static nxt_bool_t njs_parser_has_function_declaration(njs_parser_node_t *node);
 static njs_token_t njs_parser_for_statement(njs_vm_t *vm, njs_parser_t *parser);
 static njs_token_t njs_parser_for_in_statement(njs_vm_t *vm,
     njs_parser_t *parser, nxt_str_t *name, njs_token_t token);
@@ -778,6 +781,14 @@ njs_parser_if_statement(njs_vm_t *vm, njs_parser_t *parser)
     parser->node = node;
     parser->code_size += sizeof(njs_vmcode_cond_jump_t);
 
+    if (njs_parser_is_constant(cond)) {
+        if (nxt_slow_path(njs_parser_constant_branch(vm, parser, node)
+                          != NXT_OK))
+        {
+            return NJS_TOKEN_ERROR;
+        }
+    }
+
     return token;
 }
 
@@ -928,10 +939,89 @@ njs_parser_while_statement(njs_vm_t *vm, njs_parser_t *parser)
     parser->code_size += sizeof(njs_vmcode_jump_t)
                          + sizeof(njs_vmcode_cond_jump_t);
 
+    if (njs_parser_is_constant(cond) && !njs_is_true(&cond->u.value)) {
+        if (nxt_slow_path(njs_parser_constant_branch(vm, parser, node)
+                          != NXT_OK))
+        {
+            return NJS_TOKEN_ERROR;
+        }
+    }
+
     return token;
 }
 
 
+/*
+ * An "if" statement with a constant condition is replaced by its taken
+ * branch and a "while" loop with a false condition is removed.  The taken
+ * branch is wrapped in a statement node: a statements chain must not end
+ * with NULL node and the statement value remains undefined.  A dead branch
+ * with a function declaration is kept since the function is hoisted.
+ */
+
+static nxt_int_t
+njs_parser_constant_branch(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node)
+{
+    njs_parser_node_t  *stmt, *branch, *taken, *dead;
+
+    if (node->token == NJS_TOKEN_IF) {
+        branch = node->right;
+
+        if (branch != NULL && branch->token == NJS_TOKEN_BRANCHING) {
+            taken = branch->left;
+            dead = branch->right;
+
+        } else {
+            taken = branch;
+            dead = NULL;
+        }
+
+        if (!njs_is_true(&node->left->u.value)) {
+            stmt = taken;
+            taken = dead;
+            dead = stmt;
+        }
+
+    } else {
+        /* A "while" loop with a false condition. */
+        taken = NULL;
+        dead = node->left;
+    }
+
+    if (njs_parser_has_function_declaration(dead)) {
+        return NXT_OK;
+    }
+
+    stmt = njs_parser_node_alloc(vm);
+    if (nxt_slow_path(stmt == NULL)) {
+        return NXT_ERROR;
+    }
+
+    stmt->token = NJS_TOKEN_STATEMENT;
+    stmt->right = taken;
+    parser->node = stmt;
+
+    return NXT_OK;
+}
+
+
+static nxt_bool_t
+njs_parser_has_function_declaration(njs_parser_node_t *node)
+{
+    if (node == NULL) {
+        return 0;
+    }
+
+    if (node->token == NJS_TOKEN_FUNCTION) {
+        return 1;
+    }
+
+    return (njs_parser_has_function_declaration(node->left)
+            || njs_parser_has_function_declaration(node->right));
+}
+
+
 static njs_token_t
 njs_parser_do_while_statement(njs_vm_t *vm, njs_parser_t *parser)
 {
@@ -1525,7 +1615,7 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
             parser->node = node;
         }
 
-        parser->code_size += sizeof(njs_vmcode_1addr_t);
+        parser->code_size += sizeof(njs_vmcode_object_t);
 
         return token;
 
@@ -1594,9 +1684,7 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
         nxt_thread_log_debug("JS: %f", parser->lexer->number);
 
         num = parser->lexer->number;
-        node->u.value.data.u.number = num;
-        node->u.value.type = NJS_NUMBER;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_number_set(&node->u.value, num);
 
         break;
 
@@ -1631,6 +1719,7 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
         break;
 
     case NJS_TOKEN_MATH:
+    case NJS_TOKEN_JSON:
         return njs_parser_builtin_object(vm, parser, node);
 
     case NJS_TOKEN_OBJECT_CONSTRUCTOR:
@@ -1665,6 +1754,18 @@ njs_parser_terminal(njs_vm_t *vm, njs_parser_t *parser, njs_token_t token)
         node->index = NJS_INDEX_DATE;
         break;
 
+    case NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR:
+        node->index = NJS_INDEX_ARRAY_BUFFER;
+        break;
+
+    case NJS_TOKEN_TYPED_ARRAY_CONSTRUCTOR:
+        node->index = NJS_INDEX_TYPED_ARRAY;
+        break;
+
+    case NJS_TOKEN_DATA_VIEW_CONSTRUCTOR:
+        node->index = NJS_INDEX_DATA_VIEW;
+        break;
+
     case NJS_TOKEN_EVAL:
     case NJS_TOKEN_TO_STRING:
     case NJS_TOKEN_IS_NAN:
@@ -1788,7 +1889,7 @@ njs_parser_object(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *obj)
         propref->token = NJS_TOKEN_PROPERTY;
         propref->left = object;
         propref->right = parser->node;
-        parser->code_size += sizeof(njs_vmcode_3addr_t);
+        parser->code_size += sizeof(njs_vmcode_prop_const_set_t);
 
         if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
             return token;
@@ -1870,9 +1971,7 @@ njs_parser_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *obj)
         }
 
         node->token = NJS_TOKEN_NUMBER;
-        node->u.value.data.u.number = index;
-        node->u.value.type = NJS_NUMBER;
-        node->u.value.data.truth = (index != 0);
+        njs_number_set(&node->u.value, index);
         index++;
 
         object = njs_parser_node_alloc(vm);
@@ -1891,7 +1990,7 @@ njs_parser_array(njs_vm_t *vm, njs_parser_t *parser, njs_parser_node_t *obj)
         propref->token = NJS_TOKEN_PROPERTY;
         propref->left = object;
         propref->right = node;
-        parser->code_size += sizeof(njs_vmcode_3addr_t);
+        parser->code_size += sizeof(njs_vmcode_prop_const_set_t);
 
         token = njs_parser_conditional_expression(vm, parser, token);
         if (nxt_slow_path(token <= NJS_TOKEN_ILLEGAL)) {
@@ -2171,13 +2270,32 @@ njs_parser_has_side_effect(njs_parser_node_t *node)
     if (node->token >= NJS_TOKEN_ASSIGNMENT
         && node->token <= NJS_TOKEN_LAST_ASSIGNMENT)
     {
+        /*
+         * An initialization of object or array literal property changes
+         * only the new object, so only the property value is tested.
+         */
+        if (node->token == NJS_TOKEN_ASSIGNMENT
+            && node->left->token == NJS_TOKEN_PROPERTY
+            && node->left->left->token == NJS_TOKEN_OBJECT_VALUE)
+        {
+            return njs_parser_has_side_effect(node->right);
+        }
+
         return 1;
     }
 
-    if (node->token == NJS_TOKEN_FUNCTION_CALL
-        || node->token == NJS_TOKEN_METHOD_CALL)
-    {
+    switch (node->token) {
+
+    case NJS_TOKEN_FUNCTION_CALL:
+    case NJS_TOKEN_METHOD_CALL:
+    case NJS_TOKEN_INCREMENT:
+    case NJS_TOKEN_POST_INCREMENT:
+    case NJS_TOKEN_DECREMENT:
+    case NJS_TOKEN_POST_DECREMENT:
         return 1;
+
+    default:
+        break;
     }
 
     side_effect = njs_parser_has_side_effect(node->left);
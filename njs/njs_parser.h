@@ -163,6 +163,7 @@ typedef enum {
 #define NJS_TOKEN_FIRST_OBJECT     NJS_TOKEN_MATH
 
     NJS_TOKEN_MATH,
+    NJS_TOKEN_JSON,
 
     NJS_TOKEN_OBJECT_CONSTRUCTOR,
     NJS_TOKEN_ARRAY_CONSTRUCTOR,
@@ -172,6 +173,9 @@ typedef enum {
     NJS_TOKEN_FUNCTION_CONSTRUCTOR,
     NJS_TOKEN_REGEXP_CONSTRUCTOR,
     NJS_TOKEN_DATE_CONSTRUCTOR,
+    NJS_TOKEN_ARRAY_BUFFER_CONSTRUCTOR,
+    NJS_TOKEN_TYPED_ARRAY_CONSTRUCTOR,
+    NJS_TOKEN_DATA_VIEW_CONSTRUCTOR,
 
 #define NJS_TOKEN_FIRST_FUNCTION   NJS_TOKEN_EVAL
 
@@ -221,6 +225,11 @@ typedef enum {
     ((node)->token == NJS_TOKEN_NAME || (node)->token == NJS_TOKEN_PROPERTY)
 
 
+#define njs_parser_is_constant(node)                                          \
+    ((node)->token >= NJS_TOKEN_FIRST_CONST                                   \
+     && (node)->token <= NJS_TOKEN_LAST_CONST)
+
+
 typedef struct njs_parser_node_s    njs_parser_node_t;
 
 struct njs_parser_node_s {
@@ -303,6 +312,9 @@ struct njs_parser_s {
     /* Parsing Function() or eval(). */
     uint8_t                         runtime;      /* 1 bit */
 
+    /* Generated code changes global variables. */
+    uint8_t                         global_write; /* 1 bit */
+
     size_t                          code_size;
 
     /* Generator. */
@@ -74,6 +74,8 @@ static njs_token_t njs_parser_property_expression(njs_vm_t *vm,
     njs_parser_t *parser, njs_token_t token);
 static njs_token_t njs_parser_property_brackets(njs_vm_t *vm,
     njs_parser_t *parser, njs_token_t token);
+static nxt_int_t njs_parser_constant_fold(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node);
 
 
 static const njs_parser_expression_t
@@ -498,16 +500,16 @@ njs_parser_assignment_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         } else {
             if (node->token == NJS_TOKEN_ASSIGNMENT) {
-                size = sizeof(njs_vmcode_prop_set_t);
+                size = sizeof(njs_vmcode_prop_const_set_t);
 
                 if (njs_parser_has_side_effect(node->right)) {
                     size += 2 * sizeof(njs_vmcode_move_t);
                 }
 
             } else {
-                size = sizeof(njs_vmcode_prop_get_t)
+                size = sizeof(njs_vmcode_prop_const_get_t)
                        + sizeof(njs_vmcode_3addr_t)
-                       + sizeof(njs_vmcode_prop_set_t);
+                       + sizeof(njs_vmcode_prop_const_set_t);
             }
         }
 
@@ -592,6 +594,15 @@ njs_parser_conditional_expression(njs_vm_t *vm, njs_parser_t *parser,
         node->right = parser->node;
         node->right->dest = cond;
 
+        if (njs_parser_is_constant(cond->left)) {
+            /* The branch of a constant condition. */
+            node = njs_is_true(&cond->left->u.value) ? node->left
+                                                     : node->right;
+            node->dest = NULL;
+            parser->node = node;
+            continue;
+        }
+
         parser->node = cond;
         parser->code_size += sizeof(njs_vmcode_cond_jump_t)
                              + sizeof(njs_vmcode_move_t)
@@ -669,6 +680,19 @@ njs_parser_binary_expression(njs_vm_t *vm, njs_parser_t *parser,
         node->right = parser->node;
         node->right->dest = node;
         parser->node = node;
+
+        if (node->left->token == NJS_TOKEN_NAME
+            && njs_parser_has_side_effect(node->right))
+        {
+            /* The variable value is preserved before the right operand. */
+            parser->code_size += sizeof(njs_vmcode_move_t);
+        }
+
+        if (nxt_slow_path(njs_parser_constant_fold(vm, parser, node)
+                          != NXT_OK))
+        {
+            return NJS_TOKEN_ERROR;
+        }
     }
 }
 
@@ -742,8 +766,7 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         node = parser->node;
         num = -node->u.value.data.u.number;
-        node->u.value.data.u.number = num;
-        node->u.value.data.truth = njs_is_number_true(num);
+        njs_number_set(&node->u.value, num);
 
         return next;
     }
@@ -775,10 +798,162 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
     parser->node = node;
     parser->code_size += sizeof(njs_vmcode_2addr_t);
 
+    if (nxt_slow_path(njs_parser_constant_fold(vm, parser, node) != NXT_OK)) {
+        return NJS_TOKEN_ERROR;
+    }
+
     return next;
 }
 
 
+/*
+ * An operation on constant operands is evaluated at compile time by the
+ * same function which evaluates it at run time, so the result is exactly
+ * the same.  The operation is left to run time if the function returns
+ * a trap or an error, e.g. if an operand should be converted to a string.
+ */
+
+static nxt_int_t
+njs_parser_constant_fold(njs_vm_t *vm, njs_parser_t *parser,
+    njs_parser_node_t *node)
+{
+    njs_ret_t          ret;
+    nxt_bool_t         truth;
+    njs_token_t        token;
+    njs_value_t        value, retval, *value2;
+    const njs_value_t  *exception;
+    njs_string_prop_t  string;
+
+    if (!njs_parser_is_constant(node->left)) {
+        return NXT_OK;
+    }
+
+    value2 = NULL;
+
+    switch (node->token) {
+
+    case NJS_TOKEN_LOGICAL_AND:
+    case NJS_TOKEN_LOGICAL_OR:
+        truth = njs_is_true(&node->left->u.value);
+
+        if (truth == (node->token == NJS_TOKEN_LOGICAL_OR)) {
+            node = node->left;
+
+        } else {
+            node = node->right;
+        }
+
+        node->dest = NULL;
+        parser->node = node;
+
+        return NXT_OK;
+
+    case NJS_TOKEN_UNARY_PLUS:
+    case NJS_TOKEN_UNARY_NEGATION:
+    case NJS_TOKEN_LOGICAL_NOT:
+    case NJS_TOKEN_BITWISE_NOT:
+    case NJS_TOKEN_TYPEOF:
+    case NJS_TOKEN_VOID:
+        break;
+
+    case NJS_TOKEN_ADDITION:
+    case NJS_TOKEN_SUBSTRACTION:
+    case NJS_TOKEN_MULTIPLICATION:
+    case NJS_TOKEN_DIVISION:
+    case NJS_TOKEN_REMAINDER:
+    case NJS_TOKEN_LEFT_SHIFT:
+    case NJS_TOKEN_RIGHT_SHIFT:
+    case NJS_TOKEN_UNSIGNED_RIGHT_SHIFT:
+    case NJS_TOKEN_BITWISE_AND:
+    case NJS_TOKEN_BITWISE_XOR:
+    case NJS_TOKEN_BITWISE_OR:
+    case NJS_TOKEN_EQUAL:
+    case NJS_TOKEN_NOT_EQUAL:
+    case NJS_TOKEN_STRICT_EQUAL:
+    case NJS_TOKEN_STRICT_NOT_EQUAL:
+    case NJS_TOKEN_LESS:
+    case NJS_TOKEN_LESS_OR_EQUAL:
+    case NJS_TOKEN_GREATER:
+    case NJS_TOKEN_GREATER_OR_EQUAL:
+        if (!njs_parser_is_constant(node->right)) {
+            return NXT_OK;
+        }
+
+        value2 = &node->right->u.value;
+        break;
+
+    default:
+        return NXT_OK;
+    }
+
+    retval = vm->retval;
+    exception = vm->exception;
+
+    ret = node->u.operation(vm, &node->left->u.value, value2);
+
+    value = vm->retval;
+    vm->retval = retval;
+    vm->exception = exception;
+
+    if (ret <= 0) {
+        return NXT_OK;
+    }
+
+    /*
+     * The "delete" operator distinguishes the "undefined", "NaN",
+     * and "Infinity" constants from values of expressions.
+     */
+
+    switch (value.type) {
+
+    case NJS_NULL:
+        token = NJS_TOKEN_NULL;
+        break;
+
+    case NJS_BOOLEAN:
+        token = NJS_TOKEN_BOOLEAN;
+        break;
+
+    case NJS_NUMBER:
+        if (njs_is_nan(value.data.u.number)
+            || (njs_is_infinity(value.data.u.number)
+                && value.data.u.number > 0.0))
+        {
+            return NXT_OK;
+        }
+
+        token = NJS_TOKEN_NUMBER;
+        break;
+
+    case NJS_STRING:
+        token = NJS_TOKEN_STRING;
+
+        if (value.short_string.size == NJS_STRING_LONG) {
+            /* A concatenation result may be in a buffer with spare space. */
+            (void) njs_string_prop(&string, &value);
+
+            ret = njs_string_new(vm, &value, string.start, string.size,
+                                 string.length);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return NXT_ERROR;
+            }
+        }
+
+        break;
+
+    default:
+        return NXT_OK;
+    }
+
+    node->token = token;
+    node->u.value = value;
+    node->left = NULL;
+    node->right = NULL;
+
+    return NXT_OK;
+}
+
+
 static njs_token_t
 njs_parser_inc_dec_expression(njs_vm_t *vm, njs_parser_t *parser,
     njs_token_t token)
@@ -829,9 +1004,9 @@ njs_parser_inc_dec_expression(njs_vm_t *vm, njs_parser_t *parser,
 
     parser->code_size += (parser->node->token == NJS_TOKEN_NAME) ?
                              sizeof(njs_vmcode_3addr_t):
-                             sizeof(njs_vmcode_prop_get_t)
+                             sizeof(njs_vmcode_prop_const_get_t)
                              + sizeof(njs_vmcode_3addr_t)
-                             + sizeof(njs_vmcode_prop_set_t);
+                             + sizeof(njs_vmcode_prop_const_set_t);
 
     return next;
 }
@@ -883,9 +1058,9 @@ njs_parser_post_inc_dec_expression(njs_vm_t *vm, njs_parser_t *parser,
 
     parser->code_size += (parser->node->token == NJS_TOKEN_NAME) ?
                              sizeof(njs_vmcode_3addr_t):
-                             sizeof(njs_vmcode_prop_get_t)
+                             sizeof(njs_vmcode_prop_const_get_t)
                              + sizeof(njs_vmcode_3addr_t)
-                             + sizeof(njs_vmcode_prop_set_t);
+                             + sizeof(njs_vmcode_prop_const_set_t);
 
     return njs_parser_token(parser);
 }
@@ -1053,7 +1228,13 @@ njs_parser_property_expression(njs_vm_t *vm, njs_parser_t *parser,
         node->right = parser->node;
         parser->node = node;
 
-        parser->code_size += sizeof(njs_vmcode_prop_get_t);
+        parser->code_size += sizeof(njs_vmcode_prop_const_get_t);
+
+        if (node->left->token == NJS_TOKEN_NAME
+            && njs_parser_has_side_effect(node->right))
+        {
+            parser->code_size += sizeof(njs_vmcode_move_t);
+        }
     }
 }
 
@@ -37,8 +37,16 @@ static void *njs_regexp_malloc(size_t size, void *memory_data);
 static void njs_regexp_free(void *p, void *memory_data);
 static njs_regexp_flags_t njs_regexp_flags(u_char **start, u_char *end,
     nxt_bool_t bound);
-static int njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex,
-    u_char *source, int options);
+static nxt_int_t njs_regexp_cache_test(nxt_lvlhsh_query_t *lhq, void *data);
+static njs_regexp_pattern_t *njs_regexp_pattern_alloc(njs_vm_t *vm,
+    njs_vm_t *owner, u_char *start, size_t length, njs_regexp_flags_t flags);
+static int njs_regexp_pattern_compile(njs_vm_t *vm,
+    nxt_regex_context_t *ctx, nxt_regex_t *regex, u_char *source,
+    int options);
+static nxt_int_t njs_regexp_pattern_jit_compile(njs_vm_t *vm,
+    njs_regexp_pattern_t *pattern);
+static nxt_regex_match_data_t *njs_regexp_match_data(njs_vm_t *vm,
+    njs_regexp_pattern_t *pattern, nxt_regex_t *regex);
 static u_char *njs_regexp_compile_trace_handler(nxt_trace_t *trace,
     nxt_trace_data_t *td, u_char *start);
 static u_char *njs_regexp_match_trace_handler(nxt_trace_t *trace,
@@ -49,9 +57,38 @@ static njs_ret_t njs_regexp_string_create(njs_vm_t *vm, njs_value_t *value,
     u_char *start, uint32_t size, int32_t length);
 
 
+typedef struct {
+    nxt_lvlhsh_query_t    lhq;
+    njs_regexp_flags_t    flags;
+} njs_regexp_cache_query_t;
+
+
+static const nxt_lvlhsh_proto_t  njs_regexp_cache_proto
+    nxt_aligned(64) =
+{
+    NXT_LVLHSH_DEFAULT,
+    0,
+    njs_regexp_cache_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
 njs_ret_t
 njs_regexp_init(njs_vm_t *vm)
 {
+    /* A cloned VM uses the cache of the VM it has been cloned from. */
+
+    if (vm->regexp_cache == NULL) {
+        vm->regexp_cache = nxt_mem_cache_zalloc(vm->mem_cache_pool,
+                                                sizeof(njs_regexp_cache_t));
+        if (nxt_slow_path(vm->regexp_cache == NULL)) {
+            return NXT_ERROR;
+        }
+
+        vm->regexp_cache->vm = vm;
+    }
+
     vm->regex_context = nxt_regex_context_create(njs_regexp_malloc,
                                           njs_regexp_free, vm->mem_cache_pool);
     if (nxt_slow_path(vm->regex_context == NULL)) {
@@ -70,6 +107,16 @@ njs_regexp_init(njs_vm_t *vm)
 }
 
 
+void
+njs_regexp_destroy(njs_vm_t *vm)
+{
+    if (vm->regex_context != NULL) {
+        nxt_regex_context_destroy(vm->regex_context);
+        vm->regex_context = NULL;
+    }
+}
+
+
 static void *
 njs_regexp_malloc(size_t size, void *memory_data)
 {
@@ -270,9 +317,125 @@ invalid:
 }
 
 
+/*
+ * The patterns are looked up in the cache shared by a VM and its clones.
+ * A missing pattern is allocated and compiled by the VM owning the cache,
+ * so it can be used by other clones.  It lives as long as the owner VM,
+ * hence it can be compiled by JIT: njs_vm_destroy() frees the JIT code.
+ * If the cache is full, the pattern is allocated by the VM itself.
+ */
+
 njs_regexp_pattern_t *
 njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
     njs_regexp_flags_t flags)
+{
+    nxt_int_t                 ret;
+    njs_vm_t                  *owner;
+    nxt_bool_t                cached;
+    njs_regexp_cache_t        *cache;
+    njs_regexp_pattern_t      *pattern;
+    njs_regexp_cache_query_t  rq;
+
+    cache = vm->regexp_cache;
+
+    rq.lhq.key_hash = nxt_djb_hash_add(nxt_djb_hash(start, length), flags);
+    rq.lhq.key.length = length;
+    rq.lhq.key.start = start;
+    rq.lhq.proto = &njs_regexp_cache_proto;
+    rq.flags = flags;
+
+    if (nxt_lvlhsh_find(&cache->hash, &rq.lhq) == NXT_OK) {
+        cache->stat.hits++;
+        return rq.lhq.value;
+    }
+
+    cache->stat.misses++;
+
+    cached = (cache->stat.patterns < NJS_REGEXP_CACHE_MAX);
+    owner = cached ? cache->vm : vm;
+
+    if (owner != vm) {
+        /*
+         * The pattern is compiled by the VM itself first, because
+         * a failed compilation would leave garbage in the owner pool.
+         */
+        pattern = njs_regexp_pattern_alloc(vm, vm, start, length, flags);
+        if (nxt_slow_path(pattern == NULL)) {
+            return NULL;
+        }
+
+        nxt_mem_cache_free(vm->mem_cache_pool, pattern);
+    }
+
+    pattern = njs_regexp_pattern_alloc(vm, owner, start, length, flags);
+    if (nxt_slow_path(pattern == NULL)) {
+        return NULL;
+    }
+
+    if (owner == cache->vm) {
+        ret = njs_regexp_pattern_jit_compile(owner, pattern);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+    }
+
+    if (cached) {
+        rq.lhq.replace = 0;
+        rq.lhq.value = pattern;
+        rq.lhq.pool = owner->mem_cache_pool;
+
+        ret = nxt_lvlhsh_insert(&cache->hash, &rq.lhq);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return NULL;
+        }
+
+        cache->stat.patterns++;
+    }
+
+    return pattern;
+}
+
+
+static nxt_int_t
+njs_regexp_cache_test(nxt_lvlhsh_query_t *lhq, void *data)
+{
+    njs_regexp_flags_t        flags;
+    njs_regexp_pattern_t      *pattern;
+    njs_regexp_cache_query_t  *rq;
+
+    pattern = data;
+    rq = (njs_regexp_cache_query_t *) lhq;
+
+    flags = 0;
+
+    if (pattern->global) {
+        flags |= NJS_REGEXP_GLOBAL;
+    }
+
+    if (pattern->ignore_case) {
+        flags |= NJS_REGEXP_IGNORE_CASE;
+    }
+
+    if (pattern->multiline) {
+        flags |= NJS_REGEXP_MULTILINE;
+    }
+
+    /* The source is stored as "/pattern/flags". */
+
+    if (flags == rq->flags
+        && pattern->length == lhq->key.length
+        && memcmp(&pattern->source[1], lhq->key.start, lhq->key.length) == 0)
+    {
+        return NXT_OK;
+    }
+
+    return NXT_DECLINED;
+}
+
+
+static njs_regexp_pattern_t *
+njs_regexp_pattern_alloc(njs_vm_t *vm, njs_vm_t *owner, u_char *start,
+    size_t length, njs_regexp_flags_t flags)
 {
     int                   options, ret;
     u_char                *p, *end;
@@ -284,7 +447,7 @@ njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
     size += ((flags & NJS_REGEXP_IGNORE_CASE) != 0);
     size += ((flags & NJS_REGEXP_MULTILINE) != 0);
 
-    pattern = nxt_mem_cache_zalloc(vm->mem_cache_pool,
+    pattern = nxt_mem_cache_zalloc(owner->mem_cache_pool,
                                    sizeof(njs_regexp_pattern_t)
                                    + 1 + length + size + 1);
     if (nxt_slow_path(pattern == NULL)) {
@@ -292,6 +455,7 @@ njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
     }
 
     pattern->flags = size;
+    pattern->length = length;
     pattern->next = NULL;
 
     p = (u_char *) pattern + sizeof(njs_regexp_pattern_t);
@@ -329,26 +493,28 @@ njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
 
     *p++ = '\0';
 
-    ret = njs_regexp_pattern_compile(vm, &pattern->regex[0],
-                                     &pattern->source[1], options);
+    ret = njs_regexp_pattern_compile(vm, owner->regex_context,
+                                     &pattern->regex[0], &pattern->source[1],
+                                     options);
     if (nxt_slow_path(ret < 0)) {
         return NULL;
     }
 
     pattern->ncaptures = ret;
 
-    ret = njs_regexp_pattern_compile(vm, &pattern->regex[1],
-                                     &pattern->source[1], options | PCRE_UTF8);
+    ret = njs_regexp_pattern_compile(vm, owner->regex_context,
+                                     &pattern->regex[1], &pattern->source[1],
+                                     options | PCRE_UTF8);
     if (nxt_fast_path(ret >= 0)) {
 
         if (nxt_slow_path((u_int) ret != pattern->ncaptures)) {
             vm->exception = &njs_exception_internal_error;
-            nxt_mem_cache_free(vm->mem_cache_pool, pattern);
+            nxt_mem_cache_free(owner->mem_cache_pool, pattern);
             return NULL;
         }
 
     } else if (ret != NXT_DECLINED) {
-        nxt_mem_cache_free(vm->mem_cache_pool, pattern);
+        nxt_mem_cache_free(owner->mem_cache_pool, pattern);
         return NULL;
     }
 
@@ -358,20 +524,30 @@ njs_regexp_pattern_create(njs_vm_t *vm, u_char *start, size_t length,
 }
 
 
+/*
+ * The regex context may belong to another VM, but the errors are
+ * reported to the trace of the VM which creates the pattern.
+ */
+
 static int
-njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex, u_char *source,
-    int options)
+njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_context_t *ctx,
+    nxt_regex_t *regex, u_char *source, int options)
 {
     nxt_int_t            ret;
+    nxt_trace_t          *trace;
     nxt_trace_handler_t  handler;
 
+    trace = ctx->trace;
+    ctx->trace = &vm->trace;
+
     handler = vm->trace.handler;
     vm->trace.handler = njs_regexp_compile_trace_handler;
 
     /* Zero length means a zero-terminated string. */
-    ret = nxt_regex_compile(regex, source, 0, options, vm->regex_context);
+    ret = nxt_regex_compile(regex, source, 0, options, ctx);
 
     vm->trace.handler = handler;
+    ctx->trace = trace;
 
     if (nxt_fast_path(ret == NXT_OK)) {
         return regex->ncaptures;
@@ -381,6 +557,32 @@ njs_regexp_pattern_compile(njs_vm_t *vm, nxt_regex_t *regex, u_char *source,
 }
 
 
+/*
+ * Only the patterns owned by the script VM are compiled by JIT, because
+ * cloned VMs are usually destroyed with their memory pools and JIT code
+ * is freed only by njs_vm_destroy().
+ */
+
+static nxt_int_t
+njs_regexp_pattern_jit_compile(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
+{
+    nxt_int_t   ret;
+    nxt_uint_t  n;
+
+    for (n = 0; n < 2; n++) {
+        if (nxt_regex_is_valid(&pattern->regex[n])) {
+            ret = nxt_regex_jit_compile(&pattern->regex[n], vm->regex_context);
+
+            if (nxt_slow_path(ret == NXT_ERROR)) {
+                return NXT_ERROR;
+            }
+        }
+    }
+
+    return NXT_OK;
+}
+
+
 static u_char *
 njs_regexp_compile_trace_handler(nxt_trace_t *trace, nxt_trace_data_t *td,
     u_char *start)
@@ -467,6 +669,7 @@ njs_regexp_alloc(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
         nxt_lvlhsh_init(&regexp->object.hash);
         nxt_lvlhsh_init(&regexp->object.shared_hash);
         regexp->object.__proto__ = &vm->prototypes[NJS_PROTOTYPE_REGEXP];
+        regexp->object.shape = NULL;
         regexp->object.shared = 0;
         regexp->last_index = 0;
         regexp->pattern = pattern;
@@ -669,8 +872,7 @@ njs_regexp_prototype_exec(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         string.start += regexp->last_index;
         string.size -= regexp->last_index;
 
-        match_data = nxt_regex_match_data(&pattern->regex[n],
-                                          vm->regex_context);
+        match_data = njs_regexp_match_data(vm, pattern, &pattern->regex[n]);
         if (nxt_slow_path(match_data == NULL)) {
             return NXT_ERROR;
         }
@@ -683,8 +885,6 @@ njs_regexp_prototype_exec(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
         }
 
         if (nxt_slow_path(ret != NGX_REGEX_NOMATCH)) {
-            nxt_regex_match_data_free(match_data, vm->regex_context);
-
             return NXT_ERROR;
         }
     }
@@ -696,6 +896,26 @@ njs_regexp_prototype_exec(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 }
 
 
+static nxt_regex_match_data_t *
+njs_regexp_match_data(njs_vm_t *vm, njs_regexp_pattern_t *pattern,
+    nxt_regex_t *regex)
+{
+    if (vm->match_data != NULL) {
+
+        if (vm->match_data_ncaptures >= pattern->ncaptures) {
+            return vm->match_data;
+        }
+
+        nxt_regex_match_data_free(vm->match_data, vm->regex_context);
+    }
+
+    vm->match_data = nxt_regex_match_data(regex, vm->regex_context);
+    vm->match_data_ncaptures = pattern->ncaptures;
+
+    return vm->match_data;
+}
+
+
 static njs_ret_t
 njs_regexp_exec_result(njs_vm_t *vm, njs_regexp_t *regexp, u_char *string,
     nxt_regex_match_data_t *match_data, nxt_uint_t utf8)
@@ -792,19 +1012,12 @@ njs_regexp_exec_result(njs_vm_t *vm, njs_regexp_t *regexp, u_char *string,
         vm->retval.type = NJS_ARRAY;
         vm->retval.data.truth = 1;
 
-        ret = NXT_OK;
-        goto done;
+        return NXT_OK;
     }
 
 fail:
 
-    ret = NXT_ERROR;
-
-done:
-
-    nxt_regex_match_data_free(match_data, vm->regex_context);
-
-    return ret;
+    return NXT_ERROR;
 }
 
 
@@ -32,7 +32,23 @@ struct njs_regexp_s {
 };
 
 
+/*
+ * The cache does not evict patterns because they may be still used
+ * by RegExp objects of other VMs, so it stops to grow at the limit.
+ */
+#define NJS_REGEXP_CACHE_MAX  512
+
+
+struct njs_regexp_cache_s {
+    nxt_lvlhsh_t             hash;
+    /* The VM whose memory pool and regex context keep the patterns. */
+    njs_vm_t                 *vm;
+    njs_regexp_cache_stat_t  stat;
+};
+
+
 njs_ret_t njs_regexp_init(njs_vm_t *vm);
+void njs_regexp_destroy(njs_vm_t *vm);
 njs_ret_t njs_regexp_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
 nxt_int_t njs_regexp_create(njs_vm_t *vm, njs_value_t *value, u_char *start,
@@ -23,6 +23,8 @@ struct njs_regexp_pattern_s {
      * in flags field.
      */
     u_char                *source;
+    /* The pattern length in the source, used by the patterns cache. */
+    uint32_t              length;
 
 #if (NXT_64BIT)
     uint32_t              ncaptures;
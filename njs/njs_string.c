@@ -33,6 +33,9 @@
 #include <string.h>
 
 
+static njs_string_buffer_t *njs_string_buffer_alloc(njs_vm_t *vm, size_t size);
+static void njs_string_buffer_map(njs_string_buffer_t *buffer, size_t offset,
+    size_t index, size_t size, size_t length);
 static nxt_noinline void njs_string_slice_prop(njs_string_prop_t *string,
     njs_slice_prop_t *slice, njs_value_t *args, nxt_uint_t nargs);
 static nxt_noinline void njs_string_slice_args(njs_slice_prop_t *slice,
@@ -51,6 +54,12 @@ static njs_ret_t njs_string_decode(njs_vm_t *vm, njs_value_t *value,
     const uint32_t *reserve);
 
 
+#define njs_string_map(string)                                                \
+    (((string)->map != NULL) ? (string)->map                                  \
+        : (uint32_t *) nxt_align_ptr((string)->start + (string)->size,        \
+                                     sizeof(uint32_t)))
+
+
 njs_ret_t
 njs_string_create(njs_vm_t *vm, njs_value_t *value, u_char *start, size_t size,
     size_t length)
@@ -255,6 +264,7 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
 
     string->size = size;
     string->length = length;
+    string->map = NULL;
 
     return length;
 }
@@ -270,12 +280,21 @@ njs_string_prop(njs_string_prop_t *string, njs_value_t *value)
 
     if (size != NJS_STRING_LONG) {
         string->start = value->short_string.start;
+        string->map = NULL;
         length = value->short_string.length;
 
     } else {
         string->start = value->data.u.string->start;
         size = value->data.string_size;
         length = value->data.u.string->length;
+
+        if (value->data.external0 != NJS_STRING_BUFFERED) {
+            string->map = NULL;
+
+        } else {
+            string->map = ((njs_string_buffered_t *) value->data.u.string)
+                                                              ->buffer->map;
+        }
     }
 
     string->size = size;
@@ -285,6 +304,193 @@ njs_string_prop(njs_string_prop_t *string, njs_value_t *value)
 }
 
 
+njs_ret_t
+njs_string_concat(njs_vm_t *vm, njs_value_t *dst, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    u_char                 *start;
+    size_t                 size, length;
+    njs_string_prop_t      string1, string2;
+    njs_string_buffer_t    *buffer;
+    njs_string_buffered_t  *string;
+
+    (void) njs_string_prop(&string1, val1);
+    (void) njs_string_prop(&string2, val2);
+
+    if ((string1.length != 0 || string1.size == 0)
+        && (string2.length != 0 || string2.size == 0))
+    {
+        length = string1.length + string2.length;
+
+    } else {
+        length = 0;
+    }
+
+    size = string1.size + string2.size;
+
+    if (size <= NJS_STRING_SHORT) {
+        /*
+         * The short string is filled in place, njs_string_alloc() is
+         * NXT_MALLOC_LIKE so the compiler may drop stores to its result.
+         */
+        dst->type = NJS_STRING;
+        njs_string_truth(dst, size);
+        dst->short_string.size = size;
+        dst->short_string.length = length;
+
+        start = dst->short_string.start;
+
+        (void) memcpy(start, string1.start, string1.size);
+        (void) memcpy(start + string1.size, string2.start, string2.size);
+
+        return NXT_OK;
+    }
+
+    if (nxt_slow_path(size > NJS_STRING_MAX_LENGTH)) {
+        vm->exception = &njs_exception_range_error;
+        return NXT_ERROR;
+    }
+
+    buffer = NULL;
+
+    if (string1.map != NULL) {
+        buffer = ((njs_string_buffered_t *) val1->data.u.string)->buffer;
+
+        if (string1.start + string1.size == buffer->start + buffer->used
+            && buffer->size - buffer->used >= string2.size)
+        {
+            goto append;
+        }
+    }
+
+    /*
+     * The first concatenation allocates the exact size, the buffer gets
+     * spare space only when a result of concatenation is concatenated again.
+     */
+
+    if (buffer != NULL) {
+        size = nxt_min(size * 2, NJS_STRING_MAX_LENGTH);
+    }
+
+    buffer = njs_string_buffer_alloc(vm, size);
+    if (nxt_slow_path(buffer == NULL)) {
+        return NXT_ERROR;
+    }
+
+    (void) memcpy(buffer->start, string1.start, string1.size);
+
+    buffer->used = string1.size;
+
+    if (length != 0) {
+        njs_string_buffer_map(buffer, 0, 0, string1.size, string1.length);
+    }
+
+append:
+
+    (void) memcpy(buffer->start + buffer->used, string2.start, string2.size);
+
+    if (length != 0) {
+        njs_string_buffer_map(buffer, buffer->used, string1.length,
+                              string2.size, string2.length);
+    }
+
+    buffer->used += string2.size;
+
+    string = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 sizeof(njs_string_buffered_t));
+    if (nxt_slow_path(string == NULL)) {
+        return NXT_ERROR;
+    }
+
+    string->string.start = buffer->start;
+    string->string.length = length;
+    string->string.retain = 1;
+    string->buffer = buffer;
+
+    size = buffer->used;
+
+    dst->type = NJS_STRING;
+    njs_string_truth(dst, size);
+
+    dst->short_string.size = NJS_STRING_LONG;
+    dst->short_string.length = 0;
+    dst->data.external0 = NJS_STRING_BUFFERED;
+    dst->data.string_size = size;
+    dst->data.u.string = &string->string;
+
+    return NXT_OK;
+}
+
+
+static njs_string_buffer_t *
+njs_string_buffer_alloc(njs_vm_t *vm, size_t size)
+{
+    size_t               map_size;
+    njs_string_buffer_t  *buffer;
+
+    /* A string of the buffer size has at most size / 32 map entries. */
+    map_size = (size / NJS_STRING_MAP_OFFSET) * sizeof(uint32_t);
+
+    buffer = nxt_mem_cache_alloc(vm->mem_cache_pool,
+                                 sizeof(njs_string_buffer_t)
+                                 + nxt_align_size(size, sizeof(uint32_t))
+                                 + map_size);
+
+    if (nxt_fast_path(buffer != NULL)) {
+        buffer->start = (u_char *) buffer + sizeof(njs_string_buffer_t);
+        buffer->map = (uint32_t *) (buffer->start
+                                    + nxt_align_size(size, sizeof(uint32_t)));
+        buffer->size = size;
+        buffer->used = 0;
+    }
+
+    return buffer;
+}
+
+
+/*
+ * njs_string_buffer_map() adds the offset map entries of the valid UTF-8
+ * string part which starts at the offset in the buffer and at the index
+ * in UTF-8 characters.
+ */
+
+static void
+njs_string_buffer_map(njs_string_buffer_t *buffer, size_t offset,
+    size_t index, size_t size, size_t length)
+{
+    size_t        n;
+    const u_char  *p, *end;
+
+    /* The first entry not set yet, there is no entry for the index 0. */
+    n = nxt_max(index + NJS_STRING_MAP_OFFSET - 1, NJS_STRING_MAP_OFFSET)
+        / NJS_STRING_MAP_OFFSET;
+
+    if (size == length) {
+        /* ASCII string. */
+
+        while (n * NJS_STRING_MAP_OFFSET < index + length) {
+            buffer->map[n - 1] = offset + n * NJS_STRING_MAP_OFFSET - index;
+            n++;
+        }
+
+        return;
+    }
+
+    p = buffer->start + offset;
+    end = p + size;
+
+    while (p < end) {
+        if (index == n * NJS_STRING_MAP_OFFSET) {
+            buffer->map[n - 1] = p - buffer->start;
+            n++;
+        }
+
+        p = nxt_utf8_next(p, end);
+        index++;
+    }
+}
+
+
 njs_ret_t
 njs_string_constructor(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
     njs_index_t unused)
@@ -749,7 +955,7 @@ njs_string_prototype_to_bytes(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             /* UTF-8 string. */
             end = string.start + string.size;
 
-            s = njs_string_offset(string.start, end, slice.start);
+            s = njs_string_offset(&string, slice.start);
 
             length = slice.length;
 
@@ -999,7 +1205,7 @@ njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
 
         } else {
             /* UTF-8 string. */
-            start = njs_string_offset(start, end, slice->start);
+            start = njs_string_offset(string, slice->start);
 
             /* Evaluate size of the slice in bytes and ajdust length. */
             p = start;
@@ -1055,7 +1261,7 @@ njs_string_prototype_char_code_at(njs_vm_t *vm, njs_value_t *args,
     } else {
         /* UTF-8 string. */
         end = string.start + string.size;
-        start = njs_string_offset(string.start, end, index);
+        start = njs_string_offset(&string, index);
         code = nxt_utf8_decode(&start, end);
     }
 
@@ -1150,11 +1356,19 @@ njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
 }
 
 
+/*
+ * lastIndexOf() returns the last index of a search string which is
+ * less than the second argument.
+ */
+
 static njs_ret_t
 njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused)
 {
-    ssize_t  ret, index, last;
+    size_t             length;
+    ssize_t            index, last;
+    const u_char       *p, *end;
+    njs_string_prop_t  string, search;
 
     index = -1;
 
@@ -1169,19 +1383,65 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
             }
         }
 
-        ret = 0;
+        (void) njs_string_prop(&search, &args[1]);
 
-        for ( ;; ) {
-            ret = njs_string_index_of(vm, &args[0], &args[1], ret);
+        length = njs_string_prop(&string, &args[0]);
 
-            if (ret < 0 || ret >= last) {
-                break;
+        if (last == 0) {
+            goto done;
+        }
+
+        /* The last index where the search string may start. */
+        last = nxt_min((size_t) last - 1, length);
+
+        if (search.size == 0) {
+            index = last;
+            goto done;
+        }
+
+        if (length == 0) {
+            goto done;
+        }
+
+        if (string.size == length) {
+            /* Byte or ASCII string. */
+            end = string.start + nxt_min(last + search.size, string.size);
+
+            p = nxt_memrstrn(string.start, end, search.start, search.size);
+
+            if (p != NULL) {
+                index = p - string.start;
             }
 
-            index = ret++;
+        } else {
+            /* UTF-8 string. */
+            end = string.start + string.size;
+
+            if ((size_t) last < length) {
+                p = njs_string_offset(&string, last) + search.size;
+                end = nxt_min(p, end);
+            }
+
+            for ( ;; ) {
+                p = nxt_memrstrn(string.start, end, search.start, search.size);
+
+                if (p == NULL) {
+                    break;
+                }
+
+                /* A byte string may match within a UTF-8 character. */
+                if ((*p & 0xC0) != 0x80) {
+                    index = nxt_utf8_length(string.start, p - string.start);
+                    break;
+                }
+
+                end = p + search.size - 1;
+            }
         }
     }
 
+done:
+
     njs_number_set(&vm->retval, index);
 
     return NXT_OK;
@@ -1193,7 +1453,7 @@ njs_string_index_of(njs_vm_t *vm, njs_value_t *src, njs_value_t *search_string,
     size_t index)
 {
     size_t             length;
-    const u_char       *p, *end;
+    const u_char       *p, *end, *start, *found;
     njs_string_prop_t  string, search;
 
     (void) njs_string_prop(&search, search_string);
@@ -1205,32 +1465,34 @@ njs_string_index_of(njs_vm_t *vm, njs_value_t *src, njs_value_t *search_string,
         if (string.size == length) {
             /* Byte or ASCII string. */
             p = string.start + index;
-            end = (string.start + string.size) - (search.size - 1);
+            end = string.start + string.size;
 
-            while (p < end) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    return index;
-                }
+            found = nxt_memstrn(p, end, search.start, search.size);
 
-                index++;
-                p++;
+            if (found != NULL) {
+                return found - string.start;
             }
 
         } else {
             /* UTF-8 string. */
             end = string.start + string.size;
 
-            p = njs_string_offset(string.start, end, index);
+            p = njs_string_offset(&string, index);
+            start = p;
 
-            end -= search.size - 1;
+            for ( ;; ) {
+                found = nxt_memstrn(p, end, search.start, search.size);
 
-            while (p < end) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    return index;
+                if (found == NULL) {
+                    break;
                 }
 
-                index++;
-                p = nxt_utf8_next(p, end);
+                /* A byte string may match within a UTF-8 character. */
+                if ((*found & 0xC0) != 0x80) {
+                    return index + nxt_utf8_length(start, found - start);
+                }
+
+                p = found + 1;
             }
         }
 
@@ -1248,13 +1510,17 @@ njs_string_index_of(njs_vm_t *vm, njs_value_t *src, njs_value_t *search_string,
  */
 
 nxt_noinline const u_char *
-njs_string_offset(const u_char *start, const u_char *end, size_t index)
+njs_string_offset(const njs_string_prop_t *string, size_t index)
 {
-    uint32_t    *map;
-    nxt_uint_t  skip;
+    uint32_t      *map;
+    nxt_uint_t    skip;
+    const u_char  *start, *end;
+
+    start = string->start;
+    end = start + string->size;
 
     if (index >= NJS_STRING_MAP_OFFSET) {
-        map = (uint32_t *) nxt_align_ptr(end, sizeof(uint32_t));
+        map = njs_string_map(string);
 
         start += map[index / NJS_STRING_MAP_OFFSET - 1];
     }
@@ -1287,8 +1553,7 @@ njs_string_index(njs_string_prop_t *string, uint32_t offset)
 
     if (string->length >= NJS_STRING_MAP_OFFSET) {
 
-        end = string->start + string->size;
-        map = (uint32_t *) nxt_align_ptr(end, sizeof(uint32_t));
+        map = njs_string_map(string);
 
         while (index + NJS_STRING_MAP_OFFSET < string->length
                && *map <= offset)
@@ -1713,10 +1978,10 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, nxt_uint_t nargs,
             end = string.start + string.size;
 
             do {
-                for (p = start; p < end; p++) {
-                    if (memcmp(p, split.start, split.size) == 0) {
-                        break;
-                    }
+                p = nxt_memstrn(start, end, split.start, split.size);
+
+                if (p == NULL) {
+                    p = (u_char *) end;
                 }
 
                 next = p + split.size;
@@ -2548,12 +2813,17 @@ njs_value_index(njs_vm_t *vm, njs_parser_t *parser, const njs_value_t *src)
         if (start != (u_char *) src) {
             string = (njs_string_t *) ((u_char *) value + sizeof(njs_value_t));
             value->data.u.string = string;
+            value->data.external0 = 0;
 
             string->start = (u_char *) string + sizeof(njs_string_t);
-            string->length = src->data.u.string->length;
+            string->length = length;
             string->retain = 0xffff;
 
-            memcpy(string->start, start, size);
+            memcpy(string->start, start, lhq.key.length);
+
+            if (lhq.key.length != length && length >= NJS_STRING_MAP_OFFSET) {
+                njs_string_offset_map_init(string->start, lhq.key.length);
+            }
         }
 
         lhq.replace = 0;
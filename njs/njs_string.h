@@ -66,10 +66,40 @@ struct njs_string_s {
 };
 
 
+/*
+ * A long string created by concatenation is stored in a buffer which
+ * may have spare space.  If the first operand of the next concatenation
+ * is the longest string in the buffer, then the second operand is appended
+ * in place, so a string built by repeated "s += x" is copied only when
+ * the buffer grows and the buffer grows geometrically.  Every string in
+ * the buffer is a prefix of the buffer content, so all of them share one
+ * offset map which is stored after the buffer space and is updated
+ * together with the buffer.  The string value is marked by
+ * NJS_STRING_BUFFERED in the data.external0 field.
+ */
+
+#define NJS_STRING_BUFFERED  0x01
+
+typedef struct {
+    u_char               *start;
+    uint32_t             *map;
+    uint32_t             size;
+    uint32_t             used;   /* The size of the longest string. */
+} njs_string_buffer_t;
+
+
+typedef struct {
+    njs_string_t         string;
+    njs_string_buffer_t  *buffer;
+} njs_string_buffered_t;
+
+
 typedef struct {
     size_t    size;
     size_t    length;
     u_char    *start;
+    /* The offset map of a buffered string or NULL if it follows string. */
+    uint32_t  *map;
 } njs_string_prop_t;
 
 
@@ -90,6 +120,8 @@ njs_ret_t njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string,
     njs_value_t *value);
 nxt_noinline size_t njs_string_prop(njs_string_prop_t *string,
     njs_value_t *value);
+njs_ret_t njs_string_concat(njs_vm_t *vm, njs_value_t *dst,
+    njs_value_t *val1, njs_value_t *val2);
 njs_ret_t njs_string_constructor(njs_vm_t *vm, njs_value_t *args,
     nxt_uint_t nargs, njs_index_t unused);
 void njs_string_offset_map_init(const u_char *start, size_t size);
@@ -97,7 +129,7 @@ nxt_bool_t njs_string_eq(const njs_value_t *val1, const njs_value_t *val2);
 nxt_int_t njs_string_cmp(const njs_value_t *val1, const njs_value_t *val2);
 njs_ret_t njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
     const njs_string_prop_t *string, njs_slice_prop_t *slice);
-const u_char *njs_string_offset(const u_char *start, const u_char *end,
+const u_char *njs_string_offset(const njs_string_prop_t *string,
     size_t index);
 nxt_noinline uint32_t njs_string_index(njs_string_prop_t *string,
     uint32_t offset);
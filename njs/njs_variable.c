@@ -155,6 +155,30 @@ njs_parser_variable(njs_vm_t *vm, njs_parser_t *parser, nxt_uint_t *level)
 
 njs_function_t *
 njs_vm_function(njs_vm_t *vm, nxt_str_t *name)
+{
+    njs_index_t  index;
+    njs_value_t  *value;
+
+    index = njs_vm_function_index(vm, name);
+
+    if (nxt_fast_path(index != NJS_INDEX_ERROR)) {
+        value = (njs_value_t *) ((u_char *) vm->global_scope
+                                 + njs_offset(index));
+
+        return value->data.u.function;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * The index of a global function is the same in a VM and in all its
+ * clones, so it can be found once and then used by njs_vm_call_index().
+ */
+
+njs_index_t
+njs_vm_function_index(njs_vm_t *vm, nxt_str_t *name)
 {
     njs_value_t         *value;
     njs_variable_t      *var;
@@ -165,19 +189,19 @@ njs_vm_function(njs_vm_t *vm, nxt_str_t *name)
     lhq.proto = &njs_variables_hash_proto;
 
     if (nxt_slow_path(nxt_lvlhsh_find(&vm->variables_hash, &lhq) != NXT_OK)) {
-        return NULL;
+        return NJS_INDEX_ERROR;
     }
 
     var = lhq.value;
 
     value = (njs_value_t *) ((u_char *) vm->global_scope
-                           + njs_offset(var->index) - NJS_INDEX_GLOBAL_OFFSET);
+                           + njs_offset(var->index));
 
     if (njs_is_function(value)) {
-        return value->data.u.function;
+        return var->index;
     }
 
-    return NULL;
+    return NJS_INDEX_ERROR;
 }
 
 
@@ -216,6 +240,14 @@ njs_variable_value(njs_parser_t *parser, njs_index_t index)
 {
     u_char  *scope;
 
+    /* The global scope values are kept by the outermost parser. */
+
+    if (((uintptr_t) index & NJS_SCOPE_MASK) == NJS_SCOPE_GLOBAL) {
+        while (parser->parent != NULL) {
+            parser = parser->parent;
+        }
+    }
+
     scope = parser->scope_values->start;
 
     return (njs_value_t *) (scope + (njs_offset(index) - parser->scope_offset));
@@ -27,6 +27,7 @@
 #include <njs_variable.h>
 #include <njs_parser.h>
 #include <njs_regexp.h>
+#include <njs_array_buffer.h>
 #include <string.h>
 
 
@@ -35,6 +36,7 @@
 #define NJS_STRING_VALUE           2
 #define NJS_ARRAY_VALUE            3
 #define NJS_EXTERNAL_VALUE         4
+#define NJS_TYPED_ARRAY_VALUE      5
 
 
 /*
@@ -57,27 +59,34 @@ typedef struct {
 } njs_property_query_t;
 
 
-struct njs_property_next_s {
-    int32_t                        index;
-    nxt_lvlhsh_each_t              lhe;
-};
-
-
 /*
  * These functions are forbidden to inline to minimize JavaScript VM
  * interpreter memory footprint.  The size is less than 8K on AMD64
  * and should fit in CPU L1 instruction cache.
  */
 
+static njs_ret_t njs_property_get(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property, njs_property_cache_t *cache,
+    const njs_property_hash_t *key);
+static njs_ret_t njs_property_set(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property, njs_value_t *value, njs_property_cache_t *cache,
+    const njs_property_hash_t *key);
 static nxt_noinline njs_ret_t njs_property_query(njs_vm_t *vm,
-    njs_property_query_t *pq, njs_value_t *object, njs_value_t *property);
+    njs_property_query_t *pq, njs_value_t *object, njs_value_t *property,
+    const njs_property_hash_t *key);
 static njs_ret_t njs_array_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_value_t *object, int32_t index);
+static njs_ret_t njs_typed_array_property_query(njs_vm_t *vm,
+    njs_property_query_t *pq, njs_value_t *object, int32_t index);
 static njs_ret_t njs_object_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_value_t *value, njs_object_t *object);
 static njs_ret_t njs_method_private_copy(njs_vm_t *vm,
     njs_property_query_t *pq);
-static nxt_noinline uint32_t njs_integer_value(double num);
+static njs_ret_t njs_property_cache_find(njs_vm_t *vm,
+    njs_property_cache_t *cache, njs_property_query_t *pq,
+    njs_value_t *object, njs_value_t *property);
+static void njs_property_cache_set(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_property_query_t *pq, njs_value_t *object, njs_value_t *property);
 static nxt_noinline njs_ret_t njs_values_equal(njs_value_t *val1,
     njs_value_t *val2);
 static nxt_noinline njs_ret_t njs_values_compare(njs_value_t *val1,
@@ -112,6 +121,11 @@ static njs_ret_t njs_vmcode_value_to_string(njs_vm_t *vm, njs_value_t *invld1,
 void njs_debug(njs_index_t index, njs_value_t *value);
 
 
+#define njs_value_int32(val)                                                  \
+    (njs_is_int32(val) ? (val)->integer.value                                 \
+                       : (int32_t) njs_integer_value((val)->data.u.number))
+
+
 const njs_value_t  njs_value_null =         njs_value(NJS_NULL, 0, 0.0);
 const njs_value_t  njs_value_void =         njs_value(NJS_VOID, 0, NJS_NAN);
 const njs_value_t  njs_value_false =        njs_value(NJS_BOOLEAN, 0, 0.0);
@@ -152,6 +166,268 @@ const njs_value_t  njs_exception_internal_error =  njs_string("InternalError");
  * values is passed as arguments although they are not always used.
  */
 
+#if (NXT_THREADED_CODE)
+
+/*
+ * The threaded code interpreter does not change the bytecode layout:
+ * an instruction is still identified by its operation handler.  The most
+ * frequent handlers are mapped to labels of inlined code by a small table
+ * indexed by a hash of the handler address and each inlined code ends with
+ * its own indirect jump to the next instruction.  All other instructions
+ * and handlers colliding in the table are executed via the generic path.
+ */
+
+#define NJS_VMCODE_LABELS  64
+
+#define njs_vmcode_label_hash(operation)                                      \
+    ((((uintptr_t) (operation) >> 4) ^ ((uintptr_t) (operation) >> 10))       \
+     & (NJS_VMCODE_LABELS - 1))
+
+
+#define njs_vmcode_dispatch()                                                 \
+    do {                                                                      \
+        vmcode = (njs_vmcode_generic_t *) vm->current;                        \
+        label = &njs_vmcode_labels[njs_vmcode_label_hash(                     \
+                                                   vmcode->code.operation)];  \
+                                                                              \
+        if (nxt_fast_path(label->operation == vmcode->code.operation)) {      \
+            goto *label->code;                                                \
+        }                                                                     \
+                                                                              \
+        goto generic;                                                         \
+    } while (0)
+
+
+typedef struct {
+    njs_vmcode_operation_t     operation;
+    void                       *code;
+} njs_vmcode_label_t;
+
+
+static njs_vmcode_label_t  njs_vmcode_labels[NJS_VMCODE_LABELS];
+
+
+nxt_noinline nxt_int_t
+njs_vmcode_interpreter(njs_vm_t *vm)
+{
+    u_char                  *catch;
+    double                  num;
+    njs_ret_t               ret;
+    nxt_uint_t              i, n;
+    njs_value_t             *retval, *value1, *value2;
+    njs_frame_t             *frame;
+    njs_native_frame_t      *previous;
+    njs_vmcode_move_t       *move;
+    njs_vmcode_label_t      *label;
+    njs_vmcode_generic_t    *vmcode;
+    njs_vmcode_cond_jump_t  *cond_jump;
+
+    static const njs_vmcode_operation_t  operations[] = {
+        njs_vmcode_move,
+        njs_vmcode_addition,
+        njs_vmcode_jump,
+        njs_vmcode_if_true_jump,
+        njs_vmcode_if_false_jump,
+        njs_vmcode_property_get,
+        njs_vmcode_property_set,
+        njs_vmcode_property_const_get,
+        njs_vmcode_property_const_set,
+        njs_vmcode_function_call,
+        njs_vmcode_return,
+    };
+
+    static void *const  codes[] = {
+        &&move,
+        &&addition,
+        &&jump,
+        &&if_true_jump,
+        &&if_false_jump,
+        &&property_get,
+        &&property_set,
+        &&property_const_get,
+        &&property_const_set,
+        &&function_call,
+        &&return_,
+    };
+
+    if (nxt_slow_path(njs_vmcode_labels[0].code == NULL)) {
+
+        for (i = 0; i < NJS_VMCODE_LABELS; i++) {
+            njs_vmcode_labels[i].operation = NULL;
+            njs_vmcode_labels[i].code = &&generic;
+        }
+
+        for (i = 0; i < nxt_nitems(operations); i++) {
+            n = njs_vmcode_label_hash(operations[i]);
+
+            if (njs_vmcode_labels[n].operation == NULL) {
+                njs_vmcode_labels[n].operation = operations[i];
+                njs_vmcode_labels[n].code = codes[i];
+            }
+        }
+    }
+
+start:
+
+    njs_vmcode_dispatch();
+
+generic:
+
+    /* See the comment in the switch based interpreter below. */
+
+    value2 = (njs_value_t *) vmcode->operand1;
+    value1 = NULL;
+
+    switch (vmcode->code.operands) {
+
+    case NJS_VMCODE_3OPERANDS:
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        /* Fall through. */
+
+    case NJS_VMCODE_2OPERANDS:
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    }
+
+    ret = vmcode->code.operation(vm, value1, value2);
+
+result:
+
+    if (nxt_slow_path(ret < 0 && ret >= NJS_PREEMPT)) {
+        goto done;
+    }
+
+    vm->current += ret;
+
+    if (vmcode->code.retval) {
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = vm->retval;
+    }
+
+    njs_vmcode_dispatch();
+
+move:
+
+    move = (njs_vmcode_move_t *) vmcode;
+
+    value1 = njs_vmcode_operand(vm, move->src);
+    vm->retval = *value1;
+    njs_retain(value1);
+
+    retval = njs_vmcode_operand(vm, move->dst);
+    *retval = *value1;
+
+    vm->current += sizeof(njs_vmcode_move_t);
+
+    njs_vmcode_dispatch();
+
+addition:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+    if (nxt_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+        num = value1->data.u.number + value2->data.u.number;
+        njs_number_set(&vm->retval, num);
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = vm->retval;
+
+        vm->current += sizeof(njs_vmcode_3addr_t);
+
+        njs_vmcode_dispatch();
+    }
+
+    ret = njs_vmcode_addition(vm, value1, value2);
+
+    goto result;
+
+jump:
+
+    vm->current += ((njs_vmcode_jump_t *) vmcode)->offset;
+
+    njs_vmcode_dispatch();
+
+if_true_jump:
+
+    cond_jump = (njs_vmcode_cond_jump_t *) vmcode;
+    value1 = njs_vmcode_operand(vm, cond_jump->cond);
+
+    if (njs_is_true(value1)) {
+        vm->current += cond_jump->offset;
+
+    } else {
+        vm->current += sizeof(njs_vmcode_cond_jump_t);
+    }
+
+    njs_vmcode_dispatch();
+
+if_false_jump:
+
+    cond_jump = (njs_vmcode_cond_jump_t *) vmcode;
+    value1 = njs_vmcode_operand(vm, cond_jump->cond);
+
+    if (njs_is_true(value1)) {
+        vm->current += sizeof(njs_vmcode_cond_jump_t);
+
+    } else {
+        vm->current += cond_jump->offset;
+    }
+
+    njs_vmcode_dispatch();
+
+property_get:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+    ret = njs_vmcode_property_get(vm, value1, value2);
+
+    goto result;
+
+property_set:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+    ret = njs_vmcode_property_set(vm, value1, value2);
+
+    goto result;
+
+property_const_get:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+    ret = njs_vmcode_property_const_get(vm, value1, value2);
+
+    goto result;
+
+property_const_set:
+
+    value1 = njs_vmcode_operand(vm, vmcode->operand2);
+    value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+    ret = njs_vmcode_property_const_set(vm, value1, value2);
+
+    goto result;
+
+function_call:
+
+    ret = njs_vmcode_function_call(vm, NULL,
+                                   (njs_value_t *) vmcode->operand1);
+    goto result;
+
+return_:
+
+    ret = njs_vmcode_return(vm, NULL, (njs_value_t *) vmcode->operand1);
+
+    goto result;
+
+done:
+
+#else
+
 nxt_noinline nxt_int_t
 njs_vmcode_interpreter(njs_vm_t *vm)
 {
@@ -221,6 +497,8 @@ njs_vmcode_interpreter(njs_vm_t *vm)
         }
     }
 
+#endif
+
     switch (ret) {
 
     case NJS_TRAP_NUMBER:
@@ -345,9 +623,17 @@ njs_value_release(njs_vm_t *vm, njs_value_t *value)
 njs_ret_t
 njs_vmcode_object(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 {
-    njs_object_t  *object;
+    njs_object_t         *object;
+    njs_vmcode_object_t  *code;
 
-    object = njs_object_alloc(vm);
+    code = (njs_vmcode_object_t *) vm->current;
+
+    if (code->shape != NULL) {
+        object = njs_object_shaped_alloc(vm, code->shape);
+
+    } else {
+        object = njs_object_alloc(vm);
+    }
 
     if (nxt_fast_path(object != NULL)) {
         vm->retval.data.u.object = object;
@@ -364,9 +650,7 @@ njs_vmcode_object(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 njs_ret_t
 njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 {
-    uint32_t            size;
     njs_array_t         *array;
-    njs_value_t         *value;
     njs_vmcode_array_t  *code;
 
     code = (njs_vmcode_array_t *) vm->current;
@@ -374,14 +658,8 @@ njs_vmcode_array(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
     array = njs_array_alloc(vm, code->length, NJS_ARRAY_SPARE);
 
     if (nxt_fast_path(array != NULL)) {
-        size = array->size;
-        value = array->start;
-
-        do {
-            njs_set_invalid(value);
-            value++;
-            size--;
-        } while (size != 0);
+        /* The spare values are already invalid. */
+        njs_array_spare_init(array->start, code->length);
 
         vm->retval.data.u.array = array;
         vm->retval.type = NJS_ARRAY;
@@ -481,6 +759,82 @@ njs_vmcode_object_copy(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 njs_ret_t
 njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
     njs_value_t *property)
+{
+    uint32_t               index;
+    njs_ret_t              ret;
+    njs_array_t            *array;
+    njs_value_t            *value;
+    njs_typed_array_t      *typed_array;
+    njs_vmcode_prop_get_t  *code;
+
+    if (njs_is_int32(property)) {
+        /* A negative index is a large unsigned one here. */
+        index = property->integer.value;
+
+        switch (object->type) {
+
+        case NJS_ARRAY:
+            array = object->data.u.array;
+
+            if (index < array->length) {
+                value = &array->start[index];
+                vm->retval = njs_is_valid(value) ? *value : njs_value_void;
+
+                return sizeof(njs_vmcode_prop_get_t);
+            }
+
+            break;
+
+        case NJS_TYPED_ARRAY:
+            typed_array = object->data.u.typed_array;
+
+            if (index < typed_array->length) {
+                njs_int32_set(&vm->retval, typed_array->start[index]);
+
+                return sizeof(njs_vmcode_prop_get_t);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    code = (njs_vmcode_prop_get_t *) vm->current;
+
+    ret = njs_property_get(vm, object, property, &code->cache, NULL);
+
+    if (nxt_fast_path(ret == NXT_OK)) {
+        return sizeof(njs_vmcode_prop_get_t);
+    }
+
+    return ret;
+}
+
+
+njs_ret_t
+njs_vmcode_property_const_get(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property)
+{
+    njs_ret_t                    ret;
+    njs_vmcode_prop_const_get_t  *code;
+
+    code = (njs_vmcode_prop_const_get_t *) vm->current;
+
+    ret = njs_property_get(vm, object, property, &code->cache, &code->hash);
+
+    if (nxt_fast_path(ret == NXT_OK)) {
+        return sizeof(njs_vmcode_prop_const_get_t);
+    }
+
+    return ret;
+}
+
+
+static njs_ret_t
+njs_property_get(njs_vm_t *vm, njs_value_t *object, njs_value_t *property,
+    njs_property_cache_t *cache, const njs_property_hash_t *key)
 {
     double                num;
     int32_t               index;
@@ -494,9 +848,17 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
     const njs_value_t     *retval;
     njs_property_query_t  pq;
 
-    pq.query = NJS_PROPERTY_QUERY_GET;
+    ret = njs_property_cache_find(vm, cache, &pq, object, property);
 
-    ret = njs_property_query(vm, &pq, object, property);
+    if (ret == NXT_DECLINED) {
+        pq.query = NJS_PROPERTY_QUERY_GET;
+
+        ret = njs_property_query(vm, &pq, object, property, key);
+
+        if (ret == NXT_OK || ret == NJS_EXTERNAL_VALUE) {
+            njs_property_cache_set(vm, cache, &pq, object, property);
+        }
+    }
 
     retval = &njs_value_void;
 
@@ -528,7 +890,7 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
             ret = prop->value.data.u.getter(vm, object);
 
             if (nxt_fast_path(ret == NXT_OK)) {
-                return sizeof(njs_vmcode_prop_get_t);
+                return NXT_OK;
             }
 
             return ret;
@@ -564,7 +926,7 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
 
             if (nxt_fast_path(vm->retval.data.truth != 0)) {
                 /* Non-empty string. */
-                return sizeof(njs_vmcode_prop_get_t);
+                return NXT_OK;
             }
         }
 
@@ -579,12 +941,16 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
 
         break;
 
-    case NJS_EXTERNAL_VALUE:
-        ext = object->data.u.external;
+    case NJS_TYPED_ARRAY_VALUE:
+        if (pq.lhq.value != NULL) {
+            njs_int32_set(&vm->retval, *(u_char *) pq.lhq.value);
+            return NXT_OK;
+        }
 
-        ret = nxt_lvlhsh_find(&ext->hash, &pq.lhq);
+        break;
 
-        if (ret == NXT_OK) {
+    case NJS_EXTERNAL_VALUE:
+        if (pq.lhq.value != NULL) {
             ext = pq.lhq.value;
 
             if ((ext->type & NJS_EXTERN_OBJECT) != 0) {
@@ -595,6 +961,7 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
             data = ext->data;
 
         } else {
+            ext = object->data.u.external;
             data = (uintptr_t) &pq.lhq.key;
         }
 
@@ -609,7 +976,7 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
             /* The vm->retval is already retained by ext->get(). */
         }
 
-        return sizeof(njs_vmcode_prop_get_t);
+        return NXT_OK;
 
     default:
         /* NJS_TRAP_PROPERTY */
@@ -622,29 +989,124 @@ njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
 
     /* GC: njs_retain(retval) */
 
-    return sizeof(njs_vmcode_prop_get_t);
+    return NXT_OK;
 }
 
 
 njs_ret_t
 njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
     njs_value_t *property)
+{
+    uint32_t               index;
+    njs_ret_t              ret;
+    njs_array_t            *array;
+    njs_value_t            *value;
+    njs_typed_array_t      *typed_array;
+    njs_vmcode_prop_set_t  *code;
+
+    code = (njs_vmcode_prop_set_t *) vm->current;
+    value = njs_vmcode_operand(vm, code->value);
+
+    if (njs_is_int32(property)) {
+        index = property->integer.value;
+
+        switch (object->type) {
+
+        case NJS_ARRAY:
+            array = object->data.u.array;
+
+            /*
+             * The spare values are invalid, so a value set inside
+             * the array size just makes the array longer.
+             */
+
+            if (index < array->size) {
+                if (index >= array->length) {
+                    array->length = index + 1;
+                }
+
+                array->start[index] = *value;
+
+                return sizeof(njs_vmcode_prop_set_t);
+            }
+
+            break;
+
+        case NJS_TYPED_ARRAY:
+            typed_array = object->data.u.typed_array;
+
+            if (index < typed_array->length
+                && njs_is_numeric(value)
+                && !typed_array->buffer->read_only)
+            {
+                typed_array->start[index] = njs_typed_array_byte(value);
+
+                return sizeof(njs_vmcode_prop_set_t);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    ret = njs_property_set(vm, object, property, value, &code->cache, NULL);
+
+    if (nxt_fast_path(ret == NXT_OK)) {
+        return sizeof(njs_vmcode_prop_set_t);
+    }
+
+    return ret;
+}
+
+
+njs_ret_t
+njs_vmcode_property_const_set(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property)
+{
+    njs_ret_t                    ret;
+    njs_value_t                  *value;
+    njs_vmcode_prop_const_set_t  *code;
+
+    code = (njs_vmcode_prop_const_set_t *) vm->current;
+    value = njs_vmcode_operand(vm, code->value);
+
+    ret = njs_property_set(vm, object, property, value, &code->cache,
+                           &code->hash);
+
+    if (nxt_fast_path(ret == NXT_OK)) {
+        return sizeof(njs_vmcode_prop_const_set_t);
+    }
+
+    return ret;
+}
+
+
+static njs_ret_t
+njs_property_set(njs_vm_t *vm, njs_value_t *object, njs_value_t *property,
+    njs_value_t *value, njs_property_cache_t *cache,
+    const njs_property_hash_t *key)
 {
     uintptr_t              data;
     nxt_str_t              s;
     njs_ret_t              ret;
-    njs_value_t            *p, *value;
+    njs_value_t            *p;
     njs_extern_t           *ext;
     njs_object_prop_t      *prop;
     njs_property_query_t   pq;
-    njs_vmcode_prop_set_t  *code;
 
-    code = (njs_vmcode_prop_set_t *) vm->current;
-    value = njs_vmcode_operand(vm, code->value);
+    ret = njs_property_cache_find(vm, cache, &pq, object, property);
+
+    if (ret == NXT_DECLINED) {
+        pq.query = NJS_PROPERTY_QUERY_SET;
 
-    pq.query = NJS_PROPERTY_QUERY_SET;
+        ret = njs_property_query(vm, &pq, object, property, key);
 
-    ret = njs_property_query(vm, &pq, object, property);
+        if (ret == NXT_OK || ret == NJS_EXTERNAL_VALUE) {
+            njs_property_cache_set(vm, cache, &pq, object, property);
+        }
+    }
 
     switch (ret) {
 
@@ -653,6 +1115,13 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
         break;
 
     case NXT_DECLINED:
+        if (object->data.u.object->shape != NULL) {
+            ret = njs_object_shape_to_hash(vm, object->data.u.object);
+            if (nxt_slow_path(ret != NXT_OK)) {
+                return ret;
+            }
+        }
+
         prop = njs_object_prop_alloc(vm, &pq.value);
         if (nxt_slow_path(prop == NULL)) {
             return NXT_ERROR;
@@ -668,28 +1137,46 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
             return ret;
         }
 
+        pq.prototype = object->data.u.object;
+        pq.shared = 0;
+
+        njs_property_cache_set(vm, cache, &pq, object, property);
+
         break;
 
     case NJS_PRIMITIVE_VALUE:
     case NJS_STRING_VALUE:
-        return sizeof(njs_vmcode_prop_set_t);
+        return NXT_OK;
 
     case NJS_ARRAY_VALUE:
         p = pq.lhq.value;
         *p = *value;
 
-        return sizeof(njs_vmcode_prop_set_t);
+        return NXT_OK;
 
-    case NJS_EXTERNAL_VALUE:
-        ext = object->data.u.external;
+    case NJS_TYPED_ARRAY_VALUE:
+        if (nxt_slow_path(object->data.u.typed_array->buffer->read_only
+                          || njs_is_object(value)))
+        {
+            vm->exception = &njs_exception_type_error;
+            return NXT_ERROR;
+        }
 
-        ret = nxt_lvlhsh_find(&ext->hash, &pq.lhq);
+        /* Values outside of the typed array are ignored. */
 
-        if (ret == NXT_OK) {
+        if (pq.lhq.value != NULL) {
+            *(u_char *) pq.lhq.value = njs_typed_array_byte(value);
+        }
+
+        return NXT_OK;
+
+    case NJS_EXTERNAL_VALUE:
+        if (pq.lhq.value != NULL) {
             ext = pq.lhq.value;
             data = ext->data;
 
         } else {
+            ext = object->data.u.external;
             data = (uintptr_t) &pq.lhq.key;
         }
 
@@ -707,7 +1194,7 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
             }
         }
 
-        return sizeof(njs_vmcode_prop_set_t);
+        return NXT_OK;
 
     default:
         /* NJS_TRAP_PROPERTY */
@@ -718,7 +1205,7 @@ njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
 
     prop->value = *value;
 
-    return sizeof(njs_vmcode_prop_set_t);
+    return NXT_OK;
 }
 
 
@@ -736,7 +1223,7 @@ njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
 
     pq.query = NJS_PROPERTY_QUERY_IN;
 
-    ret = njs_property_query(vm, &pq, object, property);
+    ret = njs_property_query(vm, &pq, object, property, NULL);
 
     switch (ret) {
 
@@ -762,12 +1249,17 @@ njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *object, njs_value_t *property)
 
         break;
 
+    case NJS_TYPED_ARRAY_VALUE:
+        if (pq.lhq.value != NULL) {
+            retval = &njs_value_true;
+        }
+
+        break;
+
     case NJS_EXTERNAL_VALUE:
         ext = object->data.u.external;
 
-        ret = nxt_lvlhsh_find(&ext->hash, &pq.lhq);
-
-        if (ret == NXT_OK) {
+        if (pq.lhq.value != NULL) {
             retval = &njs_value_true;
 
         } else {
@@ -817,7 +1309,7 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
 
     pq.query = NJS_PROPERTY_QUERY_DELETE;
 
-    ret = njs_property_query(vm, &pq, object, property);
+    ret = njs_property_query(vm, &pq, object, property, NULL);
 
     switch (ret) {
 
@@ -825,10 +1317,20 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
         prop = pq.lhq.value;
 
         if (prop->configurable) {
+
+            if (object->data.u.object->shape != NULL) {
+                ret = njs_object_shape_to_hash(vm, object->data.u.object);
+                if (nxt_slow_path(ret != NXT_OK)) {
+                    return ret;
+                }
+            }
+
             pq.lhq.pool = vm->mem_cache_pool;
 
             (void) nxt_lvlhsh_delete(&object->data.u.object->hash, &pq.lhq);
 
+            njs_property_cache_invalidate(vm);
+
             njs_release(vm, property);
 
             retval = &njs_value_true;
@@ -847,13 +1349,18 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
         retval = &njs_value_true;
         break;
 
-    case NJS_EXTERNAL_VALUE:
+    case NJS_TYPED_ARRAY_VALUE:
+        /* The typed array values cannot be deleted. */
 
-        ext = object->data.u.external;
+        if (pq.lhq.value == NULL) {
+            retval = &njs_value_true;
+        }
 
-        ret = nxt_lvlhsh_find(&ext->hash, &pq.lhq);
+        break;
 
-        if (ret == NXT_OK) {
+    case NJS_EXTERNAL_VALUE:
+
+        if (pq.lhq.value != NULL) {
             ext = pq.lhq.value;
 
             if ((ext->type & NJS_EXTERN_OBJECT) != 0) {
@@ -864,6 +1371,7 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
             }
 
         } else {
+            ext = object->data.u.external;
             data = (uintptr_t) &pq.lhq.key;
         }
 
@@ -902,14 +1410,18 @@ njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
  *                        or boolean value,
  *   NJS_STRING_VALUE     property operation was applied to a string,
  *   NJS_ARRAY_VALUE      object is array,
- *   NJS_EXTERNAL_VALUE   object is external entity,
+ *   NJS_TYPED_ARRAY_VALUE  object is typed array, pq->lhq.value is
+ *                        the value byte or NULL if the index is outside
+ *                        of the typed array,
+ *   NJS_EXTERNAL_VALUE   object is external entity, pq->lhq.value is
+ *                        the found inclusive external entity or NULL,
  *   NJS_TRAP_PROPERTY    the property trap must be called,
  *   NXT_ERROR            exception has been thrown.
  */
 
 static nxt_noinline njs_ret_t
 njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
-    njs_value_t *property)
+    njs_value_t *property, const njs_property_hash_t *key)
 {
     double          num;
     int32_t         index;
@@ -940,8 +1452,42 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
         obj = &vm->prototypes[NJS_PROTOTYPE_STRING];
         break;
 
+    case NJS_TYPED_ARRAY:
+        if (nxt_fast_path(njs_is_int32(property))) {
+            index = property->integer.value;
+
+            if (nxt_fast_path(index >= 0)) {
+                return njs_typed_array_property_query(vm, pq, object, index);
+            }
+
+        } else if (nxt_fast_path(!njs_is_null_or_void_or_boolean(property))) {
+
+            if (nxt_fast_path(njs_is_primitive(property))) {
+                num = njs_value_to_number(property);
+
+            } else {
+                return NJS_TRAP_PROPERTY;
+            }
+
+            index = (int) num;
+
+            if (nxt_fast_path(index >= 0 && (double) index == num)) {
+                return njs_typed_array_property_query(vm, pq, object, index);
+            }
+        }
+
+        obj = object->data.u.object;
+        break;
+
     case NJS_ARRAY:
-        if (nxt_fast_path(!njs_is_null_or_void_or_boolean(property))) {
+        if (nxt_fast_path(njs_is_int32(property))) {
+            index = property->integer.value;
+
+            if (nxt_fast_path(index >= 0)) {
+                return njs_array_property_query(vm, pq, object, index);
+            }
+
+        } else if (nxt_fast_path(!njs_is_null_or_void_or_boolean(property))) {
 
             if (nxt_fast_path(njs_is_primitive(property))) {
                 num = njs_value_to_number(property);
@@ -965,6 +1511,8 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
     case NJS_OBJECT_STRING:
     case NJS_REGEXP:
     case NJS_DATE:
+    case NJS_ARRAY_BUFFER:
+    case NJS_DATA_VIEW:
         obj = object->data.u.object;
         break;
 
@@ -994,7 +1542,14 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
 
     if (nxt_fast_path(njs_is_primitive(property))) {
 
-        ret = njs_primitive_value_to_string(vm, &pq->value, property);
+        if (key != NULL) {
+            /* A constant property name is a string with precomputed hashes. */
+            pq->value = *property;
+            ret = NXT_OK;
+
+        } else {
+            ret = njs_primitive_value_to_string(vm, &pq->value, property);
+        }
 
         if (nxt_fast_path(ret == NXT_OK)) {
 
@@ -1008,11 +1563,26 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *object,
                 pq->lhq.key.start = pq->value.data.u.string->start;
             }
 
-            pq->lhq.key_hash = hash(pq->lhq.key.start, pq->lhq.key.length);
+            if (key != NULL) {
+                pq->lhq.key_hash = (hash == nxt_djb_hash) ? key->hash
+                                                          : key->lowcase_hash;
+
+            } else {
+                pq->lhq.key_hash = hash(pq->lhq.key.start,
+                                        pq->lhq.key.length);
+            }
 
             if (obj == NULL) {
                 pq->lhq.proto = &njs_extern_hash_proto;
 
+                ext = object->data.u.external;
+
+                ret = nxt_lvlhsh_find(&ext->hash, &pq->lhq);
+
+                if (ret != NXT_OK) {
+                    pq->lhq.value = NULL;
+                }
+
                 return NJS_EXTERNAL_VALUE;
             }
 
@@ -1057,6 +1627,21 @@ njs_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
 }
 
 
+static njs_ret_t
+njs_typed_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
+    njs_value_t *object, int32_t index)
+{
+    njs_typed_array_t  *array;
+
+    array = object->data.u.typed_array;
+
+    pq->lhq.value = ((uint32_t) index < array->length) ? &array->start[index]
+                                                       : NULL;
+
+    return NJS_TYPED_ARRAY_VALUE;
+}
+
+
 static njs_ret_t
 njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     njs_value_t *value, njs_object_t *object)
@@ -1069,7 +1654,12 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     do {
         pq->prototype = object;
 
-        ret = nxt_lvlhsh_find(&object->hash, &pq->lhq);
+        if (object->shape != NULL) {
+            ret = njs_object_shape_find(object, &pq->lhq);
+
+        } else {
+            ret = nxt_lvlhsh_find(&object->hash, &pq->lhq);
+        }
 
         if (ret == NXT_OK) {
             prop = pq->lhq.value;
@@ -1100,54 +1690,192 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
                 }
             }
 
-            return ret;
+            return ret;
+        }
+
+        if (pq->query > NJS_PROPERTY_QUERY_IN) {
+            /* NXT_DECLINED */
+            return ret;
+        }
+
+    next:
+
+        object = object->__proto__;
+
+    } while (object != NULL);
+
+    if (njs_is_string(value)) {
+        return NJS_STRING_VALUE;
+    }
+
+    /* NXT_DECLINED */
+
+    return ret;
+}
+
+
+static njs_ret_t
+njs_method_private_copy(njs_vm_t *vm, njs_property_query_t *pq)
+{
+    njs_function_t     *function;
+    njs_object_prop_t  *prop, *shared;
+
+    prop = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_object_prop_t));
+    if (nxt_slow_path(prop == NULL)) {
+        return NXT_ERROR;
+    }
+
+    shared = pq->lhq.value;
+    *prop = *shared;
+
+    function = njs_function_value_copy(vm, &prop->value);
+    if (nxt_slow_path(function == NULL)) {
+        return NXT_ERROR;
+    }
+
+    pq->lhq.replace = 0;
+    pq->lhq.value = prop;
+    pq->lhq.pool = vm->mem_cache_pool;
+
+    return nxt_lvlhsh_insert(&pq->prototype->hash, &pq->lhq);
+}
+
+
+/*
+ * Objects entries of the instructions property caches are valid only
+ * within the VM cache generation.  The generation is unique among all VMs
+ * since the bytecode is shared by cloned VMs and is changed on properties
+ * deletion.  An object entry is created only for a property found in the
+ * object private hash because properties are never replaced in the hash.
+ * Shape entries refer to a slot of any object with the shape and do not
+ * depend on VM since shapes are not changed after creation.  Externals
+ * entries do not depend on VM since externals hashes are not changed after
+ * creation.  Both are created only for short string names, because a long
+ * string value refers to VM memory which may be reused by another clone.
+ */
+
+static uintptr_t  njs_property_cache_generation = NJS_PROPERTY_CACHE_SHAPE;
+
+
+void
+njs_property_cache_invalidate(njs_vm_t *vm)
+{
+    vm->cache_generation = ++njs_property_cache_generation;
+}
+
+
+static njs_ret_t
+njs_property_cache_find(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_property_query_t *pq, njs_value_t *object, njs_value_t *property)
+{
+    njs_object_t  *obj;
+
+    if (njs_is_object(object)) {
+        obj = object->data.u.object;
+
+        if (cache->generation == NJS_PROPERTY_CACHE_SHAPE) {
+
+            if (cache->object != obj->shape
+                || memcmp(cache->key, property, sizeof(njs_value_t)) != 0)
+            {
+                return NXT_DECLINED;
+            }
+
+            pq->lhq.value = &njs_object_slots(obj)[(uintptr_t) cache->value];
+            pq->prototype = obj;
+            pq->shared = 0;
+
+            return NXT_OK;
+        }
+
+        if (cache->object != obj
+            || cache->generation != vm->cache_generation)
+        {
+            return NXT_DECLINED;
         }
 
-        if (pq->query > NJS_PROPERTY_QUERY_IN) {
-            /* NXT_DECLINED */
-            return ret;
+    } else if (njs_is_external(object)) {
+
+        if (cache->object != object->data.u.external
+            || cache->generation != NJS_PROPERTY_CACHE_EXTERNAL)
+        {
+            return NXT_DECLINED;
         }
 
-    next:
+    } else {
+        return NXT_DECLINED;
+    }
 
-        object = object->__proto__;
+    if (memcmp(cache->key, property, sizeof(njs_value_t)) != 0) {
+        return NXT_DECLINED;
+    }
 
-    } while (object != NULL);
+    pq->lhq.value = cache->value;
 
-    if (njs_is_string(value)) {
-        return NJS_STRING_VALUE;
+    if (njs_is_external(object)) {
+        pq->lhq.key.length = property->short_string.size;
+        pq->lhq.key.start = property->short_string.start;
+
+        return NJS_EXTERNAL_VALUE;
     }
 
-    /* NXT_DECLINED */
+    pq->prototype = cache->object;
+    pq->shared = 0;
 
-    return ret;
+    return NXT_OK;
 }
 
 
-static njs_ret_t
-njs_method_private_copy(njs_vm_t *vm, njs_property_query_t *pq)
+static void
+njs_property_cache_set(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_property_query_t *pq, njs_value_t *object, njs_value_t *property)
 {
-    njs_function_t     *function;
-    njs_object_prop_t  *prop, *shared;
+    njs_object_t  *obj;
 
-    prop = nxt_mem_cache_alloc(vm->mem_cache_pool, sizeof(njs_object_prop_t));
-    if (nxt_slow_path(prop == NULL)) {
-        return NXT_ERROR;
-    }
+    if (njs_is_object(object)) {
+        obj = object->data.u.object;
 
-    shared = pq->lhq.value;
-    *prop = *shared;
+        if (pq->shared || pq->prototype != obj) {
+            return;
+        }
 
-    function = njs_function_value_copy(vm, &prop->value);
-    if (nxt_slow_path(function == NULL)) {
-        return NXT_ERROR;
-    }
+        if (obj->shape != NULL) {
 
-    pq->lhq.replace = 0;
-    pq->lhq.value = prop;
-    pq->lhq.pool = vm->mem_cache_pool;
+            if (!njs_is_string(property)
+                || property->short_string.size == NJS_STRING_LONG)
+            {
+                return;
+            }
 
-    return nxt_lvlhsh_insert(&pq->prototype->hash, &pq->lhq);
+            memcpy(cache->key, property, sizeof(njs_value_t));
+            cache->object = obj->shape;
+            cache->value = (void *) ((njs_object_prop_t *) pq->lhq.value
+                                     - njs_object_slots(obj));
+            cache->generation = NJS_PROPERTY_CACHE_SHAPE;
+
+            return;
+        }
+
+        cache->object = obj;
+        cache->generation = vm->cache_generation;
+
+    } else if (njs_is_external(object)) {
+
+        if (!njs_is_string(property)
+            || property->short_string.size == NJS_STRING_LONG)
+        {
+            return;
+        }
+
+        cache->object = object->data.u.external;
+        cache->generation = NJS_PROPERTY_CACHE_EXTERNAL;
+
+    } else {
+        return;
+    }
+
+    memcpy(cache->key, property, sizeof(njs_value_t));
+    cache->value = pq->lhq.value;
 }
 
 
@@ -1160,18 +1888,15 @@ njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
     njs_property_next_t        *next;
     njs_vmcode_prop_foreach_t  *code;
 
-    if (njs_is_object(object)) {
-        next = nxt_mem_cache_alloc(vm->mem_cache_pool,
-                                   sizeof(njs_property_next_t));
-        if (nxt_slow_path(next == NULL)) {
-            return NXT_ERROR;
-        }
-
-        vm->retval.data.u.next = next;
+    code = (njs_vmcode_prop_foreach_t *) vm->current;
+    next = (njs_property_next_t *) njs_vmcode_operand(vm, code->next);
 
+    if (njs_is_object(object)) {
         memset(&next->lhe, 0, sizeof(nxt_lvlhsh_each_t));
         next->lhe.proto = &njs_object_hash_proto;
         next->index = -1;
+        next->slot = 0;
+        next->shape = object->data.u.object->shape;
 
         if (njs_is_array(object) && object->data.u.array->size != 0) {
             next->index = 0;
@@ -1181,15 +1906,13 @@ njs_vmcode_property_foreach(njs_vm_t *vm, njs_value_t *object,
         ext = object->data.u.external;
 
         if (ext->foreach != NULL) {
-            ret = ext->foreach(vm, vm->external[ext->object], &vm->retval);
+            ret = ext->foreach(vm, vm->external[ext->object], next);
             if (nxt_slow_path(ret != NXT_OK)) {
                 return ret;
             }
         }
     }
 
-    code = (njs_vmcode_prop_foreach_t *) vm->current;
-
     return code->offset;
 }
 
@@ -1200,15 +1923,16 @@ njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
     njs_ret_t               ret;
     nxt_uint_t              n;
     njs_array_t             *array;
+    njs_object_t            *obj;
     njs_extern_t            *ext;
-    njs_object_prop_t       *prop;
+    njs_object_prop_t       *prop, *slots;
     njs_property_next_t     *next;
     njs_vmcode_prop_next_t  *code;
 
     code = (njs_vmcode_prop_next_t *) vm->current;
 
     if (njs_is_object(object)) {
-        next = value->data.u.next;
+        next = (njs_property_next_t *) value;
 
         if (next->index >= 0) {
             array = object->data.u.array;
@@ -1226,15 +1950,36 @@ njs_vmcode_property_next(njs_vm_t *vm, njs_value_t *object, njs_value_t *value)
             next->index = -1;
         }
 
-        prop = nxt_lvlhsh_each(&object->data.u.object->hash, &next->lhe);
+        obj = object->data.u.object;
+        slots = njs_object_slots(obj);
 
-        if (prop != NULL) {
-            vm->retval = prop->name;
+        if (obj->shape != NULL && next->slot < obj->shape->items) {
+            vm->retval = slots[next->slot++].name;
 
             return code->offset;
         }
 
-        nxt_mem_cache_free(vm->mem_cache_pool, next);
+        for ( ;; ) {
+            prop = nxt_lvlhsh_each(&obj->hash, &next->lhe);
+
+            if (prop == NULL) {
+                break;
+            }
+
+            /*
+             * The object has left its shape during iteration,
+             * the slots already visited are skipped in the hash.
+             */
+            if (next->shape != NULL
+                && prop >= slots && prop < &slots[next->slot])
+            {
+                continue;
+            }
+
+            vm->retval = prop->name;
+
+            return code->offset;
+        }
 
         vm->retval = njs_value_void;
 
@@ -1334,7 +2079,21 @@ njs_vmcode_instance_of(njs_vm_t *vm, njs_value_t *object,
 njs_ret_t
 njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
 {
-    double  num;
+    double   num;
+    int32_t  n;
+
+    if (nxt_fast_path(njs_is_int32(value)
+                      && value->integer.value != NJS_INT32_MAX))
+    {
+        n = value->integer.value + 1;
+
+        njs_release(vm, reference);
+
+        njs_int32_set(reference, n);
+        vm->retval = *reference;
+
+        return sizeof(njs_vmcode_3addr_t);
+    }
 
     if (nxt_fast_path(njs_is_numeric(value))) {
         num = value->data.u.number + 1.0;
@@ -1354,7 +2113,21 @@ njs_vmcode_increment(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
 njs_ret_t
 njs_vmcode_decrement(njs_vm_t *vm, njs_value_t *reference, njs_value_t *value)
 {
-    double  num;
+    double   num;
+    int32_t  n;
+
+    if (nxt_fast_path(njs_is_int32(value)
+                      && value->integer.value != NJS_INT32_MIN))
+    {
+        n = value->integer.value - 1;
+
+        njs_release(vm, reference);
+
+        njs_int32_set(reference, n);
+        vm->retval = *reference;
+
+        return sizeof(njs_vmcode_3addr_t);
+    }
 
     if (nxt_fast_path(njs_is_numeric(value))) {
         num = value->data.u.number - 1.0;
@@ -1375,7 +2148,21 @@ njs_ret_t
 njs_vmcode_post_increment(njs_vm_t *vm, njs_value_t *reference,
     njs_value_t *value)
 {
-    double  num;
+    double   num;
+    int32_t  n;
+
+    if (nxt_fast_path(njs_is_int32(value)
+                      && value->integer.value != NJS_INT32_MAX))
+    {
+        n = value->integer.value;
+
+        njs_release(vm, reference);
+
+        njs_int32_set(reference, n + 1);
+        njs_int32_set(&vm->retval, n);
+
+        return sizeof(njs_vmcode_3addr_t);
+    }
 
     if (nxt_fast_path(njs_is_numeric(value))) {
         num = value->data.u.number;
@@ -1396,7 +2183,21 @@ njs_ret_t
 njs_vmcode_post_decrement(njs_vm_t *vm, njs_value_t *reference,
     njs_value_t *value)
 {
-    double  num;
+    double   num;
+    int32_t  n;
+
+    if (nxt_fast_path(njs_is_int32(value)
+                      && value->integer.value != NJS_INT32_MIN))
+    {
+        n = value->integer.value;
+
+        njs_release(vm, reference);
+
+        njs_int32_set(reference, n - 1);
+        njs_int32_set(&vm->retval, n);
+
+        return sizeof(njs_vmcode_3addr_t);
+    }
 
     if (nxt_fast_path(njs_is_numeric(value))) {
         num = value->data.u.number;
@@ -1435,6 +2236,11 @@ njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
         &njs_string_object,
         &njs_string_function,
         &njs_string_object,
+        &njs_string_object,
+
+        &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
     };
 
     vm->retval = *types[value->type];
@@ -1492,10 +2298,17 @@ njs_vmcode_unary_negation(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
 njs_ret_t
 njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 {
-    double             num;
-    u_char             *start;
-    size_t             size, length;
-    njs_string_prop_t  string1, string2;
+    double   num;
+    int64_t  n;
+
+    if (nxt_fast_path(njs_is_int32(val1) && njs_is_int32(val2))) {
+        n = (int64_t) val1->integer.value + val2->integer.value;
+
+        if (nxt_fast_path(njs_int64_is_int32(n))) {
+            njs_int32_set(&vm->retval, (int32_t) n);
+            return sizeof(njs_vmcode_3addr_t);
+        }
+    }
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
@@ -1507,33 +2320,12 @@ njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_string(val1) && njs_is_string(val2))) {
 
-        (void) njs_string_prop(&string1, val1);
-        (void) njs_string_prop(&string2, val2);
-
-        if ((string1.length != 0 || string1.size == 0)
-            && (string2.length != 0 || string2.size == 0))
+        if (nxt_slow_path(njs_string_concat(vm, &vm->retval, val1, val2)
+                          != NXT_OK))
         {
-            length = string1.length + string2.length;
-
-        } else {
-            length = 0;
-        }
-
-        size = string1.size + string2.size;
-
-        start = njs_string_alloc(vm, &vm->retval, size, length);
-
-        if (nxt_slow_path(start == NULL)) {
             return NXT_ERROR;
         }
 
-        (void) memcpy(start, string1.start, string1.size);
-        (void) memcpy(start + string1.size, string2.start, string2.size);
-
-        if (length >= NJS_STRING_MAP_OFFSET && size != length) {
-            njs_string_offset_map_init(start, size);
-        }
-
         return sizeof(njs_vmcode_3addr_t);
     }
 
@@ -1544,7 +2336,17 @@ njs_vmcode_addition(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 njs_ret_t
 njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 {
-    double  num;
+    double   num;
+    int64_t  n;
+
+    if (nxt_fast_path(njs_is_int32(val1) && njs_is_int32(val2))) {
+        n = (int64_t) val1->integer.value - val2->integer.value;
+
+        if (nxt_fast_path(njs_int64_is_int32(n))) {
+            njs_int32_set(&vm->retval, (int32_t) n);
+            return sizeof(njs_vmcode_3addr_t);
+        }
+    }
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
@@ -1561,7 +2363,22 @@ njs_vmcode_substraction(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 njs_ret_t
 njs_vmcode_multiplication(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 {
-    double  num;
+    double   num;
+    int64_t  n;
+
+    if (nxt_fast_path(njs_is_int32(val1) && njs_is_int32(val2))) {
+        n = (int64_t) val1->integer.value * val2->integer.value;
+
+        /* A zero product of a negative number is -0. */
+
+        if (nxt_fast_path(njs_int64_is_int32(n)
+                          && (n != 0 || (val1->integer.value
+                                         | val2->integer.value) >= 0)))
+        {
+            njs_int32_set(&vm->retval, (int32_t) n);
+            return sizeof(njs_vmcode_3addr_t);
+        }
+    }
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
@@ -1617,9 +2434,10 @@ njs_vmcode_left_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
-        njs_number_set(&vm->retval, num1 << (num2 & 0x1f));
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
+        njs_int32_set(&vm->retval,
+                      (int32_t) ((uint32_t) num1 << (num2 & 0x1f)));
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1636,9 +2454,9 @@ njs_vmcode_right_shift(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
-        njs_number_set(&vm->retval, num1 >> (num2 & 0x1f));
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
+        njs_int32_set(&vm->retval, num1 >> (num2 & 0x1f));
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1656,8 +2474,8 @@ njs_vmcode_unsigned_right_shift(njs_vm_t *vm, njs_value_t *val1,
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
         njs_number_set(&vm->retval, num1 >> (num2 & 0x1f));
 
         return sizeof(njs_vmcode_3addr_t);
@@ -1723,8 +2541,8 @@ njs_vmcode_bitwise_not(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
     int32_t  num;
 
     if (nxt_fast_path(njs_is_numeric(value))) {
-        num = njs_integer_value(value->data.u.number);
-        njs_number_set(&vm->retval, ~num);
+        num = njs_value_int32(value);
+        njs_int32_set(&vm->retval, ~num);
 
         return sizeof(njs_vmcode_2addr_t);
     }
@@ -1740,9 +2558,9 @@ njs_vmcode_bitwise_and(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
-        njs_number_set(&vm->retval, num1 & num2);
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
+        njs_int32_set(&vm->retval, num1 & num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1758,9 +2576,9 @@ njs_vmcode_bitwise_xor(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
-        njs_number_set(&vm->retval, num1 ^ num2);
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
+        njs_int32_set(&vm->retval, num1 ^ num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1776,9 +2594,9 @@ njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
 
-        num1 = njs_integer_value(val1->data.u.number);
-        num2 = njs_integer_value(val2->data.u.number);
-        njs_number_set(&vm->retval, num1 | num2);
+        num1 = njs_value_int32(val1);
+        num2 = njs_value_int32(val2);
+        njs_int32_set(&vm->retval, num1 | num2);
 
         return sizeof(njs_vmcode_3addr_t);
     }
@@ -1787,7 +2605,7 @@ njs_vmcode_bitwise_or(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 }
 
 
-static nxt_noinline uint32_t
+nxt_noinline uint32_t
 njs_integer_value(double num)
 {
     int64_t  i64;
@@ -1943,6 +2761,10 @@ njs_vmcode_greater_or_equal(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 static nxt_noinline njs_ret_t
 njs_values_compare(njs_value_t *val1, njs_value_t *val2)
 {
+    if (nxt_fast_path(njs_is_int32(val1) && njs_is_int32(val2))) {
+        return (val1->integer.value < val2->integer.value);
+    }
+
     if (nxt_fast_path(njs_is_numeric(val1) || njs_is_numeric(val2))) {
 
         if (nxt_fast_path(njs_is_numeric(val1) && njs_is_numeric(val2))) {
@@ -2128,6 +2950,127 @@ njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 }
 
 
+njs_ret_t
+njs_vmcode_if_not_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    njs_vmcode_equal_jump_t  *jump;
+
+    if (njs_values_strict_equal(val1, val2)) {
+        return sizeof(njs_vmcode_equal_jump_t);
+    }
+
+    jump = (njs_vmcode_equal_jump_t *) vm->current;
+
+    return jump->offset;
+}
+
+
+/*
+ * The compare jumps test a njs_values_compare() result against a mask
+ * of results for which the jump is taken: bit 0 is for not comparable
+ * values, bit 1 is for "greater than or equal" and bit 2 is for "less".
+ * The "greater" and "less or equal" jumps compare the swapped operands,
+ * however, the operands are passed to a trap in the original order, so
+ * they are converted to primitive values from left to right.
+ */
+
+#define NJS_COMPARE_LESS                  0x4
+#define NJS_COMPARE_NOT_LESS              0x3
+#define NJS_COMPARE_GREATER_OR_EQUAL      0x2
+#define NJS_COMPARE_NOT_GREATER_OR_EQUAL  0x5
+
+
+static nxt_noinline njs_ret_t
+njs_vmcode_compare_jump(njs_vm_t *vm, njs_ret_t ret, nxt_uint_t mask)
+{
+    njs_vmcode_compare_jump_t  *jump;
+
+    if (nxt_fast_path(ret >= -1)) {
+
+        if ((1 << (ret + 1)) & mask) {
+            jump = (njs_vmcode_compare_jump_t *) vm->current;
+            return jump->offset;
+        }
+
+        return sizeof(njs_vmcode_compare_jump_t);
+    }
+
+    return ret;
+}
+
+
+njs_ret_t
+njs_vmcode_if_less_jump(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val1, val2),
+                                   NJS_COMPARE_LESS);
+}
+
+
+njs_ret_t
+njs_vmcode_if_not_less_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val1, val2),
+                                   NJS_COMPARE_NOT_LESS);
+}
+
+
+njs_ret_t
+njs_vmcode_if_less_or_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val2, val1),
+                                   NJS_COMPARE_GREATER_OR_EQUAL);
+}
+
+
+njs_ret_t
+njs_vmcode_if_not_less_or_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val2, val1),
+                                   NJS_COMPARE_NOT_GREATER_OR_EQUAL);
+}
+
+
+njs_ret_t
+njs_vmcode_if_greater_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val2, val1),
+                                   NJS_COMPARE_LESS);
+}
+
+
+njs_ret_t
+njs_vmcode_if_not_greater_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val2, val1),
+                                   NJS_COMPARE_NOT_LESS);
+}
+
+
+njs_ret_t
+njs_vmcode_if_greater_or_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val1, val2),
+                                   NJS_COMPARE_GREATER_OR_EQUAL);
+}
+
+
+njs_ret_t
+njs_vmcode_if_not_greater_or_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2)
+{
+    return njs_vmcode_compare_jump(vm, njs_values_compare(val1, val2),
+                                   NJS_COMPARE_NOT_GREATER_OR_EQUAL);
+}
+
+
 njs_ret_t
 njs_vmcode_function_frame(njs_vm_t *vm, njs_value_t *value, njs_value_t *nargs)
 {
@@ -2238,7 +3181,7 @@ njs_vmcode_method_frame(njs_vm_t *vm, njs_value_t *object, njs_value_t *name)
 
     pq.query = NJS_PROPERTY_QUERY_GET;
 
-    switch (njs_property_query(vm, &pq, object, name)) {
+    switch (njs_property_query(vm, &pq, object, name, NULL)) {
 
     case NXT_OK:
         prop = pq.lhq.value;
@@ -3128,11 +4071,18 @@ njs_vmcode_restart(njs_vm_t *vm, njs_value_t *invld1, njs_value_t *invld2)
 
     ret = vmcode->code.operation(vm, value1, &frame->trap_values[1]);
 
-    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    /*
+     * The first operand of an instruction without a result, e.g. of
+     * a property set or a compare jump, must not be overwritten.
+     */
+
+    if (vmcode->code.retval) {
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
 
-    //njs_release(vm, retval);
+        //njs_release(vm, retval);
 
-    *retval = vm->retval;
+        *retval = vm->retval;
+    }
 
     return ret;
 }
@@ -3253,9 +4203,26 @@ njs_vmcode_value_to_string(njs_vm_t *vm, njs_value_t *invld1,
 nxt_noinline void
 njs_number_set(njs_value_t *value, double num)
 {
+    int32_t  i;
+
     value->data.u.number = num;
     value->type = NJS_NUMBER;
     value->data.truth = njs_is_number_true(num);
+
+    /* NaN fails the comparisons. */
+
+    if (num >= -2147483648.0 && num <= 2147483647.0) {
+        i = (int32_t) num;
+
+        if (i == num && (i != 0 || !signbit(num))) {
+            value->integer.tag = 1;
+            value->integer.value = i;
+            return;
+        }
+    }
+
+    value->integer.tag = 0;
+    value->integer.value = 0;
 }
 
 
@@ -3384,6 +4351,29 @@ njs_debug(njs_index_t index, njs_value_t *value)
 }
 
 
+nxt_int_t
+njs_global_scope_copy(njs_vm_t *vm)
+{
+    njs_value_t  *values;
+
+    if (vm->scope_size == 0) {
+        return NXT_OK;
+    }
+
+    values = nxt_mem_cache_align(vm->mem_cache_pool, sizeof(njs_value_t),
+                                 vm->scope_size);
+    if (nxt_slow_path(values == NULL)) {
+        return NXT_ERROR;
+    }
+
+    memcpy(values, vm->global_scope, vm->scope_size);
+
+    vm->scopes[NJS_SCOPE_GLOBAL] = values;
+
+    return NXT_OK;
+}
+
+
 void *
 njs_lvlhsh_alloc(void *data, size_t size, nxt_uint_t nalloc)
 {
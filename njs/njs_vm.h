@@ -86,7 +86,8 @@ typedef enum {
     NJS_INVALID         = 0x07,
 
     /*
-     * The object types have the third bit set.  It is used in njs_is_object().
+     * The object types are greater than or equal to NJS_OBJECT.  It is used
+     * in njs_is_object().
      * NJS_OBJECT_BOOLEAN, NJS_OBJECT_NUMBER, and NJS_OBJECT_STRING must be
      * in the same order as NJS_BOOLEAN, NJS_NUMBER, and NJS_STRING.  It is
      * used in njs_primitive_prototype_index().  The order of object types
@@ -100,6 +101,9 @@ typedef enum {
     NJS_FUNCTION        = 0x0d,
     NJS_REGEXP          = 0x0e,
     NJS_DATE            = 0x0f,
+    NJS_ARRAY_BUFFER    = 0x10,
+    NJS_TYPED_ARRAY     = 0x11,
+    NJS_DATA_VIEW       = 0x12,
 } njs_value_type_t;
 
 
@@ -117,10 +121,14 @@ typedef struct njs_array_s            njs_array_t;
 typedef struct njs_function_lambda_s  njs_function_lambda_t;
 typedef struct njs_regexp_s           njs_regexp_t;
 typedef struct njs_regexp_pattern_s   njs_regexp_pattern_t;
+typedef struct njs_regexp_cache_s     njs_regexp_cache_t;
 typedef struct njs_date_s             njs_date_t;
+typedef struct njs_array_buffer_s     njs_array_buffer_t;
+typedef struct njs_typed_array_s      njs_typed_array_t;
 typedef struct njs_extern_s           njs_extern_t;
 typedef struct njs_native_frame_s     njs_native_frame_t;
 typedef struct njs_property_next_s    njs_property_next_t;
+typedef struct njs_object_shape_s     njs_object_shape_t;
 
 
 typedef struct njs_object_s           njs_object_t;
@@ -135,6 +143,13 @@ struct njs_object_s {
     /* An object __proto__. */
     njs_object_t                      *__proto__;
 
+    /*
+     * A shape of object created by object literal.  The object private
+     * properties are stored in the slots following the object structure
+     * while the shape is set and the private hash is empty.
+     */
+    njs_object_shape_t                *shape;
+
     uint32_t                          shared;  /* 1 bit */
 };
 
@@ -195,7 +210,7 @@ union njs_value_s {
      * the maximum size of short string to 13.
      */
     struct {
-        njs_value_type_t              type:8;  /* 4 bits */
+        njs_value_type_t              type:8;  /* 5 bits */
         /*
          * The truth field is set during value assignment and then can be
          * quickly tested by logical and conditional operations regardless
@@ -205,8 +220,12 @@ union njs_value_s {
          */
         uint8_t                       truth;
 
-        /* 0xff if u.data.string is external string. */
+        /*
+         * 0xff if u.data.string is external string,
+         * NJS_STRING_BUFFERED if it is a string in a concatenation buffer.
+         */
         uint8_t                       external0;
+        /* The integer.tag field of a number. */
         uint8_t                       _spare;
 
         /* A long string size. */
@@ -222,16 +241,17 @@ union njs_value_s {
             njs_function_lambda_t      *lambda;
             njs_regexp_t               *regexp;
             njs_date_t                 *date;
+            njs_array_buffer_t         *array_buffer;
+            njs_typed_array_t          *typed_array;
             njs_getter_t               getter;
             njs_extern_t               *external;
             njs_value_t                *value;
-            njs_property_next_t        *next;
             void                       *data;
         } u;
     } data;
 
     struct {
-        njs_value_type_t              type:8;  /* 4 bits */
+        njs_value_type_t              type:8;  /* 5 bits */
 
 #define NJS_STRING_SHORT              14
 #define NJS_STRING_LONG               15
@@ -242,7 +262,24 @@ union njs_value_s {
         u_char                        start[NJS_STRING_SHORT];
     } short_string;
 
-    njs_value_type_t                  type:8;  /* 4 bits */
+    /*
+     * If a number value is a 32-bit integer, then it is also stored in
+     * the integer.value field and the integer.tag field is set, so
+     * arithmetic, comparison, bitwise, and array index operations can use
+     * the integer without conversion of the double.  The data.u.number
+     * field is always valid, so integers overflow to doubles transparently.
+     * -0 is not an integer.
+     */
+    struct {
+        njs_value_type_t              type:8;  /* 5 bits */
+        uint8_t                       truth;
+        uint8_t                       _spare;
+        uint8_t                       tag;
+        int32_t                       value;
+        double                        number;
+    } integer;
+
+    njs_value_type_t                  type:8;  /* 5 bits */
 };
 
 
@@ -347,6 +384,28 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
     ((value)->type <= NJS_NUMBER)
 
 
+#define njs_is_int32(val)                                                     \
+    ((val)->type == NJS_NUMBER && (val)->integer.tag != 0)
+
+
+#define njs_int32_set(val, num)                                               \
+    do {                                                                      \
+        (val)->integer.type = NJS_NUMBER;                                     \
+        (val)->integer.truth = ((num) != 0);                                  \
+        (val)->integer.tag = 1;                                               \
+        (val)->integer.value = (num);                                         \
+        (val)->integer.number = (num);                                        \
+    } while (0)
+
+
+#define NJS_INT32_MAX  2147483647
+#define NJS_INT32_MIN  (-2147483647 - 1)
+
+
+#define njs_int64_is_int32(n)                                                 \
+    ((n) >= NJS_INT32_MIN && (n) <= NJS_INT32_MAX)
+
+
 #define njs_is_string(value)                                                  \
     ((value)->type == NJS_STRING)
 
@@ -364,7 +423,7 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
 
 
 #define njs_is_object(value)                                                  \
-    (((value)->type & NJS_OBJECT) != 0)
+    ((value)->type >= NJS_OBJECT)
 
 
 #define njs_is_array(value)                                                   \
@@ -383,6 +442,18 @@ typedef njs_ret_t (*njs_vmcode_operation_t)(njs_vm_t *vm, njs_value_t *value1,
     ((value)->type == NJS_DATE)
 
 
+#define njs_is_array_buffer(value)                                            \
+    ((value)->type == NJS_ARRAY_BUFFER)
+
+
+#define njs_is_typed_array(value)                                             \
+    ((value)->type == NJS_TYPED_ARRAY)
+
+
+#define njs_is_data_view(value)                                               \
+    ((value)->type == NJS_DATA_VIEW)
+
+
 #define njs_is_external(value)                                                \
     ((value)->type == NJS_EXTERNAL)
 
@@ -473,6 +544,7 @@ typedef struct {
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                retval;
+    njs_object_shape_t         *shape;
 } njs_vmcode_object_t;
 
 
@@ -525,6 +597,19 @@ typedef struct {
 } njs_vmcode_equal_jump_t;
 
 
+/*
+ * A relational comparison fused with a conditional jump.  The layout
+ * is the same as of njs_vmcode_equal_jump_t.
+ */
+
+typedef struct {
+    njs_vmcode_t               code;
+    njs_ret_t                  offset;
+    njs_index_t                value1;
+    njs_index_t                value2;
+} njs_vmcode_compare_jump_t;
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                retval;
@@ -533,11 +618,40 @@ typedef struct {
 } njs_vmcode_test_jump_t;
 
 
+/*
+ * The property cache of an instruction keeps the last found property.
+ * The property name is compared as raw njs_value_t bits, so the cache
+ * does not depend on alignment of double in the bytecode.  The generation
+ * is NJS_PROPERTY_CACHE_EXTERNAL for externals entries,
+ * NJS_PROPERTY_CACHE_SHAPE for objects shapes entries,
+ * and a VM cache generation for objects.
+ */
+
+typedef struct {
+    uintptr_t                  key[sizeof(njs_value_t) / sizeof(uintptr_t)];
+    void                       *object;
+    void                       *value;
+    uintptr_t                  generation;
+} njs_property_cache_t;
+
+
+#define NJS_PROPERTY_CACHE_EXTERNAL  0
+#define NJS_PROPERTY_CACHE_SHAPE     1
+
+
+#define njs_property_cache_init(cache)                                       \
+    do {                                                                      \
+        (cache)->object = NULL;                                               \
+        (cache)->generation = 0;                                              \
+    } while (0)
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                value;
     njs_index_t                object;
     njs_index_t                property;
+    njs_property_cache_t       cache;
 } njs_vmcode_prop_get_t;
 
 
@@ -546,9 +660,38 @@ typedef struct {
     njs_index_t                value;
     njs_index_t                object;
     njs_index_t                property;
+    njs_property_cache_t       cache;
 } njs_vmcode_prop_set_t;
 
 
+/* Precomputed hashes of a constant property name. */
+
+typedef struct {
+    uint32_t                   hash;
+    uint32_t                   lowcase_hash;
+} njs_property_hash_t;
+
+
+typedef struct {
+    njs_vmcode_t               code;
+    njs_index_t                value;
+    njs_index_t                object;
+    njs_index_t                property;
+    njs_property_cache_t       cache;
+    njs_property_hash_t        hash;
+} njs_vmcode_prop_const_get_t;
+
+
+typedef struct {
+    njs_vmcode_t               code;
+    njs_index_t                value;
+    njs_index_t                object;
+    njs_index_t                property;
+    njs_property_cache_t       cache;
+    njs_property_hash_t        hash;
+} njs_vmcode_prop_const_set_t;
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                next;
@@ -566,6 +709,27 @@ typedef struct {
 } njs_vmcode_prop_next_t;
 
 
+/*
+ * The for-in iterator state is stored in adjacent temporary values of
+ * a frame, so a loop does not allocate memory.  An external object
+ * iterator state is stored at the start of the space.
+ */
+
+struct njs_property_next_s {
+    int32_t                    index;
+
+    /* The object shape and the number of visited slots. */
+    uint32_t                   slot;
+    njs_object_shape_t         *shape;
+
+    nxt_lvlhsh_each_t          lhe;
+};
+
+
+#define NJS_PROPERTY_NEXT_SIZE                                                \
+    nxt_align_size(sizeof(njs_property_next_t), sizeof(njs_value_t))
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                value;
@@ -649,10 +813,11 @@ typedef enum {
     NJS_SCOPE_PARENT_LOCAL,
     NJS_SCOPE_PARENT_ARGUMENTS,
     NJS_SCOPE_PARENT_CLOSURE,
+    NJS_SCOPE_BUILTIN,
 } njs_scope_t;
 
 
-#define NJS_SCOPES             (NJS_SCOPE_PARENT_CLOSURE + 1)
+#define NJS_SCOPES             (NJS_SCOPE_BUILTIN + 1)
 
 #define NJS_SCOPE_SHIFT        4
 #define NJS_SCOPE_MASK         ((uintptr_t) ((1 << NJS_SCOPE_SHIFT) - 1))
@@ -676,7 +841,10 @@ enum njs_prototypes_e {
     NJS_PROTOTYPE_FUNCTION,
     NJS_PROTOTYPE_REGEXP,
     NJS_PROTOTYPE_DATE,
-#define NJS_PROTOTYPE_MAX      (NJS_PROTOTYPE_DATE + 1)
+    NJS_PROTOTYPE_ARRAY_BUFFER,
+    NJS_PROTOTYPE_TYPED_ARRAY,
+    NJS_PROTOTYPE_DATA_VIEW,
+#define NJS_PROTOTYPE_MAX      (NJS_PROTOTYPE_DATA_VIEW + 1)
 };
 
 
@@ -693,13 +861,17 @@ enum njs_constructor_e {
     NJS_CONSTRUCTOR_FUNCTION = NJS_PROTOTYPE_FUNCTION,
     NJS_CONSTRUCTOR_REGEXP =   NJS_PROTOTYPE_REGEXP,
     NJS_CONSTRUCTOR_DATE =     NJS_PROTOTYPE_DATE,
-#define NJS_CONSTRUCTOR_MAX    (NJS_CONSTRUCTOR_DATE + 1)
+    NJS_CONSTRUCTOR_ARRAY_BUFFER = NJS_PROTOTYPE_ARRAY_BUFFER,
+    NJS_CONSTRUCTOR_TYPED_ARRAY =  NJS_PROTOTYPE_TYPED_ARRAY,
+    NJS_CONSTRUCTOR_DATA_VIEW =    NJS_PROTOTYPE_DATA_VIEW,
+#define NJS_CONSTRUCTOR_MAX    (NJS_CONSTRUCTOR_DATA_VIEW + 1)
 };
 
 
 enum njs_object_e {
     NJS_OBJECT_MATH = 0,
-#define NJS_OBJECT_MAX         (NJS_OBJECT_MATH + 1)
+    NJS_OBJECT_JSON,
+#define NJS_OBJECT_MAX         (NJS_OBJECT_JSON + 1)
 };
 
 
@@ -721,22 +893,35 @@ enum njs_function_e {
 #define njs_scope_index(value)                                                \
     ((njs_index_t) ((value) << NJS_SCOPE_SHIFT))
 
-#define njs_global_scope_index(value)                                         \
-    ((njs_index_t) (((value) << NJS_SCOPE_SHIFT) | NJS_SCOPE_GLOBAL))
+/*
+ * The builtin scope contains constructors and the global return value
+ * which are private to each VM, so the global scope of a cloned VM may
+ * be shared with its parent VM until the first write.
+ */
+
+#define njs_builtin_scope_index(value)                                        \
+    ((njs_index_t) (((value) << NJS_SCOPE_SHIFT) | NJS_SCOPE_BUILTIN))
 
 
-#define NJS_INDEX_OBJECT         njs_global_scope_index(NJS_CONSTRUCTOR_OBJECT)
-#define NJS_INDEX_ARRAY          njs_global_scope_index(NJS_CONSTRUCTOR_ARRAY)
-#define NJS_INDEX_BOOLEAN        njs_global_scope_index(NJS_CONSTRUCTOR_BOOLEAN)
-#define NJS_INDEX_NUMBER         njs_global_scope_index(NJS_CONSTRUCTOR_NUMBER)
-#define NJS_INDEX_STRING         njs_global_scope_index(NJS_CONSTRUCTOR_STRING)
+#define NJS_INDEX_OBJECT         njs_builtin_scope_index(NJS_CONSTRUCTOR_OBJECT)
+#define NJS_INDEX_ARRAY          njs_builtin_scope_index(NJS_CONSTRUCTOR_ARRAY)
+#define NJS_INDEX_BOOLEAN                                                     \
+    njs_builtin_scope_index(NJS_CONSTRUCTOR_BOOLEAN)
+#define NJS_INDEX_NUMBER         njs_builtin_scope_index(NJS_CONSTRUCTOR_NUMBER)
+#define NJS_INDEX_STRING         njs_builtin_scope_index(NJS_CONSTRUCTOR_STRING)
 #define NJS_INDEX_FUNCTION                                                    \
-    njs_global_scope_index(NJS_CONSTRUCTOR_FUNCTION)
-#define NJS_INDEX_REGEXP         njs_global_scope_index(NJS_CONSTRUCTOR_REGEXP)
-#define NJS_INDEX_DATE           njs_global_scope_index(NJS_CONSTRUCTOR_DATE)
+    njs_builtin_scope_index(NJS_CONSTRUCTOR_FUNCTION)
+#define NJS_INDEX_REGEXP         njs_builtin_scope_index(NJS_CONSTRUCTOR_REGEXP)
+#define NJS_INDEX_DATE           njs_builtin_scope_index(NJS_CONSTRUCTOR_DATE)
+#define NJS_INDEX_ARRAY_BUFFER                                                \
+    njs_builtin_scope_index(NJS_CONSTRUCTOR_ARRAY_BUFFER)
+#define NJS_INDEX_TYPED_ARRAY                                                 \
+    njs_builtin_scope_index(NJS_CONSTRUCTOR_TYPED_ARRAY)
+#define NJS_INDEX_DATA_VIEW                                                   \
+    njs_builtin_scope_index(NJS_CONSTRUCTOR_DATA_VIEW)
 
-#define NJS_INDEX_GLOBAL_RETVAL  njs_global_scope_index(NJS_CONSTRUCTOR_MAX)
-#define NJS_INDEX_GLOBAL_OFFSET  njs_scope_index(NJS_CONSTRUCTOR_MAX + 1)
+#define NJS_INDEX_GLOBAL_RETVAL  njs_builtin_scope_index(NJS_CONSTRUCTOR_MAX)
+#define NJS_BUILTIN_SCOPE_SIZE   njs_scope_index(NJS_CONSTRUCTOR_MAX + 1)
 
 
 #define njs_offset(index)                                                     \
@@ -753,6 +938,10 @@ enum njs_function_e {
     njs_offset(index)
 
 
+#define njs_global_scope_is_shared(vm)                                        \
+    ((vm)->scopes[NJS_SCOPE_GLOBAL] == (vm)->global_scope)
+
+
 typedef struct {
     const njs_vmcode_1addr_t  *code;
     nxt_bool_t                reference_value;
@@ -800,11 +989,19 @@ struct njs_vm_s {
     njs_parser_t             *parser;
 
     nxt_regex_context_t      *regex_context;
+    /* The compiled patterns shared by a VM and its clones. */
+    njs_regexp_cache_t       *regexp_cache;
     nxt_regex_match_data_t   *single_match_data;
+    /* The match data of RegExp.exec() reused while it has enough captures. */
+    nxt_regex_match_data_t   *match_data;
+    uint32_t                 match_data_ncaptures;
     njs_value_t              empty_regexp;
 
     nxt_array_t              *code;  /* of njs_vm_code_t */
 
+    /* The generation of objects entries of instructions property caches. */
+    uintptr_t                cache_generation;
+
     nxt_trace_t              trace;
     nxt_random_t             random;
 };
@@ -813,6 +1010,9 @@ struct njs_vm_s {
 typedef struct {
     u_char                   *start;
     u_char                   *end;
+    /* The scope size in values: variables and temporaries. */
+    uint32_t                 variables;
+    uint32_t                 temporaries;
 } njs_vm_code_t;
 
 
@@ -835,6 +1035,7 @@ struct njs_vm_shared_s {
 
 
 nxt_int_t njs_vmcode_interpreter(njs_vm_t *vm);
+void njs_property_cache_invalidate(njs_vm_t *vm);
 
 void njs_value_retain(njs_value_t *value);
 void njs_value_release(njs_vm_t *vm, njs_value_t *value);
@@ -854,6 +1055,10 @@ njs_ret_t njs_vmcode_property_get(njs_vm_t *vm, njs_value_t *object,
     njs_value_t *property);
 njs_ret_t njs_vmcode_property_set(njs_vm_t *vm, njs_value_t *object,
     njs_value_t *property);
+njs_ret_t njs_vmcode_property_const_get(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property);
+njs_ret_t njs_vmcode_property_const_set(njs_vm_t *vm, njs_value_t *object,
+    njs_value_t *property);
 njs_ret_t njs_vmcode_property_in(njs_vm_t *vm, njs_value_t *property,
     njs_value_t *object);
 njs_ret_t njs_vmcode_property_delete(njs_vm_t *vm, njs_value_t *object,
@@ -940,6 +1145,24 @@ njs_ret_t njs_vmcode_if_false_jump(njs_vm_t *vm, njs_value_t *cond,
     njs_value_t *offset);
 njs_ret_t njs_vmcode_if_equal_jump(njs_vm_t *vm, njs_value_t *val1,
     njs_value_t *val2);
+njs_ret_t njs_vmcode_if_not_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_less_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_not_less_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_less_or_equal_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_not_less_or_equal_jump(njs_vm_t *vm,
+    njs_value_t *val1, njs_value_t *val2);
+njs_ret_t njs_vmcode_if_greater_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_not_greater_jump(njs_vm_t *vm, njs_value_t *val1,
+    njs_value_t *val2);
+njs_ret_t njs_vmcode_if_greater_or_equal_jump(njs_vm_t *vm,
+    njs_value_t *val1, njs_value_t *val2);
+njs_ret_t njs_vmcode_if_not_greater_or_equal_jump(njs_vm_t *vm,
+    njs_value_t *val1, njs_value_t *val2);
 
 njs_ret_t njs_vmcode_function_frame(njs_vm_t *vm, njs_value_t *value,
     njs_value_t *nargs);
@@ -974,11 +1197,13 @@ njs_ret_t njs_native_function_arguments(njs_vm_t *vm, njs_value_t *args,
 njs_ret_t njs_value_to_ext_string(njs_vm_t *vm, nxt_str_t *dst,
     const njs_value_t *src);
 void njs_number_set(njs_value_t *value, double num);
+nxt_noinline uint32_t njs_integer_value(double num);
 
 void njs_vm_throw_exception(njs_vm_t *vm, u_char *buf, uint32_t size);
 
 nxt_int_t njs_builtin_objects_create(njs_vm_t *vm);
 nxt_int_t njs_builtin_objects_clone(njs_vm_t *vm);
+nxt_int_t njs_global_scope_copy(njs_vm_t *vm);
 
 
 void *njs_lvlhsh_alloc(void *data, size_t size, nxt_uint_t nalloc);
@@ -117,6 +117,8 @@ njs_vm_create(nxt_mem_cache_pool_t *mcp, njs_vm_shared_t **shared,
     if (nxt_fast_path(vm != NULL)) {
         vm->mem_cache_pool = mcp;
 
+        njs_property_cache_invalidate(vm);
+
         ret = njs_regexp_init(vm);
         if (nxt_slow_path(ret != NXT_OK)) {
             return NULL;
@@ -169,6 +171,8 @@ njs_vm_create(nxt_mem_cache_pool_t *mcp, njs_vm_shared_t **shared,
 void
 njs_vm_destroy(njs_vm_t *vm)
 {
+    njs_regexp_destroy(vm);
+
     nxt_mem_cache_pool_destroy(vm->mem_cache_pool);
 }
 
@@ -203,8 +207,6 @@ njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end,
 
     parser->code_size = sizeof(njs_vmcode_stop_t);
     parser->scope = NJS_SCOPE_GLOBAL;
-    parser->scope_offset = NJS_INDEX_GLOBAL_OFFSET;
-    parser->index[NJS_SCOPE_GLOBAL - NJS_INDEX_CACHE] = NJS_INDEX_GLOBAL_OFFSET;
 
     parser->scope_values = nxt_array_create(4, sizeof(njs_value_t),
                                             &njs_array_mem_proto,
@@ -259,7 +261,7 @@ njs_vm_t *
 njs_vm_clone(njs_vm_t *vm, nxt_mem_cache_pool_t *mcp, void **external)
 {
     u_char                *values;
-    size_t                size, scope_size;
+    size_t                size;
     njs_vm_t              *nvm;
     nxt_int_t             ret;
     njs_frame_t           *frame;
@@ -282,6 +284,8 @@ njs_vm_clone(njs_vm_t *vm, nxt_mem_cache_pool_t *mcp, void **external)
     if (nxt_fast_path(nvm != NULL)) {
         nvm->mem_cache_pool = nmcp;
 
+        njs_property_cache_invalidate(nvm);
+
         nvm->shared = vm->shared;
 
         nvm->variables_hash = vm->variables_hash;
@@ -293,11 +297,10 @@ njs_vm_clone(njs_vm_t *vm, nxt_mem_cache_pool_t *mcp, void **external)
         nvm->external = external;
 
         nvm->global_scope = vm->global_scope;
-        scope_size = vm->scope_size;
-        nvm->scope_size = scope_size;
-        scope_size += NJS_INDEX_GLOBAL_OFFSET;
+        nvm->scope_size = vm->scope_size;
 
-        size = NJS_GLOBAL_FRAME_SIZE + scope_size + NJS_FRAME_SPARE_SIZE;
+        size = NJS_GLOBAL_FRAME_SIZE + NJS_BUILTIN_SCOPE_SIZE
+               + NJS_FRAME_SPARE_SIZE;
         size = nxt_align_size(size, NJS_FRAME_SPARE_SIZE);
 
         frame = nxt_mem_cache_align(nmcp, sizeof(njs_value_t), size);
@@ -309,16 +312,24 @@ njs_vm_clone(njs_vm_t *vm, nxt_mem_cache_pool_t *mcp, void **external)
 
         nvm->frame = &frame->native;
 
-        frame->native.free_size = size - (NJS_GLOBAL_FRAME_SIZE + scope_size);
+        frame->native.free_size = size - (NJS_GLOBAL_FRAME_SIZE
+                                          + NJS_BUILTIN_SCOPE_SIZE);
 
         values = (u_char *) frame + NJS_GLOBAL_FRAME_SIZE;
 
-        frame->native.free = values + scope_size;
+        frame->native.free = values + NJS_BUILTIN_SCOPE_SIZE;
         frame->native.first = 1;
 
-        nvm->scopes[NJS_SCOPE_GLOBAL] = (njs_value_t *) values;
-        memcpy(values + NJS_INDEX_GLOBAL_OFFSET, vm->global_scope,
-               vm->scope_size);
+        nvm->scopes[NJS_SCOPE_BUILTIN] = (njs_value_t *) values;
+
+        /*
+         * The global scope is shared with the parent VM and is copied
+         * by njs_global_scope_copy() only before code which may change
+         * global variables is run.
+         */
+        nvm->scopes[NJS_SCOPE_GLOBAL] = vm->global_scope;
+
+        nvm->regexp_cache = vm->regexp_cache;
 
         ret = njs_regexp_init(nvm);
         if (nxt_slow_path(ret != NXT_OK)) {
@@ -389,6 +400,31 @@ njs_vm_call(njs_vm_t *vm, njs_function_t *function, njs_opaque_value_t *args,
 }
 
 
+/*
+ * The index should be obtained by njs_vm_function_index() from the
+ * cloned VM or its parent.  A global variable can be reassigned by the
+ * clone, so the function is taken from the clone's current value.
+ */
+
+nxt_int_t
+njs_vm_call_index(njs_vm_t *vm, njs_index_t index, njs_opaque_value_t *args,
+    nxt_uint_t nargs)
+{
+    njs_value_t  *value;
+
+    value = njs_vmcode_operand(vm, index);
+
+    if (nxt_slow_path(!njs_is_function(value)
+                      || value->data.u.function->native))
+    {
+        vm->exception = &njs_exception_type_error;
+        return NXT_ERROR;
+    }
+
+    return njs_vm_call(vm, value->data.u.function, args, nargs);
+}
+
+
 nxt_int_t
 njs_vm_run(njs_vm_t *vm)
 {
@@ -397,6 +433,13 @@ njs_vm_run(njs_vm_t *vm)
 
     nxt_thread_log_debug("RUN:");
 
+    if (njs_global_scope_is_shared(vm)) {
+        ret = njs_global_scope_copy(vm);
+        if (nxt_slow_path(ret != NXT_OK)) {
+            return ret;
+        }
+    }
+
     ret = njs_vmcode_interpreter(vm);
 
     if (nxt_slow_path(ret == NXT_AGAIN)) {
@@ -457,3 +500,10 @@ njs_vm_exception(njs_vm_t *vm, nxt_str_t *retval)
 {
     return njs_value_to_ext_string(vm, retval, vm->exception);
 }
+
+
+void
+njs_vm_regexp_cache_stat(njs_vm_t *vm, njs_regexp_cache_stat_t *stat)
+{
+    *stat = vm->regexp_cache->stat;
+}
@@ -31,6 +31,11 @@ typedef njs_ret_t (*njs_extern_set_t)(njs_vm_t *vm, void *obj, uintptr_t data,
     nxt_str_t *value);
 typedef njs_ret_t (*njs_extern_find_t)(njs_vm_t *vm, void *obj, uintptr_t data,
     nxt_bool_t delete);
+/*
+ * The foreach callback initializes an iteration state in the memory
+ * pointed by "next", the memory has at least 32 bytes and is passed
+ * then to the next callback.
+ */
 typedef njs_ret_t (*njs_extern_foreach_t)(njs_vm_t *vm, void *obj, void *next);
 typedef njs_ret_t (*njs_extern_next_t)(njs_vm_t *vm, njs_value_t *value,
     void *obj, void *next);
@@ -40,6 +45,14 @@ typedef njs_ret_t (*njs_extern_method_t)(njs_vm_t *vm, njs_value_t *args,
 
 typedef struct njs_external_s       njs_external_t;
 
+
+typedef struct {
+    /* The number of patterns in the cache. */
+    uint32_t                        patterns;
+    uint32_t                        hits;
+    uint32_t                        misses;
+} njs_regexp_cache_stat_t;
+
 struct njs_external_s {
     nxt_str_t                       name;
 
@@ -89,19 +102,26 @@ NXT_EXPORT njs_vm_t *njs_vm_clone(njs_vm_t *vm, nxt_mem_cache_pool_t *mcp,
     void **external);
 NXT_EXPORT nxt_int_t njs_vm_call(njs_vm_t *vm, njs_function_t *function,
     njs_opaque_value_t *args, nxt_uint_t nargs);
+NXT_EXPORT nxt_int_t njs_vm_call_index(njs_vm_t *vm, njs_index_t index,
+    njs_opaque_value_t *args, nxt_uint_t nargs);
 NXT_EXPORT nxt_int_t njs_vm_run(njs_vm_t *vm);
 
 NXT_EXPORT njs_function_t *njs_vm_function(njs_vm_t *vm, nxt_str_t *name);
+NXT_EXPORT njs_index_t njs_vm_function_index(njs_vm_t *vm, nxt_str_t *name);
 NXT_EXPORT njs_ret_t njs_vm_return_string(njs_vm_t *vm, u_char *start,
     size_t size);
 NXT_EXPORT nxt_int_t njs_vm_retval(njs_vm_t *vm, nxt_str_t *retval);
 NXT_EXPORT nxt_int_t njs_vm_exception(njs_vm_t *vm, nxt_str_t *retval);
 
 NXT_EXPORT void njs_disassembler(njs_vm_t *vm);
+NXT_EXPORT void njs_vm_regexp_cache_stat(njs_vm_t *vm,
+    njs_regexp_cache_stat_t *stat);
 
 NXT_EXPORT njs_ret_t njs_string_create(njs_vm_t *vm, njs_value_t *value,
     u_char *start, size_t size, size_t length);
 NXT_EXPORT njs_ret_t njs_void_set(njs_value_t *value);
+NXT_EXPORT njs_ret_t njs_array_buffer_create(njs_vm_t *vm, njs_value_t *value,
+    u_char *start, size_t size);
 
 NXT_EXPORT void *njs_value_data(njs_value_t *value);
 NXT_EXPORT nxt_int_t njs_value_string_copy(njs_vm_t *vm, nxt_str_t *retval,
@@ -91,13 +91,34 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("999999999999999999999"),
       nxt_string("1e+21") },
 
-#if 0
     { nxt_string("9223372036854775808"),
-      nxt_string("9223372036854775808") },
+      nxt_string("9223372036854776000") },
 
     { nxt_string("18446744073709551616"),
       nxt_string("18446744073709552000") },
 
+    { nxt_string("0.1 + 0.2"),
+      nxt_string("0.30000000000000004") },
+
+    { nxt_string("-1/3"),
+      nxt_string("-0.3333333333333333") },
+
+    { nxt_string("Math.pow(10, 20) +' '+ Math.pow(10, 21)"),
+      nxt_string("100000000000000000000 1e+21") },
+
+    { nxt_string("0.000001 +' '+ 0.0000001 +' '+ -0.00000123"),
+      nxt_string("0.000001 1e-7 -0.00000123") },
+
+    { nxt_string("Math.pow(2, -1074) +' '+ Math.pow(2, 1023) * 1.5"),
+      nxt_string("5e-324 1.348269851146737e+308") },
+
+    { nxt_string("-Math.pow(2, 53) - 2"),
+      nxt_string("-9007199254740994") },
+
+    { nxt_string("Number('12345678901234567890') +' '+ Number('123.456')"),
+      nxt_string("12345678901234567000 123.456") },
+
+#if 0
     { nxt_string("1.7976931348623157E+308"),
       nxt_string("1.7976931348623157e+308") },
 #endif
@@ -379,6 +400,23 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("NaN >>> 0"),
       nxt_string("0") },
 
+    /* Integer overflow and -0. */
+
+    { nxt_string("2147483647 + 1 +' '+ (-2147483648 - 1) +' '+ 65536 * 65536"),
+      nxt_string("2147483648 -2147483649 4294967296") },
+
+    { nxt_string("var i = 2147483647, j = -2147483648; i++; --j; i +' '+ j"),
+      nxt_string("2147483648 -2147483649") },
+
+    { nxt_string("var a = 0; 1 / (a * -5) +' '+ 1 / -0 +' '+ (1 << 31)"),
+      nxt_string("-Infinity -Infinity -2147483648") },
+
+    { nxt_string("var x = 0; x--; x++; 1 / x"),
+      nxt_string("Infinity") },
+
+    { nxt_string("var a = [1, 2, 3]; a[-1] = 5; var i = 2; a[-1] + a[i]"),
+      nxt_string("8") },
+
     { nxt_string("!2"),
       nxt_string("false") },
 
@@ -1715,6 +1753,68 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("for (i = 0; i < 10; i++) { i += 1 } i"),
       nxt_string("10") },
 
+    { nxt_string("var a = NaN, s = '';"
+                 "if (a < 1) s += 'a'; if (!(a >= 1)) s += 'b';"
+                 "s += (a <= 1) ? 'c' : 'd'; while (a > 1) s += 'e'; s"),
+      nxt_string("bd") },
+
+    { nxt_string("var s = 'a', n = 0; while (s < 'aaaa') { s += 'a'; n++ } n"),
+      nxt_string("3") },
+
+    { nxt_string("var i = 0; do { i++ } while (i <= 5); i"),
+      nxt_string("6") },
+
+    { nxt_string("var n = 0;"
+                 "for (i = 0; i !== 5; i++) { if (i === 3) n += 10; n++ } n"),
+      nxt_string("15") },
+
+    { nxt_string("var s = '';"
+                 "var a = { valueOf: function() { return 1 } };"
+                 "var b = { valueOf: function() { return 2 } };"
+                 "if (a > b) s += 'T'; else s += 'F';"
+                 "if (a <= b) s += 'T'; while (b < a) s += 'x'; s"),
+      nxt_string("FT") },
+
+    { nxt_string("var o = {}, b = 5;"
+                 "o[{ toString: function() { return 'x' } }] = b; b + o.x"),
+      nxt_string("10") },
+
+    /* Constant folding. */
+
+    { nxt_string("60 * 60 * 24 + (1 << 4) - ~2"),
+      nxt_string("86419") },
+
+    { nxt_string("'a' + 'b' + 1 + (2 > 1) + typeof 1"),
+      nxt_string("ab1truenumber") },
+
+    { nxt_string("var a = 0 && x, b = 1 || x, c = true ? 'y' : x; a + b + c"),
+      nxt_string("1y") },
+
+    { nxt_string("var s = 'a';"
+                 "if (false) s += 'b'; else s += 'c';"
+                 "if (1 == 1) s += 'd'; while (0) s += 'e'; s"),
+      nxt_string("acd") },
+
+    { nxt_string("if (false) { function f() { return 'f' } } f()"),
+      nxt_string("f") },
+
+    { nxt_string("[delete (1/0), delete (0/0), delete (void 0), delete (1+1)]"),
+      nxt_string("true,true,true,true") },
+
+    /* Temporaries. */
+
+    { nxt_string("var a = [], i = 0; a[i] = i++; a[0] + ',' + a[1]"),
+      nxt_string("0,undefined") },
+
+    { nxt_string("var i = 1, a = [5, 6, 7]; [i + i++, a[i--] + i]"),
+      nxt_string("2,8") },
+
+    { nxt_string("var b = 3, a = [1]; a = [a, b, 'c']; a"),
+      nxt_string("1,3,c") },
+
+    { nxt_string("var x, a = [1]; try { a = [2, x.y] } catch (e) {} a"),
+      nxt_string("1") },
+
     /* Factorial. */
 
     { nxt_string("n = 5; f = 1; while (n--) f *= n + 1; f"),
@@ -1941,6 +2041,63 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("x = { a: 1 }; b = delete x.a; x.a +' '+ b"),
       nxt_string("undefined true") },
 
+    { nxt_string("var a = [{x:1}, {x:2}, {y:3}, {x:4}], s = 0;"
+                 "for (i = 0; i < a.length; i++) { s += a[i].x || 0 } s"),
+      nxt_string("7") },
+
+    { nxt_string("var o = {a:1}, r = '';"
+                 "for (i = 0; i < 3; i++)"
+                 "    { r += o.a +' '; delete o.a; if (i == 1) o.a = 5 } r"),
+      nxt_string("1 undefined 5 ") },
+
+    { nxt_string("var o = {}, k = ['a', 'b', 'a'];"
+                 "for (i = 0; i < 3; i++) { o[k[i]] = i } o.a +' '+ o.b"),
+      nxt_string("2 1") },
+
+    { nxt_string("var a = [1, 2], o = {};"
+                 "o['a long property name'] = a['1'];"
+                 "o['a long property name'] += a['0'];"
+                 "o['a long property name']"),
+      nxt_string("3") },
+
+    { nxt_string("function f(v) { return { a: v, b: v + 1 } }"
+                 "var s = 0;"
+                 "for (i = 0; i < 4; i++) { o = f(i); s += o.a * o.b } s"),
+      nxt_string("20") },
+
+    { nxt_string("var o = { a: 1, b: 2, a: 3 }, s = '';"
+                 "for (p in o) { s += p + o[p] } s"),
+      nxt_string("a3b2") },
+
+    { nxt_string("var o = { a: 1, b: 2 }; o.c = 3; delete o.a;"
+                 "o.a +' '+ o.b +' '+ o.c"),
+      nxt_string("undefined 2 3") },
+
+    { nxt_string("var o = { a: 1, b: 2, c: 3 }, s = '';"
+                 "for (p in o) { s += p; if (p == 'a') { o.d = 4; delete o.c } }"
+                 "s"),
+      nxt_string("abd") },
+
+    { nxt_string("function f(o) { var p, q, s = '';"
+                 "    for (p in o) for (q in o) { if (q == 'b') break; s += p + q }"
+                 "    return s }"
+                 "f({ a: 1, b: 2, c: 3 }) + f([1,2])"),
+      nxt_string("aabaca0112") },
+
+    { nxt_string("function f(o, d) { var p, s = '';"
+                 "    for (p in o) { s += p; if (d) s += f(o, d - 1) }"
+                 "    return s }"
+                 "var o = {}; o.x = 1; o.y = 2; f(o, 1)"),
+      nxt_string("xxyyxy") },
+
+    { nxt_string("var o = { toString: function() { return 'x' } }; o + 'y'"),
+      nxt_string("xy") },
+
+    { nxt_string("var o = { a:1, b:2, c:3, d:4, e:5, f:6, g:7, h:8, i:9,"
+                 "          j:10, k:11, l:12, m:13, n:14, o:15, p:16, q:17 };"
+                 "o.a + o.q"),
+      nxt_string("18") },
+
     { nxt_string("delete null"),
       nxt_string("true") },
 
@@ -2127,6 +2284,17 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var a = [,null,undefined,false,true,0,1]; a.join()"),
       nxt_string(",,,false,true,0,1") },
 
+    { nxt_string("[-0,1.5,-2/10000000,Math.pow(10,21),NaN,Infinity,-Infinity]"
+                 ".join(' ')"),
+      nxt_string("0 1.5 -2e-7 1e+21 NaN Infinity -Infinity") },
+
+    { nxt_string("var a = ['α',1,'β',true]; a.join('ζ') + a.join('').length"),
+      nxt_string("αζ1ζβζtrue7") },
+
+    { nxt_string("var a = [1,{},[2,3],'b'];"
+                 "a.join('-') + ' ' + a.join('-').length"),
+      nxt_string("1-[object Object]-2,3-b 23") },
+
     { nxt_string("var o = { toString: function() { return null } };"
                  "[o].join()"),
       nxt_string("null") },
@@ -2267,6 +2435,34 @@ static njs_unit_test_t  njs_test[] =
                  "len +' '+ a +' '+ a.shift()"),
       nxt_string("5 3,4,5,1,2 3") },
 
+    { nxt_string("var a = [1,2,3]; a.pop(); a.pop(); a[3] = 4; a"),
+      nxt_string("1,,,4") },
+
+    { nxt_string("var a = [1,2,3,4]; a.splice(1, 2); a[4] = 5; a"),
+      nxt_string("1,4,,,5") },
+
+    { nxt_string("var a = [1,2,3].filter(function(v) { return v > 1 });"
+                 "a[5] = 1; typeof a[3] +' '+ a.length"),
+      nxt_string("undefined 6") },
+
+    { nxt_string("var a = [], i = 0, s = 0;"
+                 "for (i = 0; i < 1000; i++) { a.push(i); a.shift() }"
+                 "a.push(1, 2); a.length +' '+ a"),
+      nxt_string("2 1,2") },
+
+    { nxt_string("var a = [], i = 0;"
+                 "for (i = 0; i < 100; i++) { a.unshift(i) }"
+                 "a.length +' '+ a[0] +' '+ a[99] +' '+ a.shift() +' '+ a[0]"),
+      nxt_string("100 99 0 99 98") },
+
+    { nxt_string("var a = [1,2], i = 0;"
+                 "for (i = 0; i < 20; i++) { a[i] = a[i] ? a[i] * 2 : i }"
+                 "a[-1] = 7; a[2] +' '+ a[19] +' '+ a.length +' '+ a[-1]"),
+      nxt_string("2 19 20 7") },
+
+    { nxt_string("var a = []; a[2] = 1; a[0] +' '+ a.length"),
+      nxt_string("undefined 3") },
+
     { nxt_string("var a = []; a.splice()"),
       nxt_string("") },
 
@@ -2528,6 +2724,53 @@ static njs_unit_test_t  njs_test[] =
                  "              { a.shift(); return p + v }, 10)"),
       nxt_string("19") },
 
+    { nxt_string("[1,-2,,3].map(Math.abs)"),
+      nxt_string("1,2,,3") },
+
+    { nxt_string("[1,NaN,3,NaN].filter(isNaN).length"),
+      nxt_string("2") },
+
+    { nxt_string("[NaN,NaN].every(isNaN) + ' ' + [1,2,NaN].some(isNaN)"),
+      nxt_string("true true") },
+
+    { nxt_string("['ab','cd'].map(isFinite) + ' '"
+                 "+ ['1.5','2.5'].map(Math.floor)"),
+      nxt_string("false,false 1,2") },
+
+    { nxt_string("[1,2].map(encodeURIComponent) + ' '"
+                 "+ ['10','10','10'].map(parseInt)"),
+      nxt_string("1,2 10,NaN,2") },
+
+    { nxt_string("var o = { valueOf: function() { return 2.5 } };"
+                 "[o, '3.5', 4.5].map(Math.floor)"),
+      nxt_string("2,3,4") },
+
+    { nxt_string("['1','2','3'].filter(isFinite).length + ' '"
+                 "+ ['a','1'].some(isFinite) + ' '"
+                 "+ ['1','a'].every(isFinite)"),
+      nxt_string("3 true false") },
+
+    { nxt_string("[3,1].map(Math.max.bind(null, 2))"),
+      nxt_string("3,2") },
+
+    { nxt_string("var a = [1,2,3];"
+                 "a.map(function(v, i, a, x) { var y; x = x || y || v; y = v;"
+                 "                             return x * 10 + i })"),
+      nxt_string("10,21,32") },
+
+    { nxt_string("var a = [1,2,3], s = 0;"
+                 "a.forEach(function(v) { try { a.forEach(function(w)"
+                 "                                        { s += w }) }"
+                 "                        finally { s += v * 10 } }); s"),
+      nxt_string("78") },
+
+    { nxt_string("var a = [1,2,3], s = 0;"
+                 "try { a.forEach(function(v) { s += v;"
+                 "                              if (v == 2) throw 'x' }) }"
+                 "catch (e) { s += e }"
+                 "a.forEach(function(v) { s += v }); s"),
+      nxt_string("3x123") },
+
     { nxt_string("var a = ['1','2','3','4','5','6']; a.sort()"),
       nxt_string("1,2,3,4,5,6") },
 
@@ -2559,6 +2802,114 @@ static njs_unit_test_t  njs_test[] =
                  "a.sort(function(x, y) { return x - y })"),
       nxt_string("1,") },
 
+    { nxt_string("var a = [10, 9, 1, true, null, 'b', 'a'];"
+                 "a.sort()"),
+      nxt_string("1,10,9,a,b,,true") },
+
+    { nxt_string("var a = [5,1,9,3,7,2,8,4,6,0,15,11,13,12,14,10];"
+                 "a.sort(function(x, y) { return y - x })"),
+      nxt_string("15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0") },
+
+    { nxt_string("var a = [], s = '';"
+                 "for (i = 0; i < 20; i++) { a[i] = { k: i % 3, v: i } }"
+                 "a.sort(function(x, y) { return x.k - y.k });"
+                 "for (i = 0; i < 20; i++) { s += a[i].v + ' ' } s"),
+      nxt_string("0 3 6 9 12 15 18 1 4 7 10 13 16 19 2 5 8 11 14 17 ") },
+
+    { nxt_string("var a = [3,,1,'10',2,,5];"
+                 "a.sort(function(x, y) { return x - y })"),
+      nxt_string("1,2,3,5,10,,") },
+
+    { nxt_string("var a = [3,2,1];"
+                 "a.sort(function(x, y) { a.pop(); return x - y })"),
+      nxt_string("") },
+
+    { nxt_string("var a = [3, undefined, 1];"
+                 "a.sort(function(x, y) { return x - y })"),
+      nxt_string("1,3,") },
+
+    { nxt_string("var a = [3,, undefined, 1]; a.sort();"
+                 "a.length + ' ' + (2 in a) + ' ' + (3 in a) + ' ' + a"),
+      nxt_string("4 true false 1,3,,") },
+
+    { nxt_string("var a = ['b', undefined, 'a'], n = 0;"
+                 "a.sort(function(x, y) {"
+                 "    if (x === undefined || y === undefined) n++;"
+                 "    return x < y ? -1 : 1 });"
+                 "a + ' ' + n"),
+      nxt_string("a,b, 0") },
+
+    /* ArrayBuffer, Uint8Array, DataView. */
+
+    { nxt_string("var a = new Uint8Array(4); a[0] = 257; a[1] = -1;"
+                 "a[5] = 1; a.join()"),
+      nxt_string("1,255,0,0") },
+
+    { nxt_string("var a = new Uint8Array([1,2,3,4]);"
+                 "var b = a.subarray(1, 3); b[0] = 9;"
+                 "a.join() + ' ' + b.length"),
+      nxt_string("1,9,3,4 2") },
+
+    { nxt_string("var a = new Uint8Array([1,2,3,4]);"
+                 "var b = a.slice(2); b[0] = 9; a.join() + ' ' + b"),
+      nxt_string("1,2,3,4 9,4") },
+
+    { nxt_string("var a = new Uint8Array(5); a.fill(7, 1, 3);"
+                 "a.set([5,6], 3); a.join() + ' ' + a.indexOf(6)"),
+      nxt_string("0,7,7,5,6 4") },
+
+    { nxt_string("var b = new ArrayBuffer(8);"
+                 "var a = new Uint8Array(b, 2, 4);"
+                 "a.byteOffset + ' ' + a.length + ' ' + (a.buffer === b)"),
+      nxt_string("2 4 true") },
+
+    { nxt_string("var b = new ArrayBuffer(6); var c = b.slice(1, 4);"
+                 "c.byteLength + ' ' + b.byteLength"),
+      nxt_string("3 6") },
+
+    { nxt_string("new ArrayBuffer(-1)"),
+      nxt_string("RangeError") },
+
+    { nxt_string("var a = new Uint8Array(2); a[0] = '7'; a[1] = true;"
+                 "a.fill({ valueOf: function() { return 5 } }, 1);"
+                 "a.join()"),
+      nxt_string("7,5") },
+
+    { nxt_string("var a = new Uint8Array(2);"
+                 "a[0] = { valueOf: function() { return 5 } }"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array([1, {}])"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array(2); a.set([1, {}])"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array(2);"
+                 "Object.prototype.toString.call(a) + ' '"
+                 "+ ArrayBuffer.isView(a) + ' ' + (a instanceof Uint8Array)"
+                 "+ ' ' + (2 in a) + ' ' + typeof a"),
+      nxt_string("[object Uint8Array] true true false object") },
+
+    { nxt_string("var b = new ArrayBuffer(4); var v = new DataView(b);"
+                 "v.setUint16(0, 258); v.setInt16(2, -2, true);"
+                 "var a = new Uint8Array(b);"
+                 "a.join() + ' ' + v.getInt16(2, true) + ' ' + v.getUint16(2)"),
+      nxt_string("1,2,254,255 -2 65279") },
+
+    { nxt_string("var v = new DataView(new ArrayBuffer(8));"
+                 "v.setFloat64(0, 1.5);"
+                 "v.getFloat64(0) + ' ' + v.getUint8(0) + ' '"
+                 "+ v.getInt32(0, true)"),
+      nxt_string("1.5 63 63551") },
+
+    { nxt_string("var v = new DataView(new ArrayBuffer(2)); v.getUint16(1)"),
+      nxt_string("RangeError") },
+
+    { nxt_string("var v = new DataView(new ArrayBuffer(2));"
+                 "v.getUint8.call(1, 0)"),
+      nxt_string("TypeError") },
+
     /* Strings. */
 
     { nxt_string("var a = '0123456789' + '012345'"
@@ -2670,6 +3021,27 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("a = 'abc' + 1 + 'абв'; a +' '+ a.length"),
       nxt_string("abc1абв 7") },
 
+    { nxt_string("var s = ''; for (i = 0; i < 100; i++) { s += i % 10 }"
+                 "s.length + s[45] + s.charAt(99)"),
+      nxt_string("10059") },
+
+    { nxt_string("var s = ''; for (i = 0; i < 100; i++) { s += 'аб'[i % 2] }"
+                 "s.length + s[65] + s.indexOf('б', 70)"),
+      nxt_string("100б71") },
+
+    { nxt_string("var s = 'ё'; for (i = 0; i < 12; i++) { s += s }"
+                 "s.length +' '+ s.lastIndexOf('ё') +' '+ s.slice(4000, 4002)"),
+      nxt_string("4096 4095 ёё") },
+
+    { nxt_string("var s = 'абвгдежзийклмнопрстуфхцчшщъыьэюя'; s += 'abc';"
+                 "var t = s; s += 'de';"
+                 "t.length +' '+ s.length +' '+ t[33] + s[34] + s.substr(31)"),
+      nxt_string("35 37 bcяabcde") },
+
+    { nxt_string("var s = 'abcdefghijklmnop'; s += 'q'; var t = s + 'x';"
+                 "s += 'y'; s += 'z'; t +' '+ s"),
+      nxt_string("abcdefghijklmnopqx abcdefghijklmnopqyz") },
+
     { nxt_string("a = 1; a.length"),
       nxt_string("undefined") },
 
@@ -2951,6 +3323,26 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("a = $r.host; a.substr(2, 2)"),
       nxt_string("Б") },
 
+    { nxt_string("var a = new Uint8Array($r.buffer);"
+                 "var b = a.slice(); b[0] = 65;"
+                 "a.join() + ' ' + b.join() + ' ' + $r.buffer.byteLength"),
+      nxt_string("97,98,99 65,98,99 3") },
+
+    { nxt_string("var a = new Uint8Array($r.buffer); a[0] = 1"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array($r.buffer); a[5] = 1"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array($r.buffer); a.fill(0)"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var a = new Uint8Array($r.buffer); a.set([1])"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var v = new DataView($r.buffer); v.setUint8(0, 1)"),
+      nxt_string("TypeError") },
+
     { nxt_string("a = $r.header['User-Agent']; a +' '+ a.length +' '+ a"),
       nxt_string("User-Agent|АБВ 17 User-Agent|АБВ") },
 
@@ -2988,6 +3380,10 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("$r.nonexistent"),
       nxt_string("undefined") },
 
+    { nxt_string("var a = '';"
+                 "for (i = 0; i < 2; i++) { a += $r.uri + $r.nonexistent } a"),
+      nxt_string("АБВundefinedАБВundefined") },
+
     { nxt_string("$r.error = 'OK'"),
       nxt_string("OK") },
 
@@ -3096,6 +3492,28 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("'abc abc abc abc'.lastIndexOf('abc', 0)"),
       nxt_string("-1") },
 
+    { nxt_string("'abc'.lastIndexOf('') +' '+ 'abc'.lastIndexOf('', 2) +' '+"
+                 "''.lastIndexOf('')"),
+      nxt_string("3 1 0") },
+
+    { nxt_string("var s = 'x'; for (i = 0; i < 6; i++) { s += s }"
+                 "s += 'abx'; s = s + s;"
+                 "s.indexOf('ab') +' '+ s.indexOf('ab', 67) +' '+"
+                 "s.lastIndexOf('xab') +' '+ s.lastIndexOf('xab', 130)"),
+      nxt_string("64 131 130 63") },
+
+    { nxt_string("var s = 'ё'; for (i = 0; i < 6; i++) { s += s }"
+                 "s += 'жз'; s = s + s;"
+                 "s.indexOf('жз') +' '+ s.indexOf('жз', 67) +' '+"
+                 "s.lastIndexOf('ёжз') +' '+ s.lastIndexOf('ёжз', 129) +' '+"
+                 "s.split('жз').length"),
+      nxt_string("64 130 129 63 3") },
+
+    { nxt_string("var b = 'a²ca²c'.toBytes();"
+                 "b.indexOf('²'.toBytes()) +' '+ b.lastIndexOf('c') +' '+"
+                 "'aβcaβc'.indexOf('²'.toBytes())"),
+      nxt_string("1 5 -1") },
+
     { nxt_string("'ABC'.toLowerCase()"),
       nxt_string("abc") },
 
@@ -3897,6 +4315,34 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var r = /LS/i.exec(false); r[0]"),
       nxt_string("ls") },
 
+    { nxt_string("var a = /(a)(b)(c)(d)?/.exec('abc'), b = /(x)/.exec('yx'),"
+                 "    c = /(.)(.)(.)(.)(.)/.exec('12345');"
+                 "a + ' ' + b + ' ' + c"),
+      nxt_string("abc,a,b,c, x,x 12345,1,2,3,4,5") },
+
+    { nxt_string("var s = '', i = 0;"
+                 "while (i < 3) { s += /(\\d)$/.exec('a' + i)[1]; i++ } s"),
+      nxt_string("012") },
+
+    { nxt_string("new RegExp('(b+)', 'g').exec('abbc')[1]"),
+      nxt_string("bb") },
+
+    /* Literal patterns. */
+
+    { nxt_string("var r = /^\\/api\\//;"
+                 "r.test('/api/v1') +' '+ r.test('/v/api/') +' '+"
+                 "'a,b,,c'.split(/,/).length"),
+      nxt_string("true false 4") },
+
+    { nxt_string("var r = /b$/.exec('abb\\n');"
+                 "r.index +' '+ r[0].length +' '+ /^ab$/.test('ab\\n') +' '+"
+                 "/^ab$/.test('ab\\n\\n') +' '+ /^ab$/m.test('x\\nab\\ny')"),
+      nxt_string("2 1 true false true") },
+
+    { nxt_string("'Cookie: SID=1'.search(/sid=/i) +' '+ 'x.y'.match(/\\./)[0]"
+                 "+' '+ /K/i.test('k') +' '+ /q\\.q/.test('qxq')"),
+      nxt_string("8 . true false") },
+
     { nxt_string("var r = /./; r"),
       nxt_string("/./") },
 
@@ -3915,6 +4361,34 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("var r = new RegExp('abc', 'i'); r.test('00ABC11')"),
       nxt_string("true") },
 
+    { nxt_string("var s = '', i = 0;"
+                 "while (i < 4) {"
+                 "    var r = new RegExp('a(b)?', (i % 2) ? 'gi' : 'm');"
+                 "    s += r + ' ' + r.test('AB') + ' '; i++"
+                 "} s + /a(b)?/ + ' ' + /a(b)?/m.test('AB')"),
+      nxt_string("/a(b)?/m false /a(b)?/gi true /a(b)?/m false "
+                 "/a(b)?/gi true /a(b)?/ false") },
+
+    { nxt_string("var a = new RegExp('ab'), b = new RegExp('ab');"
+                 "a.lastIndex = 1; a === b || b.lastIndex"),
+      nxt_string("0") },
+
+    { nxt_string("var n = 0, i = 0;"
+                 "while (i < 2) {"
+                 "    try { new RegExp('(') } catch (e) { n++ } i++"
+                 "} n"),
+      nxt_string("2") },
+
+    /* "ab/IOb8uF" and "ab" have the same hash. */
+
+    { nxt_string("var a = new RegExp('ab/IOb8uF'), b = new RegExp('ab');"
+                 "b.source + ' ' + b.test('xab') + ' ' + a.source"),
+      nxt_string("ab true ab/IOb8uF") },
+
+    { nxt_string("var a = new RegExp('ab'), b = new RegExp('ab/IOb8uF');"
+                 "b.source + ' ' + b.test('ab/IOb8uF') + ' ' + a.source"),
+      nxt_string("ab/IOb8uF true ab") },
+
     /* Non-standard ECMA-262 features. */
 
     /* 0x10400 is not a surrogate pair of 0xD801 and 0xDC00. */
@@ -4827,7 +5301,7 @@ static njs_unit_test_t  njs_test[] =
     /* Math. */
 
     { nxt_string("Math.PI"),
-      nxt_string("3.14159") },
+      nxt_string("3.141592653589793") },
 
     { nxt_string("Math.abs(5)"),
       nxt_string("5") },
@@ -4879,6 +5353,117 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("Math"),
       nxt_string("[object Object]") },
 
+    { nxt_string("JSON"),
+      nxt_string("[object Object]") },
+
+    { nxt_string("JSON.parse('{\"a\":1, \"b\" : [true, false, null, \"x\"]}')"
+                 ".b"),
+      nxt_string("true,false,,x") },
+
+    { nxt_string("var o = JSON.parse(' { \"a\" : { \"b\" : [1.5e2, -25E-2] } }');"
+                 "o.a.b[0] + o.a.b[1]"),
+      nxt_string("149.75") },
+
+    { nxt_string("JSON.parse('\"\\\\u0061\\\\n\\\\\"\\\\/\"')"),
+      nxt_string("a\n\"/") },
+
+    { nxt_string("JSON.parse('\"\\\\u0430\\\\u0431\"') == '\\u0430\\u0431'"),
+      nxt_string("true") },
+
+    { nxt_string("JSON.parse('\"\\\\ud83d\\\\ude00\"') == '\\u{1F600}'"),
+      nxt_string("true") },
+
+    { nxt_string("JSON.parse('\"абв\"').length"),
+      nxt_string("3") },
+
+    { nxt_string("JSON.parse('{\"a\":1,\"a\":2}').a"),
+      nxt_string("2") },
+
+    { nxt_string("JSON.parse('[]').length + JSON.parse(' {} ')"),
+      nxt_string("0[object Object]") },
+
+    { nxt_string("JSON.parse('-0.5') + JSON.parse('1234567890123456789')"),
+      nxt_string("1234567890123456800") },
+
+    { nxt_string("JSON.parse('[-999999999999999, 1234567890123456,"
+                 "-123456789012345678901234567890]')"),
+      nxt_string("-999999999999999,1234567890123456,"
+                 "-1.2345678901234568e+29") },
+
+    { nxt_string("JSON.parse('{\"a\":1,}')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('[1 2]')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('\"\\\\x\"')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('01')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('1.')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('')"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse()"),
+      nxt_string("SyntaxError") },
+
+    { nxt_string("JSON.parse('1', function(k, v) { return v })"),
+      nxt_string("TypeError") },
+
+    { nxt_string("JSON.stringify({a:1, b:'x', c:[true, null, undefined,"
+                 "                function(){}], d:{}})"),
+      nxt_string("{\"a\":1,\"b\":\"x\",\"c\":[true,null,null,null],\"d\":{}}") },
+
+    { nxt_string("JSON.stringify({a:undefined, b:function(){}, c:NaN})"),
+      nxt_string("{\"c\":null}") },
+
+    { nxt_string("var o = {a:1}; o.b = 2; delete o.a; JSON.stringify(o)"),
+      nxt_string("{\"b\":2}") },
+
+    { nxt_string("JSON.stringify('\"\\\\\\n\\u0001\\u0430')"),
+      nxt_string("\"\\\"\\\\\\n\\u0001а\"") },
+
+    { nxt_string("JSON.stringify('\\u0430xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx')"
+                 ".length"),
+      nxt_string("38") },
+
+    { nxt_string("var s = JSON.parse('\"абвгдеёжзийклмнопрстуфхцчшщъыьэюя\"');"
+                 "s.length + s[32]"),
+      nxt_string("33я") },
+
+    { nxt_string("JSON.stringify([new Number(1), new String('s'),"
+                 "                new Boolean(false)])"),
+      nxt_string("[1,\"s\",false]") },
+
+    { nxt_string("JSON.stringify([new Date(1308895200000), new Date(NaN)])"),
+      nxt_string("[\"2011-06-24T06:00:00.000Z\",null]") },
+
+    { nxt_string("JSON.stringify(undefined) + JSON.stringify(function(){})"),
+      nxt_string("NaN") },
+
+    { nxt_string("JSON.stringify({a:[1,{b:2}]}, null, 2)"),
+      nxt_string("{\n  \"a\": [\n    1,\n    {\n      \"b\": 2\n    }\n  ]\n}") },
+
+    { nxt_string("JSON.stringify([1], null, 'абв')"),
+      nxt_string("[\nабв1\n]") },
+
+    { nxt_string("JSON.stringify({}, null, 2) + JSON.stringify([], null, 2)"),
+      nxt_string("{}[]") },
+
+    { nxt_string("var a = [1]; a.push(a); JSON.stringify(a)"),
+      nxt_string("TypeError") },
+
+    { nxt_string("JSON.stringify({a:1}, ['a'])"),
+      nxt_string("TypeError") },
+
+    { nxt_string("var s = '{\"a\":[1,\"б\",{\"c\":null}],\"d\":\"\\\\t\"}';"
+                 "JSON.stringify(JSON.parse(s)) == s"),
+      nxt_string("true") },
+
     { nxt_string("isNaN"),
       nxt_string("[object Function]") },
 
@@ -4941,6 +5526,17 @@ static njs_unit_test_t  njs_test[] =
     { nxt_string("function f(req) { return req.uri }"),
       nxt_string("АБВ") },
 
+    { nxt_string("var a = 1; function f(req) { return a + 1 }"),
+      nxt_string("2") },
+
+    { nxt_string("var a = 1; function g() { a++; return a }"
+                 "function f(req) { g(); return g() }"),
+      nxt_string("3") },
+
+    { nxt_string("var a; function f(req)"
+                 "{ for (a in { b: 1 }) { break } return a }"),
+      nxt_string("b") },
+
     /* Trick: number to boolean. */
 
     { nxt_string("var a = 0; !!a"),
@@ -5015,6 +5611,15 @@ njs_unit_test_host_external(njs_vm_t *vm, njs_value_t *value, void *obj,
 }
 
 
+static njs_ret_t
+njs_unit_test_buffer_external(njs_vm_t *vm, njs_value_t *value, void *obj,
+    uintptr_t data)
+{
+    /* The bytes are in read-only memory. */
+    return njs_array_buffer_create(vm, value, (u_char *) "abc", 3);
+}
+
+
 static njs_ret_t
 njs_unit_test_header_external(njs_vm_t *vm, njs_value_t *value, void *obj,
     uintptr_t data)
@@ -5126,6 +5731,18 @@ static njs_external_t  njs_unit_test_r_external[] = {
       NULL,
       0 },
 
+    { nxt_string("buffer"),
+      NJS_EXTERN_PROPERTY,
+      NULL,
+      0,
+      njs_unit_test_buffer_external,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      NULL,
+      0 },
+
     { nxt_string("header"),
       NJS_EXTERN_OBJECT,
       NULL,
@@ -5227,6 +5844,112 @@ static const nxt_mem_proto_t  njs_mem_cache_pool_proto = {
 };
 
 
+/*
+ * The clones share the compiled code and reuse the same memory pool
+ * as nginx does, so values of a clone may have the addresses of values
+ * of the previous clone.
+ */
+
+static nxt_int_t
+njs_unit_test_clones(nxt_lvlhsh_t *externals, nxt_mem_cache_pool_t *mcp)
+{
+    void                  *ext_object;
+    u_char                *start;
+    njs_vm_t              *vm, *nvm;
+    nxt_int_t             ret;
+    nxt_str_t             s, r_name;
+    nxt_uint_t            i, n;
+    njs_function_t        *function;
+    njs_vm_shared_t       *shared;
+    njs_unit_test_req     r;
+    njs_opaque_value_t    value;
+    nxt_mem_cache_pool_t  *nmcp;
+
+    static nxt_str_t  script = nxt_string(
+        "function f(r) {"
+        "    var k = 'longpropertyname' + r.uri;"
+        "    var o = { longpropertyname1: 'ONE', longpropertyname2: 'TWO' };"
+        "    return k + '=' + o[k]"
+        "}");
+
+    static nxt_str_t  uris[] = {
+        nxt_string("1"),
+        nxt_string("2"),
+    };
+
+    static nxt_str_t  results[] = {
+        nxt_string("longpropertyname1=ONE"),
+        nxt_string("longpropertyname2=TWO"),
+    };
+
+    shared = NULL;
+
+    vm = njs_vm_create(mcp, &shared, externals);
+    if (vm == NULL) {
+        return NXT_ERROR;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length, &function);
+    if (ret != NXT_OK || function == NULL) {
+        return NXT_ERROR;
+    }
+
+    nmcp = nxt_mem_cache_pool_create(&njs_mem_cache_pool_proto, NULL, NULL,
+                                     2 * nxt_pagesize(), 128, 512, 16);
+    if (nxt_slow_path(nmcp == NULL)) {
+        return NXT_ERROR;
+    }
+
+    r.mem_cache_pool = mcp;
+    ext_object = &r;
+
+    r_name.length = 2;
+    r_name.start = (u_char *) "$r";
+
+    for (i = 0; i < 8; i++) {
+        n = i % nxt_nitems(uris);
+        r.uri = uris[n];
+
+        nvm = njs_vm_clone(vm, nmcp, &ext_object);
+        if (nvm == NULL) {
+            return NXT_ERROR;
+        }
+
+        ret = njs_vm_external(nvm, NULL, &r_name, &value);
+        if (ret != NXT_OK) {
+            return NXT_ERROR;
+        }
+
+        ret = njs_vm_call(nvm, function, &value, 1);
+
+        if (ret == NXT_OK) {
+            if (njs_vm_retval(nvm, &s) != NXT_OK) {
+                return NXT_ERROR;
+            }
+
+        } else {
+            njs_vm_exception(nvm, &s);
+        }
+
+        if (!nxt_strstr_eq(&results[n], &s)) {
+            printf("njs clone %d failed: \"%.*s\" vs \"%.*s\"\n", (int) i,
+                   (int) results[n].length, results[n].start,
+                   (int) s.length, s.start);
+
+            return NXT_ERROR;
+        }
+
+        nxt_mem_cache_pool_reset(nmcp);
+    }
+
+    nxt_mem_cache_pool_destroy(nmcp);
+
+    return NXT_OK;
+}
+
+
 static nxt_int_t
 njs_unit_test(nxt_bool_t disassemble)
 {
@@ -5344,6 +6067,10 @@ njs_unit_test(nxt_bool_t disassemble)
         return NXT_ERROR;
     }
 
+    if (njs_unit_test_clones(&externals, mcp) != NXT_OK) {
+        return NXT_ERROR;
+    }
+
     nxt_mem_cache_pool_destroy(mcp);
 
     printf("njs unit tests passed\n");
@@ -0,0 +1,78 @@
+
+/* This file is auto-generated by configure */
+
+
+#ifndef NXT_GCC
+#define NXT_GCC  1
+#endif
+
+
+#ifndef NXT_HAVE_BUILTIN_EXPECT
+#define NXT_HAVE_BUILTIN_EXPECT  1
+#endif
+
+
+#ifndef NXT_HAVE_BUILTIN_UNREACHABLE
+#define NXT_HAVE_BUILTIN_UNREACHABLE  1
+#endif
+
+
+#ifndef NXT_HAVE_BUILTIN_PREFETCH
+#define NXT_HAVE_BUILTIN_PREFETCH  1
+#endif
+
+
+#ifndef NXT_HAVE_BUILTIN_CTZ
+#define NXT_HAVE_BUILTIN_CTZ  1
+#endif
+
+
+#ifndef NXT_HAVE_BUILTIN_CLZ
+#define NXT_HAVE_BUILTIN_CLZ  1
+#endif
+
+
+#ifndef NXT_HAVE_SSE2
+#define NXT_HAVE_SSE2  1
+#endif
+
+
+#ifndef NXT_HAVE_GCC_ATTRIBUTE_ALIGNED
+#define NXT_HAVE_GCC_ATTRIBUTE_ALIGNED  1
+#endif
+
+
+#ifndef NXT_HAVE_GCC_ATTRIBUTE_MALLOC
+#define NXT_HAVE_GCC_ATTRIBUTE_MALLOC  1
+#endif
+
+
+#ifndef NXT_HAVE_COMPUTED_GOTO
+#define NXT_HAVE_COMPUTED_GOTO  1
+#endif
+
+
+#ifndef NXT_HAVE_TM_GMTOFF
+#define NXT_HAVE_TM_GMTOFF  1
+#endif
+
+
+#ifndef NXT_HAVE_POSIX_MEMALIGN
+#define NXT_HAVE_POSIX_MEMALIGN  1
+#endif
+
+
+#ifndef NXT_HAVE_GETRANDOM
+#define NXT_HAVE_GETRANDOM  1
+#endif
+
+
+#ifndef NXT_HAVE_PCRE
+#define NXT_HAVE_PCRE  1
+#endif
+
+
+#ifndef NXT_HAVE_PCRE_JIT
+#define NXT_HAVE_PCRE_JIT  1
+#endif
+
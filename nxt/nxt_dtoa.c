@@ -0,0 +1,498 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_dtoa.h>
+#include <string.h>
+
+
+/*
+ * The shortest digits are generated by the Grisu2 algorithm described in
+ * "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+ * by Florian Loitsch.  Grisu2 uses only 64-bit integer arithmetic and
+ * its result always reads back to the same double, although in rare cases
+ * the result is one digit longer than the shortest possible one.
+ */
+
+
+typedef struct {
+    uint64_t  f;
+    int       e;
+} nxt_diyfp_t;
+
+
+#define NXT_DBL_SIGNIFICAND_SIZE  52
+#define NXT_DBL_EXPONENT_BIAS     (0x3ff + NXT_DBL_SIGNIFICAND_SIZE)
+#define NXT_DBL_SIGNIFICAND_MASK  0x000fffffffffffffULL
+#define NXT_DBL_EXPONENT_MASK     0x7ff0000000000000ULL
+#define NXT_DBL_HIDDEN_BIT        0x0010000000000000ULL
+
+#define NXT_DIYFP_HIDDEN_BIT      0x8000000000000000ULL
+
+/* 2^53, all integers below are exactly representable by double. */
+#define NXT_DBL_MAX_INTEGER       9007199254740992.0
+
+
+static nxt_diyfp_t nxt_diyfp_from_double(double value);
+static nxt_diyfp_t nxt_diyfp_mul(nxt_diyfp_t lhs, nxt_diyfp_t rhs);
+static nxt_diyfp_t nxt_diyfp_normalize(nxt_diyfp_t v);
+static void nxt_diyfp_boundaries(nxt_diyfp_t v, nxt_diyfp_t *minus,
+    nxt_diyfp_t *plus);
+static nxt_diyfp_t nxt_cached_power(int e, int *dec_exp);
+static size_t nxt_grisu2(double value, u_char *start, int *dec_exp);
+static size_t nxt_grisu2_gen(nxt_diyfp_t w, nxt_diyfp_t mp, uint64_t delta,
+    u_char *start, int *dec_exp);
+static void nxt_grisu2_round(u_char *start, size_t length, uint64_t delta,
+    uint64_t rest, uint64_t ten_kappa, uint64_t wp_w);
+static size_t nxt_dtoa_integer(uint64_t value, u_char *start);
+static size_t nxt_dtoa_format(u_char *start, size_t length, int dec_exp);
+
+
+#define nxt_diyfp(_f, _e)  (nxt_diyfp_t) { .f = (_f), .e = (_e) }
+
+
+static const uint64_t  nxt_pow10[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+
+/*
+ * Normalized 64-bit approximations of powers of ten from 10^-348
+ * to 10^340 with step 8 and their binary exponents.
+ */
+
+static const nxt_diyfp_t  nxt_cached_powers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 },
+    { 0x8b16fb203055ac76ULL, -1166 }, { 0xcf42894a5dce35eaULL, -1140 },
+    { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+    { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 },
+    { 0xbe5691ef416bd60cULL, -1007 }, { 0x8dd01fad907ffc3cULL,  -980 },
+    { 0xd3515c2831559a83ULL,  -954 }, { 0x9d71ac8fada6c9b5ULL,  -927 },
+    { 0xea9c227723ee8bcbULL,  -901 }, { 0xaecc49914078536dULL,  -874 },
+    { 0x823c12795db6ce57ULL,  -847 }, { 0xc21094364dfb5637ULL,  -821 },
+    { 0x9096ea6f3848984fULL,  -794 }, { 0xd77485cb25823ac7ULL,  -768 },
+    { 0xa086cfcd97bf97f4ULL,  -741 }, { 0xef340a98172aace5ULL,  -715 },
+    { 0xb23867fb2a35b28eULL,  -688 }, { 0x84c8d4dfd2c63f3bULL,  -661 },
+    { 0xc5dd44271ad3cdbaULL,  -635 }, { 0x936b9fcebb25c996ULL,  -608 },
+    { 0xdbac6c247d62a584ULL,  -582 }, { 0xa3ab66580d5fdaf6ULL,  -555 },
+    { 0xf3e2f893dec3f126ULL,  -529 }, { 0xb5b5ada8aaff80b8ULL,  -502 },
+    { 0x87625f056c7c4a8bULL,  -475 }, { 0xc9bcff6034c13053ULL,  -449 },
+    { 0x964e858c91ba2655ULL,  -422 }, { 0xdff9772470297ebdULL,  -396 },
+    { 0xa6dfbd9fb8e5b88fULL,  -369 }, { 0xf8a95fcf88747d94ULL,  -343 },
+    { 0xb94470938fa89bcfULL,  -316 }, { 0x8a08f0f8bf0f156bULL,  -289 },
+    { 0xcdb02555653131b6ULL,  -263 }, { 0x993fe2c6d07b7facULL,  -236 },
+    { 0xe45c10c42a2b3b06ULL,  -210 }, { 0xaa242499697392d3ULL,  -183 },
+    { 0xfd87b5f28300ca0eULL,  -157 }, { 0xbce5086492111aebULL,  -130 },
+    { 0x8cbccc096f5088ccULL,  -103 }, { 0xd1b71758e219652cULL,   -77 },
+    { 0x9c40000000000000ULL,   -50 }, { 0xe8d4a51000000000ULL,   -24 },
+    { 0xad78ebc5ac620000ULL,     3 }, { 0x813f3978f8940984ULL,    30 },
+    { 0xc097ce7bc90715b3ULL,    56 }, { 0x8f7e32ce7bea5c70ULL,    83 },
+    { 0xd5d238a4abe98068ULL,   109 }, { 0x9f4f2726179a2245ULL,   136 },
+    { 0xed63a231d4c4fb27ULL,   162 }, { 0xb0de65388cc8ada8ULL,   189 },
+    { 0x83c7088e1aab65dbULL,   216 }, { 0xc45d1df942711d9aULL,   242 },
+    { 0x924d692ca61be758ULL,   269 }, { 0xda01ee641a708deaULL,   295 },
+    { 0xa26da3999aef774aULL,   322 }, { 0xf209787bb47d6b85ULL,   348 },
+    { 0xb454e4a179dd1877ULL,   375 }, { 0x865b86925b9bc5c2ULL,   402 },
+    { 0xc83553c5c8965d3dULL,   428 }, { 0x952ab45cfa97a0b3ULL,   455 },
+    { 0xde469fbd99a05fe3ULL,   481 }, { 0xa59bc234db398c25ULL,   508 },
+    { 0xf6c69a72a3989f5cULL,   534 }, { 0xb7dcbf5354e9beceULL,   561 },
+    { 0x88fcf317f22241e2ULL,   588 }, { 0xcc20ce9bd35c78a5ULL,   614 },
+    { 0x98165af37b2153dfULL,   641 }, { 0xe2a0b5dc971f303aULL,   667 },
+    { 0xa8d9d1535ce3b396ULL,   694 }, { 0xfb9b7cd9a4a7443cULL,   720 },
+    { 0xbb764c4ca7a44410ULL,   747 }, { 0x8bab8eefb6409c1aULL,   774 },
+    { 0xd01fef10a657842cULL,   800 }, { 0x9b10a4e5e9913129ULL,   827 },
+    { 0xe7109bfba19c0c9dULL,   853 }, { 0xac2820d9623bf429ULL,   880 },
+    { 0x80444b5e7aa7cf85ULL,   907 }, { 0xbf21e44003acdd2dULL,   933 },
+    { 0x8e679c2f5e44ff8fULL,   960 }, { 0xd433179d9c8cb841ULL,   986 },
+    { 0x9e19db92b4e31ba9ULL,  1013 }, { 0xeb96bf6ebadf77d9ULL,  1039 },
+    { 0xaf87023b9bf0ee6bULL,  1066 },
+};
+
+
+size_t
+nxt_dtoa(double value, u_char *start)
+{
+    int       dec_exp;
+    size_t    length;
+    u_char    *p;
+    uint64_t  n;
+
+    p = start;
+
+    if (value == 0) {
+        /* Both 0 and -0. */
+        *p = '0';
+        return 1;
+    }
+
+    if (value < 0) {
+        *p++ = '-';
+        value = -value;
+    }
+
+    if (value < NXT_DBL_MAX_INTEGER) {
+        n = (uint64_t) value;
+
+        if ((double) n == value) {
+            return (p - start) + nxt_dtoa_integer(n, p);
+        }
+    }
+
+    length = nxt_grisu2(value, p, &dec_exp);
+
+    return (p - start) + nxt_dtoa_format(p, length, dec_exp);
+}
+
+
+static size_t
+nxt_dtoa_integer(uint64_t value, u_char *start)
+{
+    u_char  *p, *end;
+    u_char  buf[20];
+
+    end = buf + sizeof(buf);
+    p = end;
+
+    do {
+        *(--p) = (u_char) (value % 10 + '0');
+        value /= 10;
+    } while (value != 0);
+
+    memcpy(start, p, end - p);
+
+    return end - p;
+}
+
+
+/*
+ * The digits are formatted according to the Number::toString() algorithm
+ * of ECMAScript, the value is the digits multiplied by 10^dec_exp.
+ */
+
+static size_t
+nxt_dtoa_format(u_char *start, size_t length, int dec_exp)
+{
+    int     n, exp;
+    size_t  size;
+    u_char  *p;
+
+    /* The position of the decimal point. */
+    n = (int) length + dec_exp;
+
+    if ((int) length <= n && n <= 21) {
+        /* 1234e7 -> 12340000000 */
+        memset(start + length, '0', dec_exp);
+        return n;
+    }
+
+    if (0 < n && n <= 21) {
+        /* 1234e-2 -> 12.34 */
+        memmove(start + n + 1, start + n, length - n);
+        start[n] = '.';
+        return length + 1;
+    }
+
+    if (-6 < n && n <= 0) {
+        /* 1234e-6 -> 0.001234 */
+        size = 2 - n;
+        memmove(start + size, start, length);
+        start[0] = '0';
+        start[1] = '.';
+        memset(start + 2, '0', -n);
+        return length + size;
+    }
+
+    /* 1234e30 -> 1.234e+33 */
+
+    if (length == 1) {
+        p = start + 1;
+
+    } else {
+        memmove(start + 2, start + 1, length - 1);
+        start[1] = '.';
+        p = start + length + 1;
+    }
+
+    *p++ = 'e';
+
+    exp = n - 1;
+
+    if (exp < 0) {
+        *p++ = '-';
+        exp = -exp;
+
+    } else {
+        *p++ = '+';
+    }
+
+    return (p - start) + nxt_dtoa_integer(exp, p);
+}
+
+
+static size_t
+nxt_grisu2(double value, u_char *start, int *dec_exp)
+{
+    size_t       length;
+    nxt_diyfp_t  v, w, minus, plus, c_mk;
+
+    v = nxt_diyfp_from_double(value);
+    nxt_diyfp_boundaries(v, &minus, &plus);
+
+    c_mk = nxt_cached_power(plus.e, dec_exp);
+
+    w = nxt_diyfp_mul(nxt_diyfp_normalize(v), c_mk);
+    plus = nxt_diyfp_mul(plus, c_mk);
+    minus = nxt_diyfp_mul(minus, c_mk);
+
+    /* The boundaries are narrowed to compensate the multiplication error. */
+    minus.f++;
+    plus.f--;
+
+    length = nxt_grisu2_gen(w, plus, plus.f - minus.f, start, dec_exp);
+
+    /* The rounding may leave trailing zeros. */
+
+    while (length > 1 && start[length - 1] == '0') {
+        length--;
+        (*dec_exp)++;
+    }
+
+    return length;
+}
+
+
+static size_t
+nxt_grisu2_gen(nxt_diyfp_t w, nxt_diyfp_t mp, uint64_t delta, u_char *start,
+    int *dec_exp)
+{
+    int       kappa, shift;
+    u_char    c, *p;
+    uint32_t  p1, d;
+    uint64_t  p2, tmp, one, wp_w;
+
+    shift = -mp.e;
+    one = (uint64_t) 1 << shift;
+    wp_w = mp.f - w.f;
+
+    /* The integral and fractional parts of the upper boundary. */
+    p1 = (uint32_t) (mp.f >> shift);
+    p2 = mp.f & (one - 1);
+
+    kappa = 1;
+
+    while (kappa < 10 && p1 >= nxt_pow10[kappa]) {
+        kappa++;
+    }
+
+    p = start;
+
+    while (kappa > 0) {
+        d = p1 / nxt_pow10[kappa - 1];
+        p1 %= nxt_pow10[kappa - 1];
+
+        if (d != 0 || p != start) {
+            *p++ = (u_char) (d + '0');
+        }
+
+        kappa--;
+
+        tmp = ((uint64_t) p1 << shift) + p2;
+
+        if (tmp <= delta) {
+            *dec_exp += kappa;
+            nxt_grisu2_round(start, p - start, delta, tmp,
+                             nxt_pow10[kappa] << shift, wp_w);
+            return p - start;
+        }
+    }
+
+    for ( ;; ) {
+        p2 *= 10;
+        delta *= 10;
+
+        c = (u_char) (p2 >> shift);
+
+        if (c != 0 || p != start) {
+            *p++ = (u_char) (c + '0');
+        }
+
+        p2 &= one - 1;
+        kappa--;
+
+        if (p2 < delta) {
+            *dec_exp += kappa;
+            nxt_grisu2_round(start, p - start, delta, p2, one,
+                             wp_w * nxt_pow10[-kappa]);
+            return p - start;
+        }
+    }
+}
+
+
+static void
+nxt_grisu2_round(u_char *start, size_t length, uint64_t delta, uint64_t rest,
+    uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w
+           && delta - rest >= ten_kappa
+           && (rest + ten_kappa < wp_w
+               || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        start[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+
+static nxt_diyfp_t
+nxt_diyfp_from_double(double value)
+{
+    int       biased_exp;
+    uint64_t  significand;
+
+    union {
+        double    d;
+        uint64_t  u64;
+    } u;
+
+    u.d = value;
+
+    biased_exp = (u.u64 & NXT_DBL_EXPONENT_MASK) >> NXT_DBL_SIGNIFICAND_SIZE;
+    significand = u.u64 & NXT_DBL_SIGNIFICAND_MASK;
+
+    if (biased_exp != 0) {
+        return nxt_diyfp(significand + NXT_DBL_HIDDEN_BIT,
+                         biased_exp - NXT_DBL_EXPONENT_BIAS);
+    }
+
+    /* A subnormal value. */
+
+    return nxt_diyfp(significand, 1 - NXT_DBL_EXPONENT_BIAS);
+}
+
+
+static nxt_diyfp_t
+nxt_diyfp_mul(nxt_diyfp_t lhs, nxt_diyfp_t rhs)
+{
+    uint64_t  a, b, c, d, ac, bc, ad, bd, tmp;
+
+    a = lhs.f >> 32;
+    b = lhs.f & 0xffffffff;
+    c = rhs.f >> 32;
+    d = rhs.f & 0xffffffff;
+
+    ac = a * c;
+    bc = b * c;
+    ad = a * d;
+    bd = b * d;
+
+    tmp = (bd >> 32) + (ad & 0xffffffff) + (bc & 0xffffffff);
+
+    /* Round the lower 64 bits. */
+    tmp += 1U << 31;
+
+    return nxt_diyfp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32),
+                     lhs.e + rhs.e + 64);
+}
+
+
+static nxt_diyfp_t
+nxt_diyfp_normalize(nxt_diyfp_t v)
+{
+    while ((v.f & NXT_DIYFP_HIDDEN_BIT) == 0) {
+        v.f <<= 1;
+        v.e--;
+    }
+
+    return v;
+}
+
+
+/*
+ * The boundaries are the midpoints between the value and its neighbours,
+ * all numbers between them read back to the value.
+ */
+
+static void
+nxt_diyfp_boundaries(nxt_diyfp_t v, nxt_diyfp_t *minus, nxt_diyfp_t *plus)
+{
+    nxt_diyfp_t  pl, mi;
+
+    pl = nxt_diyfp((v.f << 1) + 1, v.e - 1);
+
+    while ((pl.f & (NXT_DBL_HIDDEN_BIT << 1)) == 0) {
+        pl.f <<= 1;
+        pl.e--;
+    }
+
+    pl.f <<= 64 - NXT_DBL_SIGNIFICAND_SIZE - 2;
+    pl.e -= 64 - NXT_DBL_SIGNIFICAND_SIZE - 2;
+
+    /* The lower neighbour of a power of two is closer. */
+
+    if (v.f == NXT_DBL_HIDDEN_BIT) {
+        mi = nxt_diyfp((v.f << 2) - 1, v.e - 2);
+
+    } else {
+        mi = nxt_diyfp((v.f << 1) - 1, v.e - 1);
+    }
+
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *minus = mi;
+    *plus = pl;
+}
+
+
+/*
+ * nxt_cached_power() returns a power of ten which moves the binary
+ * exponent of the product into the range [-60, -32] and the negated
+ * decimal exponent of the power.
+ */
+
+static nxt_diyfp_t
+nxt_cached_power(int e, int *dec_exp)
+{
+    int       k;
+    double    dk;
+    unsigned  index;
+
+    /* 0.30102999566398114 is log10(2). */
+    dk = (-61 - e) * 0.30102999566398114 + 347;
+
+    k = (int) dk;
+
+    if (dk - k > 0.0) {
+        k++;
+    }
+
+    index = (unsigned) ((k >> 3) + 1);
+
+    *dec_exp = -(-348 + (int) (index << 3));
+
+    return nxt_cached_powers[index];
+}
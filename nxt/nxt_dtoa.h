@@ -0,0 +1,26 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NXT_DTOA_H_INCLUDED_
+#define _NXT_DTOA_H_INCLUDED_
+
+
+/* The longest result is "-0.0000012345678901234567" or similar. */
+#define NXT_DTOA_MAX_LEN  32
+
+
+/*
+ * nxt_dtoa() writes a decimal representation of a finite double value
+ * which reads back to the same value and is the shortest one in almost
+ * all cases.  The format is that of the JavaScript toString() method of
+ * Number.  The buffer must have at least NXT_DTOA_MAX_LEN bytes.  The
+ * function returns the result length, the result is not null-terminated.
+ */
+
+NXT_EXPORT size_t nxt_dtoa(double value, u_char *start);
+
+
+#endif /* _NXT_DTOA_H_INCLUDED_ */
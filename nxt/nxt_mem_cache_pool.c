@@ -281,6 +281,65 @@ nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool)
 }
 
 
+/*
+ * The pool is rewound to the state of a new pool but the clusters are
+ * retained as free pages to serve next allocations without system calls.
+ */
+
+void
+nxt_mem_cache_pool_reset(nxt_mem_cache_pool_t *pool)
+{
+    void                   *p;
+    nxt_uint_t             n;
+    nxt_rbtree_node_t      *node, *next;
+    nxt_mem_cache_slot_t   *slot;
+    nxt_mem_cache_block_t  *block;
+
+    slot = pool->slots;
+
+    for (n = pool->page_size_shift - pool->chunk_size_shift; n != 0; n--) {
+        nxt_queue_init(&slot->pages);
+        slot++;
+    }
+
+    nxt_queue_init(&pool->free_pages);
+
+    for (node = nxt_rbtree_min(&pool->blocks);
+         nxt_rbtree_is_there_successor(&pool->blocks, node);
+         node = next)
+    {
+        next = nxt_rbtree_node_successor(&pool->blocks, node);
+
+        block = (nxt_mem_cache_block_t *) node;
+
+        if (block->type == NXT_MEM_CACHE_CLUSTER_BLOCK) {
+            n = block->size >> pool->page_size_shift;
+
+            memset(block->pages, 0, n * sizeof(nxt_mem_cache_page_t));
+
+            while (n != 0) {
+                n--;
+                block->pages[n].number = n;
+                nxt_queue_insert_head(&pool->free_pages,
+                                      &block->pages[n].link);
+            }
+
+            continue;
+        }
+
+        nxt_rbtree_delete(&pool->blocks, &block->node);
+
+        p = block->start;
+
+        if (block->type != NXT_MEM_CACHE_EMBEDDED_BLOCK) {
+            pool->proto->free(pool->mem, block);
+        }
+
+        pool->proto->free(pool->mem, p);
+    }
+}
+
+
 nxt_inline u_char *
 nxt_mem_cache_page_addr(nxt_mem_cache_pool_t *pool, nxt_mem_cache_page_t *page)
 {
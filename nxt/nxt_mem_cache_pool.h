@@ -23,6 +23,7 @@ NXT_EXPORT nxt_mem_cache_pool_t *
     NXT_MALLOC_LIKE;
 NXT_EXPORT nxt_bool_t nxt_mem_cache_pool_is_empty(nxt_mem_cache_pool_t *pool);
 NXT_EXPORT void nxt_mem_cache_pool_destroy(nxt_mem_cache_pool_t *pool);
+NXT_EXPORT void nxt_mem_cache_pool_reset(nxt_mem_cache_pool_t *pool);
 
 NXT_EXPORT void *nxt_mem_cache_alloc(nxt_mem_cache_pool_t *pool, size_t size)
     NXT_MALLOC_LIKE;
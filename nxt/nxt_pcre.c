@@ -4,15 +4,22 @@
  * Copyright (C) NGINX, Inc.
  */
 
+#include <nxt_auto_config.h>
 #include <nxt_types.h>
 #include <nxt_clang.h>
 #include <nxt_stub.h>
+#include <nxt_string.h>
 #include <nxt_trace.h>
 #include <nxt_regex.h>
 #include <nxt_pcre.h>
 #include <string.h>
 
 
+static nxt_int_t nxt_regex_literal(nxt_regex_t *regex, u_char *source,
+    nxt_uint_t options, nxt_regex_context_t *ctx);
+static nxt_int_t nxt_regex_literal_match(nxt_regex_t *regex, u_char *subject,
+    size_t len, nxt_regex_match_data_t *match_data);
+static nxt_bool_t nxt_regex_literal_eq(nxt_regex_t *regex, u_char *p);
 static void *nxt_pcre_malloc(size_t size);
 static void nxt_pcre_free(void *p);
 static void *nxt_pcre_default_malloc(size_t size, void *memory_data);
@@ -39,12 +46,51 @@ nxt_regex_context_create(nxt_pcre_malloc_t private_malloc,
         ctx->private_malloc = private_malloc;
         ctx->private_free = private_free;
         ctx->memory_data = memory_data;
+        ctx->jit_stack = NULL;
+        ctx->jit_regexes = NULL;
     }
 
     return ctx;
 }
 
 
+/*
+ * JIT code and JIT stack are not allocated by the context allocator,
+ * so they must be freed explicitly.
+ */
+
+void
+nxt_regex_context_destroy(nxt_regex_context_t *ctx)
+{
+#if (NXT_HAVE_PCRE_JIT)
+    nxt_regex_t  *regex;
+    void         *(*saved_malloc)(size_t size);
+    void         (*saved_free)(void *p);
+
+    saved_malloc = pcre_malloc;
+    pcre_malloc = nxt_pcre_malloc;
+    saved_free = pcre_free;
+    pcre_free = nxt_pcre_free;
+    regex_context = ctx;
+
+    for (regex = ctx->jit_regexes; regex != NULL; regex = regex->next) {
+        pcre_free_study(regex->extra);
+        regex->extra = NULL;
+    }
+
+    if (ctx->jit_stack != NULL) {
+        pcre_jit_stack_free(ctx->jit_stack);
+    }
+
+    pcre_malloc = saved_malloc;
+    pcre_free = saved_free;
+    regex_context = NULL;
+#endif
+
+    ctx->private_free(ctx, ctx->memory_data);
+}
+
+
 nxt_int_t
 nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
     nxt_uint_t options, nxt_regex_context_t *ctx)
@@ -76,6 +122,8 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
         pattern[len] = '\0';
     }
 
+    regex->literal = NULL;
+
     regex->code = pcre_compile(pattern, options, &errstr, &erroff, NULL);
 
     if (nxt_slow_path(regex->code == NULL)) {
@@ -119,6 +167,213 @@ nxt_regex_compile(nxt_regex_t *regex, u_char *source, size_t len,
 
     ret = NXT_OK;
 
+    if (regex->ncaptures == 1) {
+        ret = nxt_regex_literal(regex, (u_char *) pattern, options, ctx);
+
+        if (ret == NXT_DECLINED) {
+            ret = NXT_OK;
+        }
+    }
+
+done:
+
+    pcre_malloc = saved_malloc;
+    pcre_free = saved_free;
+    regex_context = NULL;
+
+    return ret;
+}
+
+
+/*
+ * A pattern consisting of plain characters and optional "^" and "$"
+ * anchors is matched by nxt_regex_literal_match().  A non-alphanumeric
+ * ASCII character escaped by backslash is a plain character.  Caseless
+ * patterns are accepted only if they consist of ASCII characters, and
+ * in UTF-8 mode also if they have no "k" and "s", which match the Kelvin
+ * sign and the long "s".  In multiline mode the anchors are not allowed.
+ */
+
+static nxt_int_t
+nxt_regex_literal(nxt_regex_t *regex, u_char *source, nxt_uint_t options,
+    nxt_regex_context_t *ctx)
+{
+    u_char      c, *p, *dst;
+    nxt_bool_t  caseless, multiline;
+
+    caseless = ((options & PCRE_CASELESS) != 0);
+    multiline = ((options & PCRE_MULTILINE) != 0);
+
+    p = source;
+
+    regex->anchor_start = 0;
+    regex->anchor_end = 0;
+
+    if (*p == '^') {
+        if (multiline) {
+            return NXT_DECLINED;
+        }
+
+        regex->anchor_start = 1;
+        p++;
+    }
+
+    if (*p == '\0') {
+        return NXT_DECLINED;
+    }
+
+    dst = ctx->private_malloc(strlen((char *) p), ctx->memory_data);
+    if (nxt_slow_path(dst == NULL)) {
+        return NXT_ERROR;
+    }
+
+    regex->literal = dst;
+
+    while (*p != '\0') {
+        c = *p++;
+
+        switch (c) {
+
+        case '\\':
+            c = *p++;
+
+            if ((c >= '0' && c <= '9')
+                || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')
+                || c == '\0' || c >= 0x80)
+            {
+                goto declined;
+            }
+
+            break;
+
+        case '$':
+            if (*p != '\0' || multiline) {
+                goto declined;
+            }
+
+            regex->anchor_end = 1;
+            continue;
+
+        case '^': case '.': case '|': case '?': case '*': case '+':
+        case '(': case ')': case '[': case ']': case '{': case '}':
+            goto declined;
+
+        default:
+            break;
+        }
+
+        if (caseless) {
+            if (c >= 0x80) {
+                goto declined;
+            }
+
+            c = nxt_lower_case(c);
+
+            if ((options & PCRE_UTF8) && (c == 'k' || c == 's')) {
+                goto declined;
+            }
+        }
+
+        *dst++ = c;
+    }
+
+    regex->literal_length = dst - regex->literal;
+
+    if (regex->literal_length == 0) {
+        goto declined;
+    }
+
+    regex->caseless = caseless;
+
+    return NXT_OK;
+
+declined:
+
+    ctx->private_free(regex->literal, ctx->memory_data);
+    regex->literal = NULL;
+
+    return NXT_DECLINED;
+}
+
+
+/*
+ * The regex is studied again with JIT compilation.  All regexes compiled
+ * by JIT in a context share the context JIT stack which is allocated once.
+ * NXT_DECLINED is returned if JIT is not supported by PCRE library or
+ * the regex cannot be compiled by JIT.
+ */
+
+nxt_int_t
+nxt_regex_jit_compile(nxt_regex_t *regex, nxt_regex_context_t *ctx)
+{
+#if (NXT_HAVE_PCRE_JIT)
+    int         jit, err;
+    nxt_int_t   ret;
+    pcre_extra  *extra;
+    void        *(*saved_malloc)(size_t size);
+    void        (*saved_free)(void *p);
+    const char  *errstr;
+
+    if (regex->literal != NULL) {
+        return NXT_DECLINED;
+    }
+
+    ret = NXT_ERROR;
+
+    saved_malloc = pcre_malloc;
+    pcre_malloc = nxt_pcre_malloc;
+    saved_free = pcre_free;
+    pcre_free = nxt_pcre_free;
+    regex_context = ctx;
+
+    extra = pcre_study(regex->code, PCRE_STUDY_JIT_COMPILE, &errstr);
+
+    if (nxt_slow_path(errstr != NULL)) {
+        nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
+                  "pcre_study(PCRE_STUDY_JIT_COMPILE) failed: %s", errstr);
+
+        goto done;
+    }
+
+    jit = 0;
+
+    if (extra != NULL) {
+        err = pcre_fullinfo(regex->code, extra, PCRE_INFO_JIT, &jit);
+
+        if (err < 0) {
+            jit = 0;
+        }
+    }
+
+    if (!jit) {
+        pcre_free_study(extra);
+        ret = NXT_DECLINED;
+        goto done;
+    }
+
+    if (ctx->jit_stack == NULL) {
+        ctx->jit_stack = pcre_jit_stack_alloc(NXT_REGEX_JIT_STACK_MIN,
+                                              NXT_REGEX_JIT_STACK_MAX);
+
+        if (nxt_slow_path(ctx->jit_stack == NULL)) {
+            nxt_alert(ctx->trace, NXT_LEVEL_ERROR,
+                      "pcre_jit_stack_alloc() failed");
+
+            pcre_free_study(extra);
+            goto done;
+        }
+    }
+
+    pcre_assign_jit_stack(extra, NULL, ctx->jit_stack);
+
+    pcre_free_study(regex->extra);
+    regex->extra = extra;
+
+    regex->next = ctx->jit_regexes;
+    ctx->jit_regexes = regex;
+
+    ret = NXT_OK;
+
 done:
 
     pcre_malloc = saved_malloc;
@@ -126,6 +381,12 @@ done:
     regex_context = NULL;
 
     return ret;
+
+#else
+
+    return NXT_DECLINED;
+
+#endif
 }
 
 
@@ -193,6 +454,105 @@ nxt_pcre_default_free(void *p, void *memory_data)
 }
 
 
+/*
+ * A literal match follows PCRE semantics: without PCRE_DOLLAR_ENDONLY
+ * the "$" anchor matches also before a newline at the subject end.
+ */
+
+static nxt_int_t
+nxt_regex_literal_match(nxt_regex_t *regex, u_char *subject, size_t len,
+    nxt_regex_match_data_t *match_data)
+{
+    u_char  *p, *last;
+    size_t  n;
+
+    n = regex->literal_length;
+
+    if (n > len) {
+        return PCRE_ERROR_NOMATCH;
+    }
+
+    last = subject + len - n;
+
+    if (regex->anchor_end) {
+        if (len > n && subject[len - 1] == '\n') {
+            p = last - 1;
+
+            if ((!regex->anchor_start || p == subject)
+                && nxt_regex_literal_eq(regex, p))
+            {
+                goto found;
+            }
+        }
+
+        p = last;
+
+        if ((!regex->anchor_start || p == subject)
+            && nxt_regex_literal_eq(regex, p))
+        {
+            goto found;
+        }
+
+        return PCRE_ERROR_NOMATCH;
+    }
+
+    if (regex->anchor_start) {
+        p = subject;
+
+        if (nxt_regex_literal_eq(regex, p)) {
+            goto found;
+        }
+
+        return PCRE_ERROR_NOMATCH;
+    }
+
+    if (!regex->caseless) {
+        p = nxt_memstrn(subject, subject + len, regex->literal, n);
+
+        if (p != NULL) {
+            goto found;
+        }
+
+        return PCRE_ERROR_NOMATCH;
+    }
+
+    for (p = subject; p <= last; p++) {
+
+        if (nxt_regex_literal_eq(regex, p)) {
+            goto found;
+        }
+    }
+
+    return PCRE_ERROR_NOMATCH;
+
+found:
+
+    match_data->captures[0] = p - subject;
+    match_data->captures[1] = p - subject + n;
+
+    return 1;
+}
+
+
+static nxt_bool_t
+nxt_regex_literal_eq(nxt_regex_t *regex, u_char *p)
+{
+    size_t  i;
+
+    if (!regex->caseless) {
+        return (memcmp(p, regex->literal, regex->literal_length) == 0);
+    }
+
+    for (i = 0; i < regex->literal_length; i++) {
+        if (nxt_lower_case(p[i]) != regex->literal[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
 nxt_bool_t
 nxt_regex_is_valid(nxt_regex_t *regex)
 {
@@ -206,6 +566,10 @@ nxt_regex_match(nxt_regex_t *regex, u_char *subject, size_t len,
 {
     int  ret;
 
+    if (regex->literal != NULL) {
+        return nxt_regex_literal_match(regex, subject, len, match_data);
+    }
+
     ret = pcre_exec(regex->code, regex->extra, (char *) subject, len, 0, 0,
                     match_data->captures, match_data->ncaptures);
 
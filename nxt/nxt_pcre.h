@@ -14,10 +14,26 @@
 #define NGX_REGEX_NOMATCH  PCRE_ERROR_NOMATCH
 
 
+#define NXT_REGEX_JIT_STACK_MIN  (32 * 1024)
+#define NXT_REGEX_JIT_STACK_MAX  (1024 * 1024)
+
+
 struct nxt_regex_s {
-    pcre        *code;
-    pcre_extra  *extra;
-    int         ncaptures;
+    pcre                *code;
+    pcre_extra          *extra;
+    int                 ncaptures;
+    /* The next regex compiled by JIT in the same context. */
+    struct nxt_regex_s  *next;
+
+    /*
+     * A pattern without metacharacters is matched without PCRE.
+     * A caseless literal is stored in lower case.
+     */
+    u_char              *literal;
+    uint32_t            literal_length;
+    uint8_t             caseless;      /* 1 bit */
+    uint8_t             anchor_start;  /* 1 bit */
+    uint8_t             anchor_end;    /* 1 bit */
 };
 
 
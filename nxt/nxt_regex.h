@@ -21,14 +21,21 @@ typedef struct {
     nxt_pcre_free_t    private_free;
     void               *memory_data;
     nxt_trace_t        *trace;
+
+    /* The JIT stack shared by the regexes compiled by JIT in the context. */
+    void               *jit_stack;
+    nxt_regex_t        *jit_regexes;
 } nxt_regex_context_t;
 
 
 NXT_EXPORT nxt_regex_context_t *
     nxt_regex_context_create(nxt_pcre_malloc_t private_malloc,
     nxt_pcre_free_t private_free, void *memory_data);
+NXT_EXPORT void nxt_regex_context_destroy(nxt_regex_context_t *ctx);
 NXT_EXPORT nxt_int_t nxt_regex_compile(nxt_regex_t *regex, u_char *source,
     size_t len, nxt_uint_t options, nxt_regex_context_t *ctx);
+NXT_EXPORT nxt_int_t nxt_regex_jit_compile(nxt_regex_t *regex,
+    nxt_regex_context_t *ctx);
 NXT_EXPORT nxt_bool_t nxt_regex_is_valid(nxt_regex_t *regex);
 NXT_EXPORT nxt_regex_match_data_t *nxt_regex_match_data(nxt_regex_t *regex,
     nxt_regex_context_t *ctx);
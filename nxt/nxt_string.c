@@ -0,0 +1,197 @@
+
+/*
+ * Copyright (C) Igor Sysoev
+ * Copyright (C) NGINX, Inc.
+ */
+
+#include <nxt_auto_config.h>
+#include <nxt_types.h>
+#include <nxt_clang.h>
+#include <nxt_string.h>
+#include <string.h>
+
+
+/*
+ * The SIMD search compares the first and the last bytes of a string with
+ * a block of positions at once and checks the middle bytes by memcmp()
+ * only for positions where both bytes match.  It requires a bit scan
+ * of a match mask, so SIMD is not used without __builtin_ctz() and
+ * __builtin_clz().
+ */
+
+#if (NXT_HAVE_BUILTIN_CTZ && NXT_HAVE_BUILTIN_CLZ)
+
+#if (NXT_HAVE_AVX2)
+
+#include <immintrin.h>
+
+#define NXT_SIMD  1
+
+typedef __m256i  nxt_vector_t;
+
+#define NXT_VECTOR_SIZE  32
+
+#define nxt_vector_set(c)                                                     \
+    _mm256_set1_epi8((char) (c))
+
+#define nxt_vector_load(p)                                                    \
+    _mm256_loadu_si256((const __m256i *) (p))
+
+#define nxt_vector_match(first, p, last, q)                                   \
+    ((uint32_t) _mm256_movemask_epi8(                                         \
+         _mm256_and_si256(_mm256_cmpeq_epi8(first, nxt_vector_load(p)),       \
+                          _mm256_cmpeq_epi8(last, nxt_vector_load(q)))))
+
+#elif (NXT_HAVE_SSE2)
+
+#include <emmintrin.h>
+
+#define NXT_SIMD  1
+
+typedef __m128i  nxt_vector_t;
+
+#define NXT_VECTOR_SIZE  16
+
+#define nxt_vector_set(c)                                                     \
+    _mm_set1_epi8((char) (c))
+
+#define nxt_vector_load(p)                                                    \
+    _mm_loadu_si128((const __m128i *) (p))
+
+#define nxt_vector_match(first, p, last, q)                                   \
+    ((uint32_t) _mm_movemask_epi8(                                            \
+         _mm_and_si128(_mm_cmpeq_epi8(first, nxt_vector_load(p)),             \
+                       _mm_cmpeq_epi8(last, nxt_vector_load(q)))))
+
+#endif
+
+#endif
+
+
+u_char *
+nxt_memstrn(const u_char *p, const u_char *end, const u_char *s, size_t len)
+{
+    const u_char  *last;
+#if (NXT_SIMD)
+    uint32_t      mask;
+    nxt_uint_t    n;
+    nxt_vector_t  first_byte, last_byte;
+#endif
+
+    if (len == 0) {
+        return (u_char *) p;
+    }
+
+    if ((size_t) (end - p) < len) {
+        return NULL;
+    }
+
+    if (len == 1) {
+        return memchr(p, *s, end - p);
+    }
+
+    /* The last position where the string may start. */
+    last = end - len;
+
+#if (NXT_SIMD)
+
+    first_byte = nxt_vector_set(s[0]);
+    last_byte = nxt_vector_set(s[len - 1]);
+
+    while (last - p >= NXT_VECTOR_SIZE - 1) {
+        mask = nxt_vector_match(first_byte, p, last_byte, p + len - 1);
+
+        while (mask != 0) {
+            n = __builtin_ctz(mask);
+
+            if (memcmp(p + n + 1, s + 1, len - 2) == 0) {
+                return (u_char *) p + n;
+            }
+
+            mask &= mask - 1;
+        }
+
+        p += NXT_VECTOR_SIZE;
+    }
+
+#endif
+
+    while (p <= last) {
+        p = memchr(p, *s, last - p + 1);
+
+        if (p == NULL) {
+            return NULL;
+        }
+
+        if (memcmp(p + 1, s + 1, len - 1) == 0) {
+            return (u_char *) p;
+        }
+
+        p++;
+    }
+
+    return NULL;
+}
+
+
+u_char *
+nxt_memrstrn(const u_char *p, const u_char *end, const u_char *s, size_t len)
+{
+    size_t        size;
+    const u_char  *start;
+#if (NXT_SIMD)
+    uint32_t      mask;
+    nxt_uint_t    n;
+    nxt_vector_t  first_byte, last_byte;
+#endif
+
+    if ((size_t) (end - p) < len) {
+        return NULL;
+    }
+
+    if (len == 0) {
+        return (u_char *) end;
+    }
+
+    start = p;
+
+    /* The number of positions where the string may start. */
+    size = (end - start) - len + 1;
+
+#if (NXT_SIMD)
+
+    if (len > 1) {
+        first_byte = nxt_vector_set(s[0]);
+        last_byte = nxt_vector_set(s[len - 1]);
+
+        while (size >= NXT_VECTOR_SIZE) {
+            size -= NXT_VECTOR_SIZE;
+            p = start + size;
+
+            mask = nxt_vector_match(first_byte, p, last_byte, p + len - 1);
+
+            while (mask != 0) {
+                n = 31 - __builtin_clz(mask);
+
+                if (memcmp(p + n + 1, s + 1, len - 2) == 0) {
+                    return (u_char *) p + n;
+                }
+
+                mask &= ~((uint32_t) 1 << n);
+            }
+        }
+    }
+
+#endif
+
+    while (size != 0) {
+        size--;
+        p = start + size;
+
+        if (*p == *s && memcmp(p + 1, s + 1, len - 1) == 0) {
+            return (u_char *) p;
+        }
+    }
+
+    return NULL;
+}
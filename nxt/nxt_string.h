@@ -45,4 +45,16 @@ nxt_upper_case(u_char c)
      && (memcmp((s1)->start, (s2)->start, (s1)->length) == 0))
 
 
+/*
+ * nxt_memstrn() and nxt_memrstrn() return the first and the last
+ * positions of the string "s" of length "len" within [p, end),
+ * or NULL if the string is not found.
+ */
+
+NXT_EXPORT u_char *nxt_memstrn(const u_char *p, const u_char *end,
+    const u_char *s, size_t len);
+NXT_EXPORT u_char *nxt_memrstrn(const u_char *p, const u_char *end,
+    const u_char *s, size_t len);
+
+
 #endif /* _NXT_STRING_H_INCLUDED_ */